@@ -0,0 +1,89 @@
+/**
+ * @file analysis.h
+ * @brief Batch analysis mode: searches a stream of positions and writes the results, without UCI.
+ *
+ * Run with "chess_engine analyze [--input file.epd] [--output file] [--depth N] [--threads T] [--hash MB] [--format jsonl|csv]".
+ *
+ * The positions are read one per line as FEN or EPD (the EPD operations are ignored, except "id"), from a file or
+ * from the standard input. Empty lines and lines starting with '#' are skipped. They are searched by T independent
+ * searchers, each with its own single-threaded ThreadPool (and so its own transposition table), and the results
+ * (best move, score, principal variation, nodes) are written as JSON lines or CSV, in the order of the input.
+ */
+#pragma once
+
+#include <cstddef>
+#include <iosfwd>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace chess_engine::analysis
+{
+/**
+ * @brief Format of the results.
+ */
+enum class OutputFormat
+{
+    JSONL, //< One JSON object per line
+    CSV    //< Comma-separated values, with a header line
+};
+
+/**
+ * @brief Options of an analysis run.
+ */
+struct AnalysisOptions
+{
+    std::string inputPath;                           //< File of the positions (the standard input if empty)
+    std::string outputPath;                          //< File of the results (the standard output if empty)
+    int depth                 = 10;                  //< Depth to search each position to
+    int numberOfThreads       = 1;                   //< Number of positions searched in parallel
+    size_t hashSizeMB         = 16;                  //< Size of the transposition table of each searcher, in MB
+    OutputFormat outputFormat = OutputFormat::JSONL; //< Format of the results
+};
+
+/**
+ * @brief A position read from the input.
+ */
+struct AnalysisPosition
+{
+    std::string fen; //< FEN string of the position, with the move counters
+    std::string id;  //< Value of the EPD "id" operation, empty if none
+};
+
+/**
+ * @brief Parse the command line arguments of the analysis mode.
+ *
+ * @param argc The number of arguments.
+ * @param argv The arguments, after "analyze".
+ * @return The options, or std::nullopt if the arguments are not valid.
+ */
+[[nodiscard]] std::optional<AnalysisOptions> parseArguments(int argc, const char* const argv[]);
+
+/**
+ * @brief Parse a line of the input.
+ *
+ * The missing halfmove clock and fullmove number of an EPD line are set to "0 1".
+ *
+ * @param line A FEN or EPD line.
+ * @return The position, or std::nullopt if the line is empty, a comment or an invalid position (reported on stderr).
+ */
+[[nodiscard]] std::optional<AnalysisPosition> parseLine(std::string_view line);
+
+/**
+ * @brief Search all the positions of a stream and write the results in the order of the input.
+ *
+ * @param input The stream of the positions.
+ * @param output The stream of the results.
+ * @param options The options of the analysis (the paths are ignored).
+ * @return The number of positions analyzed.
+ */
+size_t analyze(std::istream& input, std::ostream& output, const AnalysisOptions& options);
+
+/**
+ * @brief Run the analysis mode, reading and writing the files (or standard streams) of the options.
+ *
+ * @param options The options of the analysis.
+ * @return The exit code of the process.
+ */
+int run(const AnalysisOptions& options);
+} // namespace chess_engine::analysis
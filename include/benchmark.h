@@ -0,0 +1,60 @@
+/**
+ * @file benchmark.h
+ * @brief Fixed search benchmark ("bench" command).
+ *
+ * Searches a built-in set of positions to a fixed depth and reports the total number of nodes, the time
+ * and the nodes per second. The transposition table is cleared before each position, so with a single
+ * thread the number of nodes only depends on the code of the engine: it is a signature of the search,
+ * which changes with any functional change (and only with them).
+ *
+ * It can be run with the "bench" UCI command, or from the command line with "chess_engine bench".
+ */
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace chess_engine::benchmark
+{
+constexpr int DEFAULT_DEPTH        = 8;  //< Default depth of the searches
+constexpr int DEFAULT_THREADS      = 1;  //< Default number of threads (the node count is only deterministic with 1)
+constexpr size_t DEFAULT_HASH_SIZE = 16; //< Default size of the transposition table, in MB
+
+/**
+ * @brief Positions searched by the benchmark: openings, middle games and end games (including a stalemate and mates).
+ */
+extern const std::array<std::string_view, 50> POSITIONS;
+
+/**
+ * @brief Result of a benchmark run.
+ */
+struct BenchmarkResult
+{
+    uint64_t nodes = 0; //< Nodes searched in all the positions
+    int64_t timeMs = 0; //< Time spent searching, in milliseconds
+};
+
+/**
+ * @brief Run the benchmark and print its result.
+ *
+ * Uses its own threads and transposition table, so the settings of the UCI session are not affected.
+ *
+ * @param depth The depth to search each position to.
+ * @param numberOfThreads The number of search threads.
+ * @param hashSizeMB The size of the transposition table, in MB.
+ * @return The total number of nodes and the time spent.
+ */
+BenchmarkResult run(int depth, int numberOfThreads, size_t hashSizeMB);
+
+/**
+ * @brief Run the benchmark with the parameters of a "bench [depth] [threads] [hash]" command.
+ *
+ * The missing parameters take their default value.
+ *
+ * @param command The full "bench" command string.
+ * @return The total number of nodes and the time spent.
+ */
+BenchmarkResult run(std::string_view command);
+} // namespace chess_engine::benchmark
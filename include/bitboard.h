@@ -7,6 +7,7 @@
  */
 #pragma once
 
+#include <bit>
 #include <cstdint>
 #include <utility>
 
@@ -271,25 +272,21 @@ public:
     /**
      * @brief Counts the number of bits set to 1 in the bitboard.
      *
+     * Compiles to a single POPCNT instruction when the target CPU supports it (see the NATIVE CMake option),
+     * and is still usable in constant expressions.
+     *
      * @return The number of bits set to 1 in the bitboard.
      */
     [[nodiscard]] constexpr int getNumberOfBitsSet() const
     {
-        int count     = 0;
-        uint64_t temp = m_bitboard;
-
-        while (temp > 0)
-        {
-            count += temp & 1; // Increment count if the least significant bit is set
-            temp >>= 1;        // Shift right to check the next bit
-        }
-
-        return count;
+        return std::popcount(m_bitboard);
     }
 
     /**
      * @brief Gets the square index of the least significant bit that is set.
      *
+     * Compiles to a single TZCNT (or BSF) instruction, and is still usable in constant expressions.
+     *
      * @return The square index of the least significant bit that is set, or Square::INVALID if no bits are set.
      */
     [[nodiscard]] constexpr Square getSquareOfLeastSignificantBitIndex() const
@@ -297,16 +294,21 @@ public:
         if (m_bitboard == 0)
             return Square::INVALID; // No bits are set
 
-        // Find the index of the least significant bit that is set
-        Square square = Square::a8;
-        uint64_t temp = m_bitboard;
-
-        while ((temp & 1) == 0)
-        {
-            temp >>= 1;
-            square++;
-        }
+        return static_cast<Square>(std::countr_zero(m_bitboard));
+    }
 
+    /**
+     * @brief Gets the square of the least significant bit that is set, and clears it.
+     *
+     * Used to iterate over the set bits of a bitboard.
+     *
+     * @pre The bitboard is not empty.
+     * @return The square index of the least significant bit that was set.
+     */
+    constexpr Square popLsb()
+    {
+        const auto square = static_cast<Square>(std::countr_zero(m_bitboard));
+        m_bitboard &= m_bitboard - 1; // Clear the least significant bit
         return square;
     }
 
@@ -314,7 +316,10 @@ public:
      * @brief Gets the entire bitboard as a 64-bit integer.
      * @return The current state of the bitboard.
      */
-    [[nodiscard]] uint64_t getBitboard() const;
+    [[nodiscard]] constexpr uint64_t getBitboard() const
+    {
+        return m_bitboard;
+    }
 
     /**
      * @brief Left shift operator.
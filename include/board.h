@@ -7,10 +7,12 @@
 #include <array>
 #include <string>
 #include <utility>
-#include <vector>
 
 #include "bitboard.h"
 #include "move.h"
+#include "move_list.h"
+#include "nnue.h"
+#include "score.h"
 #include "zobrist.h"
 
 namespace chess_engine
@@ -76,6 +78,35 @@ inline CastlingRights operator~(const CastlingRights castling_rights)
     return static_cast<CastlingRights>(~std::to_underlying(castling_rights));
 }
 
+/**
+ * @brief State of the board that cannot be recomputed when a move is unmade.
+ *
+ * A StateInfo is pushed by every makeMove (and makeNullMove) and popped by the matching unmakeMove.
+ */
+struct StateInfo
+{
+    uint64_t zobristHash;          //< Zobrist hash of the position before the move
+    CastlingRights castlingRights; //< Castling rights before the move
+    Square enPassantSquare;        //< En passant square before the move
+    int halfMoveClock;             //< Half-move clock before the move
+    int pliesFromNull;             //< Plies since the last null move before the move
+    PieceWithColor capturedPiece;  //< Piece captured by the move (InvalidPiece if none)
+};
+
+/**
+ * @brief Kind of legal moves to generate.
+ *
+ * Captures and Quiets split the moves in two disjoint sets, so that the search can generate
+ * the quiet moves only when it reaches them (see MovePicker).
+ */
+enum class MoveGenType : int
+{
+    All,      //< All the moves
+    Captures, //< Captures (including en passant) and promotions
+    Quiets,   //< All the other moves (including castling)
+    Evasions  //< Moves that can get out of check: king moves, captures of the checker and interpositions
+};
+
 /**
  * @brief Class representing a chess board.
  */
@@ -102,30 +133,104 @@ public:
     /**
      * @brief Generate all possible moves for the current board state.
      *
-     * @note Currently using a vector. Maybe a fixed-size array would be better, even if it wastes some space.
+     * @return The list of generated legal moves.
+     */
+    [[nodiscard]] MoveList generateMoves() const;
+
+    /**
+     * @brief Generate the captures (including en passant) and the promotions.
+     *
+     * @return The list of generated legal moves.
+     */
+    [[nodiscard]] MoveList generateCaptures() const;
+
+    /**
+     * @brief Generate the moves that are neither captures nor promotions (including castling).
+     *
+     * @return The list of generated legal moves.
+     */
+    [[nodiscard]] MoveList generateQuiets() const;
+
+    /**
+     * @brief Generate the moves that can get out of check.
+     *
+     * Only the king moves, the captures of the checker and the interpositions between the checker
+     * and the king are generated (only the king moves in double check).
+     * The side to move must be in check. Since only legal moves are generated, these are all the moves of the position.
+     *
+     * @return The list of generated legal moves.
+     */
+    [[nodiscard]] MoveList generateEvasions() const;
+
+    /**
+     * @brief Generate some of the possible moves for the current board state.
+     *
+     * @param moves The list the generated legal moves are appended to.
+     * @param type The kind of moves to generate (the side to move must be in check for MoveGenType::Evasions).
+     */
+    void generateMoves(MoveList& moves, MoveGenType type) const;
+
+    /**
+     * @brief Rebuild a move from its packed form (see TranspositionTable::packMove).
+     *
+     * Used to search the moves of the transposition table and the killer moves without generating all the moves.
+     * Since they come from other positions, the move is checked against the current board.
+     *
+     * @param packedMove The packed move.
+     * @return The move, or a null move if it is not legal in the current position.
+     */
+    [[nodiscard]] Move unpackMove(uint16_t packedMove) const;
+
+    /**
+     * @brief Decode a move in UCI format (e.g. "e2e4", "e1g1", "e7e8q").
+     *
+     * The source, target and promotion are decoded directly and the move checked against the current board,
+     * without generating all the moves.
      *
-     * @return The list of generated moves.
+     * @param moveAsString The move in UCI format.
+     * @return The move, or a null move if the string is not a legal move in the current position.
      */
-    std::vector<Move> generateMoves();
+    [[nodiscard]] Move parseUCIMove(std::string_view moveAsString) const;
 
-    // FIXME: Does makeMove really need to return bool or can it be void and just assume the move is valid?
     /**
      * @brief Make a move.
      *
+     * The move must be legal (see generateMoves and unpackMove). It must be reverted with unmakeMove.
+     *
      * @param move The move to make.
-     * @return True if the move was valid, false otherwise.
      */
-    /*[[nodiscard]]*/ bool makeMove(const Move& move);
+    void makeMove(const Move& move);
+
+    /**
+     * @brief Unmake the last move made with makeMove.
+     *
+     * @param move The move to unmake, the same one that was passed to makeMove.
+     */
+    void unmakeMove(const Move& move);
 
     /**
      * @brief Make a null move (pass the turn to the opponent).
      *
      * This function is used in search algorithms to implement null move pruning.
+     * It must be reverted with unmakeNullMove.
      */
     void makeNullMove();
 
+    /**
+     * @brief Unmake the last null move made with makeNullMove.
+     */
+    void unmakeNullMove();
+
     [[nodiscard]] Bitboard getBitboardForPiece(const PieceWithColor piece) const;
 
+    /**
+     * @brief Get the piece on a square.
+     *
+     * @param square The square.
+     * @return The piece on the square, or InvalidPiece if the square is empty.
+     */
+    [[nodiscard]] PieceWithColor getPieceOnSquare(Square square) const;
+
     /**
      * @brief Check if a square is attacked by a given side.
      *
@@ -135,6 +240,19 @@ public:
      */
     [[nodiscard]] bool isSquareAttacked(Square square, Side side) const;
 
+    /**
+     * @brief Compute the Static Exchange Evaluation (SEE) of a move.
+     *
+     * The material balance of the sequence of captures on the target square of the move, each side recapturing
+     * with its least valuable piece and stopping as soon as continuing would lose material.
+     * The sliding pieces uncovered behind the capturing pieces (x-rays) join the exchange. The pins are ignored.
+     *
+     * @param move The move to evaluate (a capture or a promotion, or a quiet move that is not castling).
+     * @return The material won by the side to move in centipawns, negative if the move loses material.
+     * @see https://www.chessprogramming.org/Static_Exchange_Evaluation
+     */
+    [[nodiscard]] int getStaticExchangeEvaluation(const Move& move) const;
+
     /**
      * @brief Get the side to move.
      *
@@ -142,6 +260,27 @@ public:
      */
     [[nodiscard]] Side getSideToMove() const;
 
+    /**
+     * @brief Get the castling rights of both sides.
+     *
+     * @return The castling rights.
+     */
+    [[nodiscard]] CastlingRights getCastlingRights() const;
+
+    /**
+     * @brief Get the en passant square.
+     *
+     * @return The square a pawn can capture en passant on, or Square::INVALID if none.
+     */
+    [[nodiscard]] Square getEnPassantSquare() const;
+
+    /**
+     * @brief Get the half-move clock of the fifty-move rule.
+     *
+     * @return The number of half-moves since the last capture or pawn move.
+     */
+    [[nodiscard]] int getHalfMoveClock() const;
+
     /**
      * @brief Check if the current player's king is in check.
      *
@@ -149,6 +288,13 @@ public:
      */
     [[nodiscard]] bool isCheck() const;
 
+    /**
+     * @brief Get the pieces giving check to the side to move.
+     *
+     * @return The bitboard of the opponent pieces attacking the king of the side to move.
+     */
+    [[nodiscard]] Bitboard getCheckers() const;
+
     /**
      * @brief Get the occupancy bitboard for a given side.
      *
@@ -165,6 +311,45 @@ public:
      */
     [[nodiscard]] int getTotalMaterial(Side side) const;
 
+    /**
+     * @brief Get the material and piece-square tables score of the pieces on the board.
+     *
+     * Updated incrementally when the pieces are moved (see Evaluate::s_pieceSquareScores).
+     *
+     * @return The score of White minus the score of Black.
+     */
+    [[nodiscard]] TaperedScore getPieceSquareScore() const;
+
+    /**
+     * @brief Get the game phase, from the pieces left on the board (see Evaluate::s_gamePhaseWeights).
+     *
+     * @return The game phase, from 0 (only kings and pawns) to Evaluate::s_middleGamePhase for the starting material.
+     */
+    [[nodiscard]] int getGamePhase() const;
+
+    /**
+     * @brief Get the accumulators of the NNUE network (see nnue::evaluate).
+     *
+     * Only kept up to date while a network is loaded.
+     *
+     * @return The accumulators of the current position.
+     */
+    [[nodiscard]] const nnue::Accumulator& getAccumulator() const;
+
+    /**
+     * @brief Recompute the accumulators of the NNUE network from scratch.
+     *
+     * Needed when a network is loaded after the position was set up. Does nothing if no network is loaded.
+     */
+    void refreshAccumulators();
+
+    /**
+     * @brief Get the Zobrist hash of the pawns only, used to index the pawn hash table (see PawnHashTable).
+     *
+     * @return The Zobrist hash of the pawns of both sides (0 if there are no pawns).
+     */
+    [[nodiscard]] uint64_t getPawnKey() const;
+
     /**
      * @brief Get the Zobrist hash of the current board position.
      *
@@ -172,6 +357,26 @@ public:
      */
     [[nodiscard]] uint64_t getZobristHash() const;
 
+    /**
+     * @brief Check if the current position already occurred since the position was set up.
+     *
+     * The Zobrist hashes of the previous positions are kept in the state history, shared by the moves of the game
+     * and those of the search. Only the positions since the last irreversible move (bounded by the half-move clock)
+     * and the last null move, with the same side to move, are compared.
+     *
+     * @return True if the position is a repetition, false otherwise.
+     */
+    [[nodiscard]] bool isRepetition() const;
+
+    /**
+     * @brief Check if the position is a draw by repetition (see isRepetition) or by the fifty-move rule.
+     *
+     * A single repetition is enough: the side that could avoid it would have done so the first time.
+     *
+     * @return True if the position is a draw, false otherwise.
+     */
+    [[nodiscard]] bool isDraw() const;
+
 private:
     /**
      * @brief Convert a PieceWithColor to its corresponding FEN character.
@@ -201,34 +406,105 @@ private:
      * @brief Generate moves for pawns of a given side.
      *
      * @param piece The piece for which to generate pawn moves (i.e., WhitePawn or BlackPawn).
-     * @param moves The vector to store the generated moves.
+     * @param moves The list to store the generated moves.
+     * @param type The kind of moves to generate.
+     * @param checkMask The squares the pawns can move to, or capture on (all the squares, except in check).
+     * @param pinned The pieces of the side to move pinned to their king (see getPinnedPieces).
      */
-    inline void generatePawnMoves(PieceWithColor piece, std::vector<Move>& moves);
+    inline void generatePawnMoves(PieceWithColor piece, MoveList& moves, MoveGenType type, Bitboard checkMask, Bitboard pinned) const;
 
     /**
      * @brief Generate castling moves for the king of a given side.
      *
      * @param piece The piece for which to generate castling moves (i.e., WhiteKing or BlackKing).
-     * @param moves The vector to store the generated moves.
+     * @param moves The list to store the generated moves.
+     */
+    inline void generateKingCastlingMoves(PieceWithColor piece, MoveList& moves) const;
+
+    /**
+     * @brief Generate the king moves to the squares not attacked by the opponent (except castling).
+     *
+     * @param piece The piece for which to generate king moves (i.e., WhiteKing or BlackKing).
+     * @param moves The list to store the generated moves.
+     * @param targets The squares the king can move to (empty or occupied by the opponent).
      */
-    inline void generateKingCastlingMoves(PieceWithColor piece, std::vector<Move>& moves) const;
+    inline void generateKingMoves(PieceWithColor piece, MoveList& moves, Bitboard targets) const;
 
     /**
      * @brief Generate moves for a specific piece with color.
      *
      * This function will generate all possible moves for the given piece,
      * taking into account the current board state, including occupied squares,
-     * attacks, and castling rights.
+     * attacks, and pins.
      *
      * Moves for pawns are handled separately in `generatePawnMoves`.
-     * Castling moves are handled in `generateKingCastlingMoves`.
+     * Moves for kings are handled separately in `generateKingMoves` and `generateKingCastlingMoves`.
      *
-     * @param piece The piece with color for which to generate moves.
-     * @param moves The vector to store the generated moves.
+     * @param piece The piece with color for which to generate moves (knight to queen).
+     * @param moves The list to store the generated moves.
+     * @param targets The squares the piece can move to (empty or occupied by the opponent, and resolving the check if any).
+     * @param pinned The pieces of the side to move pinned to their king (see getPinnedPieces).
      * @see generatePawnMoves
+     * @see generateKingMoves
      * @see generateKingCastlingMoves
      */
-    inline void generatePieceMoves(PieceWithColor piece, std::vector<Move>& moves) const;
+    inline void generatePieceMoves(PieceWithColor piece, MoveList& moves, Bitboard targets, Bitboard pinned) const;
+
+    /**
+     * @brief Get the pieces of the side to move that are pinned to their king.
+     *
+     * A pinned piece can only move along the line between its king and the pinner.
+     *
+     * @return The bitboard of the pinned pieces.
+     */
+    [[nodiscard]] Bitboard getPinnedPieces() const;
+
+    /**
+     * @brief Rebuild a move from its packed form, without checking if it leaves the king in check.
+     *
+     * @param packedMove The packed move.
+     * @return The move, or a null move if it is not pseudo-legal in the current position.
+     * @see unpackMove
+     */
+    [[nodiscard]] Move unpackPseudoLegalMove(uint16_t packedMove) const;
+
+    /**
+     * @brief Check if an en passant capture of the side to move leaves its king safe.
+     *
+     * The captured pawn and the capturing pawn both leave their squares, which can uncover
+     * an attack on the king that the pins do not catch (e.g. two pawns between the king and a rook on the same rank).
+     *
+     * @param source The square of the capturing pawn.
+     * @return True if the capture is legal, false otherwise.
+     */
+    [[nodiscard]] bool isEnPassantLegal(Square source) const;
+
+    /**
+     * @brief Check if a pseudo-legal move leaves the king of the side to move safe.
+     *
+     * @param move The move to check (castling moves must have been checked by generateKingCastlingMoves).
+     * @return True if the move is legal, false otherwise.
+     */
+    [[nodiscard]] bool isLegal(const Move& move) const;
+
+    /**
+     * @brief Check if a square is attacked by a given side, with a given occupancy for the sliders.
+     *
+     * @param square The square to check for attacks.
+     * @param side The side of the attacker.
+     * @param occupancy The occupancy blocking the sliders (e.g. without the king, for the squares it moves to).
+     * @return True if the square is attacked by the given side, false otherwise.
+     */
+    [[nodiscard]] bool isSquareAttacked(Square square, Side side, Bitboard occupancy) const;
+
+    /**
+     * @brief Get the pieces of both sides attacking a square, with a given occupancy for the sliders.
+     *
+     * @param square The square to get the attackers of.
+     * @param occupancy The occupancy blocking the sliders (the pieces not in it are still returned, mask them if needed).
+     * @return The bitboard of the pieces attacking the square.
+     */
+    [[nodiscard]] Bitboard getAttackersTo(Square square, Bitboard occupancy) const;
 
     /**
      * @brief Get the piece that was captured by the opponent on a given square.
@@ -238,19 +514,74 @@ private:
      */
     [[nodiscard]] inline Piece getOpponentCapturedPiece(Square target) const;
 
+    /**
+     * @brief Put a piece on an empty square, updating the occupancies and the evaluation data (piece-square tables score, pawn key, NNUE accumulators).
+     *
+     * @param piece The piece to put.
+     * @param square The square to put the piece on.
+     */
+    inline void putPiece(PieceWithColor piece, Square square);
+
+    /**
+     * @brief Remove a piece from a square, updating the occupancies and the evaluation data (piece-square tables score, pawn key, NNUE accumulators).
+     *
+     * @param piece The piece to remove.
+     * @param square The square to remove the piece from.
+     */
+    inline void removePiece(PieceWithColor piece, Square square);
+
+    /**
+     * @brief Move a piece to an empty square, updating the occupancies.
+     *
+     * @param piece The piece to move.
+     * @param source The square the piece is on.
+     * @param target The square to move the piece to.
+     */
+    inline void movePiece(PieceWithColor piece, Square source, Square target);
+
+    /**
+     * @brief Update the accumulators of the NNUE network for a piece put or removed, if a network is loaded.
+     *
+     * @param piece The piece put or removed (nothing is done for the kings).
+     * @param square The square of the piece.
+     * @param isAdded True if the piece was put, false if it was removed.
+     */
+    inline void updateAccumulators(PieceWithColor piece, Square square, bool isAdded);
+
+    /**
+     * @brief Get the source and target squares of the rook for a castling move.
+     *
+     * @param kingTarget The target square of the king (g1, c1, g8 or c8).
+     * @return The source and target squares of the rook.
+     */
+    [[nodiscard]] static inline std::pair<Square, Square> getCastlingRookSquares(Square kingTarget);
+
 private:
-    static constexpr int N_ALL_PIECES = 12; //< 6 pieces for each side
-    static constexpr int N_SIDES      = 3;  //< White, Black, and both sides combined
+    static constexpr int N_ALL_PIECES          = 12;   //< 6 pieces for each side
+    static constexpr int N_SIDES               = 3;    //< White, Black, and both sides combined
+    static constexpr size_t s_stateHistorySize = 1024; //< Size of the state history (a power of two)
 
-    std::array<Bitboard, N_ALL_PIECES> m_bitboardsPieces; //< Bitboards for each piece type
-    std::array<Bitboard, N_SIDES> m_occupancies;          //< Occupancies for each side
+    // The state read by the move generation and the search comes first, in the first two cache lines:
+    // the bitboards and the hash (128 bytes), then the scalar state (one line), then the mailbox (one line)
+    alignas(64) std::array<Bitboard, N_ALL_PIECES> m_bitboardsPieces; //< Bitboards for each piece type
+    std::array<Bitboard, N_SIDES> m_occupancies;                      //< Occupancies for each side
+    uint64_t m_zobristHash;                                           //< Zobrist hash of the current position
 
     Side m_sideToMove;               //< Side to move
     CastlingRights m_castlingRights; //< Castling rights for both sides
     Square m_enPassantSquare;        //< En passant square, if any
     int m_halfMoveClock;             //< Half-move clock for the fifty-move rule
+    int m_pliesFromNull;             //< Plies since the last null move (or since the position was set up)
+    int m_gamePhase;                 //< Game phase of the pieces on the board
+    TaperedScore m_pieceSquareScore; //< Material and piece-square tables score (White minus Black)
+    uint64_t m_pawnKey;              //< Zobrist hash of the pawns
+    size_t m_stateIndex;             //< Number of states pushed (index of the next one in the ring buffer)
     int m_fullMoveNumber;            //< Full move number
-    uint64_t m_zobristHash;          //< Zobrist hash of the current position
+
+    alignas(64) std::array<PieceWithColor, board_dimensions::N_SQUARES> m_mailbox; //< Piece on each square (InvalidPiece if empty)
+
+    nnue::Accumulator m_accumulator;                          //< Accumulators of the NNUE network (only if a network is loaded)
+    std::array<StateInfo, s_stateHistorySize> m_stateHistory; //< States of the moves made, used as a ring buffer
 
 public:
     /// String representations of squares
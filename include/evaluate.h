@@ -2,7 +2,13 @@
  * @file evaluate.h
  * @brief Provide functions to evaluate a position on the board.
  *
- * @note Currently using the simplified evaluation function. In the future might use the PeSTO's evaluation function.
+ * @note Currently using the simplified evaluation function, tapered between the middle game and the end game
+ *       like PeSTO's evaluation function. In the future might use the PeSTO's tables.
+ *
+ * The material and the piece-square tables are kept up to date incrementally by the Board (see Board::getPieceSquareScore),
+ * only the other terms are computed at each evaluation.
+ *
+ * This hand-crafted evaluation is used when no NNUE network is loaded (see nnue.h).
  *
  * @see https://www.chessprogramming.org/Point_Value
  * @see https://www.chessprogramming.org/Simplified_Evaluation_Function
@@ -13,9 +19,36 @@
 #include <array>
 
 #include "board.h"
+#include "pawn_hash_table.h"
+#include "score.h"
 
 namespace chess_engine
 {
+/**
+ * @brief Squares attacked by each piece type and by each side, computed once per evaluation.
+ *
+ * Shared by the evaluation terms that need the attacks of the pieces (mobility, king safety, threats),
+ * so that each of them does not recompute the slider attacks.
+ */
+struct AttackInfo
+{
+    std::array<Bitboard, 12> pieceAttacks = {}; //< Squares attacked by the pieces of each type
+    std::array<Bitboard, 2> sideAttacks   = {}; //< Squares attacked by each side
+    std::array<int, 2> mobility           = {}; //< Mobility score of each side, counted while computing the attacks
+
+    /**
+     * @brief Check if a square is attacked by a given side (same as Board::isSquareAttacked).
+     *
+     * @param square The square to check for attacks.
+     * @param side The side of the attacker.
+     * @return True if the square is attacked by the given side, false otherwise.
+     */
+    [[nodiscard]] bool isSquareAttacked(const Square square, const Side side) const
+    {
+        return sideAttacks[std::to_underlying(side)].getBit(square) == 1;
+    }
+};
+
 class Evaluate
 {
 public:
@@ -29,30 +62,58 @@ public:
      */
     [[nodiscard]] static int evaluatePosition(const Board& board);
 
+    /**
+     * @brief Evaluate the position on the board, reusing the pawn structure evaluation stored in a pawn hash table.
+     *
+     * @param board The board to evaluate.
+     * @param pawnHashTable The pawn hash table of the calling thread, updated if the pawn structure is not stored yet.
+     * @return The evaluation score in centipawns.
+     */
+    [[nodiscard]] static int evaluatePosition(const Board& board, PawnHashTable& pawnHashTable);
+
+    /** @brief Evaluate the pawn structure of both sides.
+     *
+     * @param board The board to evaluate.
+     * @return The evaluation of the pawn structure, to be stored in the pawn hash table.
+     */
+    [[nodiscard]] static PawnEntry evaluatePawns(const Board& board);
+
+    /** @brief Compute the attacks of all the pieces, and the mobility of both sides.
+     *
+     * The mobility of a piece is the number of squares it attacks that are not occupied by a piece of its side.
+     *
+     * @param board The board to evaluate.
+     * @param pawnEntry The evaluation of the pawn structure of the board, holding the pawn attacks.
+     * @return The attacks of the pieces of the board.
+     */
+    [[nodiscard]] static AttackInfo computeAttackInfo(const Board& board, const PawnEntry& pawnEntry);
+
 private:
-    /** @brief Evaluate the pawn structure for a given side.
+    /** @brief Evaluate the position on the board, given the evaluation of its pawn structure.
      *
      * @param board The board to evaluate.
-     * @param side The side to evaluate.
-     * @return The evaluation score for the pawn structure in centipawns.
+     * @param pawnEntry The evaluation of the pawn structure of the board.
+     * @return The evaluation score in centipawns.
      */
-    [[nodiscard]] static int evaluatePawnStructure(const Board& board, Side side);
+    [[nodiscard]] static int evaluatePosition(const Board& board, const PawnEntry& pawnEntry);
 
-    /** @brief Evaluate the rook placement on open and semi-open files.
+    /** @brief Evaluate the pawn structure for a given side.
      *
      * @param board The board to evaluate.
      * @param side The side to evaluate.
-     * @return The evaluation score for rooks on open and semi-open files in centipawns.
+     * @param passedPawns Set to the passed pawns of the side.
+     * @return The evaluation score for the pawn structure in centipawns.
      */
-    [[nodiscard]] static int evaluateRooksOnOpenFile(const Board& board, Side side);
+    [[nodiscard]] static int evaluatePawnStructure(const Board& board, Side side, Bitboard& passedPawns);
 
-    /** @brief Evaluate the mobility of pieces for a given side.
+    /** @brief Evaluate the rook placement on open and semi-open files.
      *
      * @param board The board to evaluate.
      * @param side The side to evaluate.
-     * @return The evaluation score for piece mobility in centipawns.
+     * @param pawnEntry The evaluation of the pawn structure of the board, holding the semi-open files.
+     * @return The evaluation score for rooks on open and semi-open files in centipawns.
      */
-    [[nodiscard]] static int evaluateMobility(const Board& board, Side side);
+    [[nodiscard]] static int evaluateRooksOnOpenFile(const Board& board, Side side, const PawnEntry& pawnEntry);
 
 public:
     // clang-format off
@@ -152,7 +213,6 @@ private:
          20, 30, 10,  0,  0, 10, 30, 20
     };
 
-    // TODO: Implement a way to differentiate between opening/middle game and endgame
     //< King square table for endgame
     static constexpr std::array<int, 64> s_kingEndGameTable =
     {
@@ -167,17 +227,42 @@ private:
     };
     // clang-format on
 
+public:
+    //< Material and piece-square table score of each piece on each square, from the point of view of White
+    static constexpr std::array<std::array<TaperedScore, 64>, 12> s_pieceSquareScores = []()
+    {
+        // Only the king uses a different table in the end game
+        constexpr std::array<const std::array<int, 64>*, 6> middleGameTables = {&s_pawnTable, &s_knightTable, &s_bishopTable, &s_rookTable, &s_queenTable, &s_kingMiddleGameTable};
+        constexpr std::array<const std::array<int, 64>*, 6> endGameTables    = {&s_pawnTable, &s_knightTable, &s_bishopTable, &s_rookTable, &s_queenTable, &s_kingEndGameTable};
+
+        std::array<std::array<TaperedScore, 64>, 12> scores{};
+        for (int piece = 0; piece < 6; piece++)
+        {
+            for (int square = 0; square < 64; square++)
+            {
+                const int value = s_piecesValues[piece];
+
+                // The tables are from the point of view of White, they are mirrored for Black
+                scores[piece][square]     = {value + (*middleGameTables[piece])[square], value + (*endGameTables[piece])[square]};
+                scores[piece + 6][square] = {-value - (*middleGameTables[piece])[63 - square], -value - (*endGameTables[piece])[63 - square]};
+            }
+        }
+        return scores;
+    }();
+
+    //< Contribution of each piece to the game phase (the starting position is the middle game phase)
+    static constexpr std::array<int, 12> s_gamePhaseWeights = {0, 1, 1, 2, 4, 0, 0, 1, 1, 2, 4, 0};
+    static constexpr int s_middleGamePhase                  = 24; //< Game phase of the starting position
+
+private:
     static constexpr int s_bishopPairBonus         = 10;  //< Bonus for having the bishop pair
     static constexpr int s_isolatedPawnPenalty     = -10; //< Penalty for isolated pawns
     static constexpr int s_doublePawnPenalty       = -10; //< Penalty for doubled pawns
     static constexpr int s_passedPawnBonus         = 20;  //< Bonus for passed pawns
     static constexpr int s_rookOnOpenFileBonus     = 15;  //< Bonus for rooks on open files
     static constexpr int s_rookOnSemiOpenFileBonus = 10;  //< Bonus for rooks on semi-open files
-    static constexpr int s_knightMobilityBonus     = 4;   //< Bonus per square a knight can move to
-    static constexpr int s_bishopMobilityBonus     = 4;   //< Bonus per square a bishop can move to
-    static constexpr int s_rookMobilityBonus       = 2;   //< Bonus per square a rook can move to
-    static constexpr int s_queenMobilityBonus      = 1;   //< Bonus per square a queen can move to
 
-    static constexpr int s_endGameThreshold = 1300; //< Threshold to determine if the game is in the endgame phase
+    //< Bonus per square a piece can move to (see computeAttackInfo), the pawns and the king are not counted
+    static constexpr std::array<int, 6> s_mobilityBonus = {0, 4, 4, 2, 1, 0};
 };
 } // namespace chess_engine
\ No newline at end of file
@@ -0,0 +1,119 @@
+/**
+ * @file large_pages.h
+ * @brief Allocation of large tables on huge pages, to reduce the TLB misses of their random accesses.
+ *
+ * A table spanning gigabytes of 4 kB pages needs a TLB entry every 4 kB, while each 2 MB huge page covers 512 of them.
+ * The allocations of at least one huge page are tried, in order:
+ * - on explicit huge pages (MAP_HUGETLB on Linux, MEM_LARGE_PAGES on Windows), if the system reserved some
+ *   (vm.nr_hugepages on Linux, the "Lock pages in memory" privilege on Windows),
+ * - on transparent huge pages (Linux): aligned to a huge page and advised with madvise(MADV_HUGEPAGE),
+ * - on normal pages, aligned to a cache line.
+ * The smaller allocations always use normal pages.
+ *
+ * The memory is not touched by the allocation: with the first-touch policy of the OS, each page is placed on the NUMA node
+ * of the thread that first writes to it (see TranspositionTable::setNumberOfThreads).
+ *
+ * @see https://www.kernel.org/doc/html/latest/admin-guide/mm/transhuge.html
+ */
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace chess_engine::large_pages
+{
+constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024; //< Size of a huge page (x86-64 and most ARM64 kernels)
+
+/**
+ * @brief Kind of pages an allocation was made on.
+ */
+enum class PageKind : int
+{
+    Normal,      //< Normal pages
+    Transparent, //< Transparent huge pages have been requested (the kernel may still use normal pages)
+    Explicit     //< Reserved huge pages
+};
+
+/**
+ * @brief Allocate memory, on huge pages if possible.
+ *
+ * @param size The size of the allocation in bytes.
+ * @param pageKind Set to the kind of pages the memory was allocated on.
+ * @return The allocated memory, aligned to at least 64 bytes and uninitialized, or nullptr on error.
+ */
+[[nodiscard]] void* allocate(size_t size, PageKind& pageKind);
+
+/**
+ * @brief Free memory allocated with allocate.
+ *
+ * @param pointer The allocated memory (nothing is done for nullptr).
+ * @param size The size passed to allocate.
+ * @param pageKind The kind of pages returned by allocate.
+ */
+void deallocate(void* pointer, size_t size, PageKind pageKind);
+
+/**
+ * @brief Get a description of the pages backing some memory, as reported by the kernel.
+ *
+ * @param address An address of the memory.
+ * @return The resident size, the size on huge pages and the pages of each NUMA node of the mapping the address belongs to
+ *         (e.g. "16384 kB resident, 16384 kB on huge pages, NUMA pages N0=4096"), or an empty string if not available.
+ */
+[[nodiscard]] std::string describePlacement(const void* address);
+
+/**
+ * @brief Get the name of a kind of pages.
+ *
+ * @param pageKind The kind of pages.
+ * @return The name of the kind of pages.
+ */
+[[nodiscard]] std::string_view toString(PageKind pageKind);
+
+/**
+ * @brief Deleter of the arrays allocated with makeUniqueArray.
+ */
+struct Deleter
+{
+    size_t size;       //< Size of the allocation in bytes
+    PageKind pageKind; //< Kind of pages of the allocation
+
+    void operator()(void* pointer) const
+    {
+        deallocate(pointer, size, pageKind);
+    }
+};
+
+template<typename T>
+using UniqueArray = std::unique_ptr<T[], Deleter>; //< Array allocated with makeUniqueArray
+
+/**
+ * @brief Allocate an array of value-initialized elements, on huge pages if possible.
+ *
+ * @tparam T The type of the elements (trivially destructible).
+ * @param count The number of elements.
+ * @return The array.
+ * @throws std::bad_alloc If the memory cannot be allocated.
+ */
+template<typename T>
+[[nodiscard]] UniqueArray<T> makeUniqueArray(const size_t count)
+{
+    static_assert(std::is_trivially_destructible_v<T>, "The elements are not destroyed");
+    static_assert(alignof(T) <= 64, "The allocations are only aligned to 64 bytes");
+
+    PageKind pageKind;
+    const size_t size = count * sizeof(T);
+    void* pointer     = allocate(size, pageKind);
+    if (pointer == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+
+    T* elements = static_cast<T*>(pointer);
+    std::uninitialized_value_construct_n(elements, count);
+    return UniqueArray<T>(elements, Deleter{size, pageKind});
+}
+} // namespace chess_engine::large_pages
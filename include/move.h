@@ -8,7 +8,9 @@
  */
 #pragma once
 
+#include <cstdint>
 #include <string>
+#include <utility>
 
 #include "bitboard.h"
 #include "pieces.h"
@@ -21,14 +23,28 @@ namespace chess_engine
  * This class encapsulates the details of a move, including the source and target squares,
  * the piece being moved, any promotion that occurs, and whether the move is a capture, pawn double push,
  * en passant, or castling.
+ *
+ * The move is packed in a single 32-bit integer:
+ * - bits 0-5: source square
+ * - bits 6-11: target square
+ * - bits 12-15: promoted piece (0 if the move is not a promotion, a pawn can never be promoted to)
+ * - bits 16-19: piece being moved
+ * - bits 20-22: captured piece
+ * - bits 23-26: capture, pawn double push, en passant and castling flags
+ *
+ * The lower 16 bits are enough to identify a move in a given position (see getShortData).
+ * The default (null) move is 0.
  */
 class Move
 {
 public:
     /**
-     * @brief Default constructor initializes an invalid move.
+     * @brief Default constructor initializes a null move.
      */
-    Move();
+    constexpr Move()
+        : m_data(0)
+    {
+    }
 
     /**
      * @brief Constructs a move with the specified parameters.
@@ -43,7 +59,18 @@ public:
      * @param isEnPassant Indicates if the move is an en passant capture (default is false).
      * @param isCastling Indicates if the move is a castling move (default is false).
      */
-    Move(Square source, Square target, PieceWithColor piece, PieceWithColor promotedPiece = InvalidPiece, Piece capturedPiece = Pawn, bool isCapture = false, bool isPawnDoublePush = false, bool isEnPassant = false, bool isCastling = false);
+    constexpr Move(const Square source, const Square target, const PieceWithColor piece, const PieceWithColor promotedPiece = InvalidPiece, const Piece capturedPiece = Pawn, const bool isCapture = false, const bool isPawnDoublePush = false, const bool isEnPassant = false, const bool isCastling = false)
+        : m_data(static_cast<uint32_t>(std::to_underlying(source)) |
+                 static_cast<uint32_t>(std::to_underlying(target)) << s_targetShift |
+                 static_cast<uint32_t>(promotedPiece == InvalidPiece ? 0 : std::to_underlying(promotedPiece)) << s_promotedPieceShift |
+                 static_cast<uint32_t>(std::to_underlying(piece)) << s_pieceShift |
+                 static_cast<uint32_t>(std::to_underlying(capturedPiece)) << s_capturedPieceShift |
+                 (isCapture ? s_captureFlag : 0) |
+                 (isPawnDoublePush ? s_pawnDoublePushFlag : 0) |
+                 (isEnPassant ? s_enPassantFlag : 0) |
+                 (isCastling ? s_castlingFlag : 0))
+    {
+    }
 
     /**
      * @brief Constructs a move with the specified parameters.
@@ -57,93 +84,153 @@ public:
      * @param isEnPassant Indicates if the move is an en passant capture (default is false).
      * @param isCastling Indicates if the move is a castling move (default is false).
      */
-    Move(Square source, Square target, PieceWithColor piece, PieceWithColor promotedPiece = InvalidPiece, bool isCapture = false, bool isPawnDoublePush = false, bool isEnPassant = false, bool isCastling = false);
+    constexpr Move(const Square source, const Square target, const PieceWithColor piece, const PieceWithColor promotedPiece = InvalidPiece, const bool isCapture = false, const bool isPawnDoublePush = false, const bool isEnPassant = false, const bool isCastling = false)
+        : Move(source, target, piece, promotedPiece, Pawn, isCapture, isPawnDoublePush, isEnPassant, isCastling)
+    {
+    }
 
     /**
      * @brief Get the source square of the move.
      *
      * @return The source square.
      */
-    [[nodiscard]] Square getSource() const;
+    [[nodiscard]] constexpr Square getSource() const
+    {
+        return static_cast<Square>(m_data & s_squareMask);
+    }
 
     /**
      * @brief Get the target square of the move.
      *
      * @return The target square.
      */
-    [[nodiscard]] Square getTarget() const;
+    [[nodiscard]] constexpr Square getTarget() const
+    {
+        return static_cast<Square>((m_data >> s_targetShift) & s_squareMask);
+    }
 
     /**
      * @brief Get the piece being moved.
      *
      * @return The piece being moved.
      */
-    [[nodiscard]] PieceWithColor getPiece() const;
+    [[nodiscard]] constexpr PieceWithColor getPiece() const
+    {
+        return static_cast<PieceWithColor>((m_data >> s_pieceShift) & s_pieceMask);
+    }
 
     /**
      * @brief Get the piece promoted to, if applicable.
      *
      * @return The promoted piece, or InvalidPiece if no promotion occurred.
      */
-    [[nodiscard]] PieceWithColor getPromotedPiece() const;
+    [[nodiscard]] constexpr PieceWithColor getPromotedPiece() const
+    {
+        const uint32_t promotedPiece = (m_data >> s_promotedPieceShift) & s_pieceMask;
+        return promotedPiece == 0 ? InvalidPiece : static_cast<PieceWithColor>(promotedPiece);
+    }
 
     /**
      * @brief Get the piece that was captured.
      *
      * @return The captured piece, or Pawn if no capture occurred.
      */
-    [[nodiscard]] Piece getCapturedPiece() const;
+    [[nodiscard]] constexpr Piece getCapturedPiece() const
+    {
+        return static_cast<Piece>((m_data >> s_capturedPieceShift) & s_capturedPieceMask);
+    }
 
     /**
      * @brief Check if the move is a capture.
      *
      * @return True if the move is a capture, false otherwise.
      */
-    [[nodiscard]] bool isCapture() const;
+    [[nodiscard]] constexpr bool isCapture() const
+    {
+        return (m_data & s_captureFlag) != 0;
+    }
 
     /**
      * @brief Check if the move is a pawn double push.
      *
      * @return True if the move is a pawn double push, false otherwise.
      */
-    [[nodiscard]] bool isPawnDoublePush() const;
+    [[nodiscard]] constexpr bool isPawnDoublePush() const
+    {
+        return (m_data & s_pawnDoublePushFlag) != 0;
+    }
 
     /**
      * @brief Check if the move is an en passant capture.
      *
      * @return True if the move is an en passant capture, false otherwise.
      */
-    [[nodiscard]] bool isEnPassant() const;
+    [[nodiscard]] constexpr bool isEnPassant() const
+    {
+        return (m_data & s_enPassantFlag) != 0;
+    }
 
     /**
      * @brief Check if the move is a castling move.
      *
      * @return True if the move is a castling move, false otherwise.
      */
-    [[nodiscard]] bool isCastling() const;
+    [[nodiscard]] constexpr bool isCastling() const
+    {
+        return (m_data & s_castlingFlag) != 0;
+    }
 
     /**
      * @brief Check if the move is a promotion.
      *
      * @return True if the move is a promotion, false otherwise.
      */
-    [[nodiscard]] bool isPromotion() const;
+    [[nodiscard]] constexpr bool isPromotion() const
+    {
+        return (m_data & (s_pieceMask << s_promotedPieceShift)) != 0;
+    }
 
     /**
-     * @brief Convert the move to a string in UCI format.
+     * @brief Check if the move is the null (default constructed) move.
      *
-     * @return The move as a string in UCI format.
+     * @return True if the move is the null move, false otherwise.
      */
-    [[nodiscard]] std::string toString() const;
+    [[nodiscard]] constexpr bool isNull() const
+    {
+        return m_data == 0;
+    }
 
     /**
-     * @brief Calculate a score for the move based on its characteristics.
+     * @brief Get the source and target squares and the promoted piece of the move, packed in 16 bits.
+     *
+     * @return The lower 16 bits of the move (0 for the null move).
+     */
+    [[nodiscard]] constexpr uint16_t getShortData() const
+    {
+        return static_cast<uint16_t>(m_data);
+    }
+
+    /**
+     * @brief Construct a partial move from its lower 16 bits (see getShortData).
+     *
+     * Only the source and target squares and the promoted piece are set, see Board::unpackMove to rebuild the full move.
      *
-     * @param ply The current ply in the search tree.
-     * @param isPV Indicates if the move is part of the principal variation.
-     * @return The calculated score for the move.
+     * @param data The lower 16 bits of a move.
+     * @return The partial move.
      */
-    [[nodiscard]] int calculateScore(int ply, bool isPV) const;
+    [[nodiscard]] static constexpr Move fromShortData(const uint16_t data)
+    {
+        Move move;
+        move.m_data = data;
+        return move;
+    }
+
+    /**
+     * @brief Convert the move to a string in UCI format.
+     *
+     * @return The move as a string in UCI format.
+     */
+    [[nodiscard]] std::string toString() const;
 
     /**
      * @brief Equality operator for Move.
@@ -151,17 +238,23 @@ public:
      * @param other The other Move object to compare with.
      * @return True if the moves are equal, false otherwise.
      */
-    bool operator==(const Move& other) const = default;
+    constexpr bool operator==(const Move& other) const = default;
 
 private:
-    Square m_source;                //< Source square of the move
-    Square m_target;                //< Target square of the move
-    PieceWithColor m_piece;         //< Piece being moved
-    PieceWithColor m_promotedPiece; //< Piece promoted to, if applicable
-    Piece m_capturedPiece;          //< Piece that was captured
-    bool m_isCapture;               //< Indicates if the move is a capture
-    bool m_isPawnDoublePush;        //< Indicates if the move is a pawn double push
-    bool m_isEnPassant;             //< Indicates if the move is an en passant capture
-    bool m_isCastling;              //< Indicates if the move is a castling move
+    static constexpr int s_targetShift             = 6;
+    static constexpr int s_promotedPieceShift      = 12;
+    static constexpr int s_pieceShift              = 16;
+    static constexpr int s_capturedPieceShift      = 20;
+    static constexpr uint32_t s_squareMask         = 0x3F;
+    static constexpr uint32_t s_pieceMask          = 0xF;
+    static constexpr uint32_t s_capturedPieceMask  = 0x7;
+    static constexpr uint32_t s_captureFlag        = 1U << 23;
+    static constexpr uint32_t s_pawnDoublePushFlag = 1U << 24;
+    static constexpr uint32_t s_enPassantFlag      = 1U << 25;
+    static constexpr uint32_t s_castlingFlag       = 1U << 26;
+
+    uint32_t m_data; //< The packed move
 };
+
+static_assert(sizeof(Move) == 4, "Move must be packed in 32 bits");
 } // namespace chess_engine
\ No newline at end of file
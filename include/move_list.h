@@ -0,0 +1,130 @@
+/**
+ * @file move_list.h
+ * @brief Declaration of the MoveList class, a fixed-capacity list of moves.
+ *
+ * The list lives on the stack, so generating the moves of a position does not allocate any memory.
+ * Each move comes with a score slot, used by the search to order the moves.
+ */
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+#include "move.h"
+
+namespace chess_engine
+{
+/**
+ * @brief A move with its ordering score.
+ *
+ * Derives from Move, so that a ScoredMove can be used wherever a Move is expected.
+ */
+struct ScoredMove : public Move
+{
+    /**
+     * @brief Constructs a scored move.
+     *
+     * @param move The move.
+     * @param score The ordering score of the move (default is 0).
+     */
+    explicit ScoredMove(const Move& move, const int score = 0)
+        : Move(move),
+          score(score)
+    {
+    }
+
+    int score; //< Ordering score of the move
+};
+
+/**
+ * @brief Fixed-capacity list of moves.
+ */
+class MoveList
+{
+public:
+    static constexpr size_t s_capacity = 256; //< Maximum number of moves (218 is the most legal moves in a position)
+
+    /**
+     * @brief Construct an empty list.
+     *
+     * The storage is left uninitialized, only the added moves are constructed.
+     */
+    MoveList()
+        : m_size(0)
+    {
+    }
+
+    /**
+     * @brief Construct a move at the end of the list.
+     *
+     * @param args The arguments forwarded to the Move constructor.
+     */
+    template<typename... Args>
+    void add(Args&&... args)
+    {
+        assert(m_size < s_capacity);
+        std::construct_at(&m_moves[m_size++], Move(std::forward<Args>(args)...));
+    }
+
+    /**
+     * @brief Get the number of moves in the list.
+     *
+     * @return The number of moves.
+     */
+    [[nodiscard]] size_t size() const
+    {
+        return m_size;
+    }
+
+    /**
+     * @brief Check if the list is empty.
+     *
+     * @return True if the list contains no moves, false otherwise.
+     */
+    [[nodiscard]] bool empty() const
+    {
+        return m_size == 0;
+    }
+
+    ScoredMove& operator[](const size_t index)
+    {
+        return m_moves[index];
+    }
+
+    const ScoredMove& operator[](const size_t index) const
+    {
+        return m_moves[index];
+    }
+
+    ScoredMove* begin()
+    {
+        return m_moves;
+    }
+
+    ScoredMove* end()
+    {
+        return m_moves + m_size;
+    }
+
+    [[nodiscard]] const ScoredMove* begin() const
+    {
+        return m_moves;
+    }
+
+    [[nodiscard]] const ScoredMove* end() const
+    {
+        return m_moves + m_size;
+    }
+
+private:
+    size_t m_size; //< Number of moves in the list
+
+    // Anonymous union, so that the moves are not default-constructed (that would cost more than generating them)
+    union
+    {
+        ScoredMove m_moves[s_capacity]; //< The moves, only the first m_size are constructed
+    };
+};
+} // namespace chess_engine
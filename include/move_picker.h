@@ -0,0 +1,145 @@
+/**
+ * @file move_picker.h
+ * @brief Declaration of the MovePicker class, returning the moves of a position in search order.
+ *
+ * The moves are generated and ordered in stages, so that a node that cuts off early does not pay
+ * for generating and sorting all of its moves:
+ * 1. the transposition table move,
+ * 2. the captures and promotions that do not lose material (see Board::getStaticExchangeEvaluation),
+ *    by MVV-LVA (Most Valuable Victim - Least Valuable Attacker),
+ * 3. the killer moves,
+ * 4. the quiet moves, by history heuristic,
+ * 5. the losing captures and promotions, by SEE value (not returned in the quiescence search).
+ *
+ * When the side to move is in check, the last three stages are replaced by the evasions (see Board::generateEvasions),
+ * captures first.
+ *
+ * Within a stage, the moves are scored once and the best remaining one is picked at each call (selection sort).
+ *
+ * @see https://www.chessprogramming.org/Move_Ordering
+ */
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "board.h"
+#include "move_list.h"
+
+namespace chess_engine
+{
+using KillerMoves  = std::array<Move, 2>;                                          //< Killer moves of a ply
+using HistoryTable = std::array<std::array<int, board_dimensions::N_SQUARES>, 12>; //< History heuristic score of each piece and target square
+
+/**
+ * @brief Return the legal moves of a position one at a time, best first.
+ */
+class MovePicker
+{
+public:
+    /**
+     * @brief Construct a move picker for the main search, returning all the moves.
+     *
+     * @param board The position to pick the moves of.
+     * @param ttMove The packed best move stored in the transposition table (0 if none).
+     * @param killerMoves The killer moves of the current ply.
+     * @param history The history heuristic table.
+     */
+    MovePicker(const Board& board, uint16_t ttMove, const KillerMoves& killerMoves, const HistoryTable& history);
+
+    /**
+     * @brief Construct a move picker for the quiescence search, returning only the captures and promotions.
+     *
+     * @param board The position to pick the moves of.
+     */
+    explicit MovePicker(const Board& board);
+
+    /**
+     * @brief Get the next move to search.
+     *
+     * @return The next move, or a null move once all the moves have been returned.
+     */
+    [[nodiscard]] Move next();
+
+private:
+    /**
+     * @brief Stages of the move picker, in order.
+     */
+    enum class Stage : int
+    {
+        TTMove,
+        GenerateCaptures,
+        GoodCaptures,
+        Killers,
+        GenerateQuiets,
+        Quiets,
+        BadCaptures,
+        GenerateEvasions,
+        Evasions,
+        Done
+    };
+
+    /**
+     * @brief Score the captures and promotions, from m_current to the end of the list.
+     *
+     * The captures losing material get their (negative) SEE value, the others their MVV-LVA score (see getCaptureScore).
+     */
+    void scoreCaptures();
+
+    /**
+     * @brief Score the quiet moves, from m_current to the end of the list.
+     */
+    void scoreQuiets();
+
+    /**
+     * @brief Score the evasions, from m_current to the end of the list: captures first, then the quiet moves.
+     */
+    void scoreEvasions();
+
+    /**
+     * @brief Score a capture or a promotion.
+     *
+     * @param move The move to score.
+     * @return The MVV-LVA score of the capture, plus a bonus for the promotions.
+     */
+    [[nodiscard]] static int getCaptureScore(const Move& move);
+
+    /**
+     * @brief Score a quiet move.
+     *
+     * @param move The move to score.
+     * @return The history heuristic score of the move.
+     */
+    [[nodiscard]] int getQuietScore(const Move& move) const;
+
+    /**
+     * @brief Move the best move between m_current and end to m_current, and return it.
+     *
+     * @param end The index after the last move to pick from.
+     * @return The best remaining move.
+     */
+    [[nodiscard]] Move pickBest(size_t end);
+
+    /**
+     * @brief Check if a killer move can be searched in the killer stage.
+     *
+     * @param index The index of the killer move.
+     * @return True if the killer move is legal and has not already been returned, false otherwise.
+     */
+    [[nodiscard]] bool isValidKiller(size_t index) const;
+
+    static constexpr int s_evasionCaptureBonus = 1 << 24; //< Puts the capturing evasions before the quiet ones (above any history score)
+
+    const Board& m_board;          //< The position to pick the moves of
+    const HistoryTable* m_history; //< History heuristic table (nullptr in the quiescence search)
+    Stage m_stage;                 //< Current stage
+    bool m_isQuiescence;           //< Only return the captures and promotions
+    Move m_ttMove;                 //< Transposition table move (null if none or not legal)
+    KillerMoves m_killerMoves;     //< Killer moves of the current ply
+    size_t m_killerIndex      = 0; //< Index of the next killer move to try
+    size_t m_current          = 0; //< Index of the next move to pick in the list
+    size_t m_badCapturesBegin = 0; //< Index of the first losing capture in the list
+    size_t m_badCapturesEnd   = 0; //< Index after the last losing capture in the list
+    MoveList m_moves;              //< The generated moves: captures first (the losing ones last), then quiet moves
+};
+} // namespace chess_engine
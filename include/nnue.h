@@ -0,0 +1,121 @@
+/**
+ * @file nnue.h
+ * @brief NNUE (Efficiently Updatable Neural Network) evaluation, used instead of Evaluate when a network is loaded.
+ *
+ * The network has a HalfKP first layer: for each perspective, the inputs are the (king square, piece, square)
+ * triples of the non-king pieces, with the king of the perspective (64 x 10 x 64 = 40960 inputs, mirrored for Black).
+ * The two first layer outputs (accumulators) are concatenated, the side to move first, clipped to [0, QA] (clipped ReLU),
+ * and combined into the output.
+ *
+ * The accumulators are kept by the Board and updated incrementally when a piece is put or removed.
+ * A king move changes all the inputs of its perspective, so that accumulator is recomputed from scratch (refreshed).
+ *
+ * File format (little endian, each section is a multiple of 64 bytes so that the weights can be used in place with aligned loads):
+ * - header (64 bytes): "CENNUE01", the number of inputs (uint32), the number of neurons of the first layer (uint32), then zeros,
+ * - first layer biases: int16[N_HIDDEN],
+ * - first layer weights: int16[N_INPUTS][N_HIDDEN],
+ * - output weights: int16[2 * N_HIDDEN], the side to move first,
+ * - output bias: int32, then zeros up to 64 bytes.
+ *
+ * The file is memory mapped read-only, so that all the engine processes using the same network share its pages.
+ *
+ * The add and remove kernels and the output layer are vectorized with AVX-512, AVX2 or NEON, when compiled for a CPU
+ * supporting them (see the NATIVE option of CMakeLists.txt), with a scalar fallback.
+ *
+ * @see https://www.chessprogramming.org/NNUE
+ */
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+#include "bitboard.h"
+#include "pieces.h"
+
+namespace chess_engine::nnue
+{
+constexpr int N_FEATURE_PIECES = 10;                                                                         //< Pieces of both sides, without the kings
+constexpr int N_INPUTS         = board_dimensions::N_SQUARES * N_FEATURE_PIECES * board_dimensions::N_SQUARES; //< Inputs of a perspective
+constexpr int N_HIDDEN         = 256;                                                                        //< Neurons of the first layer of a perspective
+constexpr int QA               = 255;                                                                        //< Quantization of the first layer (clipping value)
+constexpr int QB               = 64;                                                                         //< Quantization of the output weights
+constexpr int SCALE            = 400;                                                                        //< Scale from the network output to centipawns
+
+/**
+ * @brief First layer outputs of both perspectives.
+ */
+struct alignas(64) Accumulator
+{
+    std::array<std::array<int16_t, N_HIDDEN>, 2> values; //< Accumulator of each perspective (indexed by Side)
+};
+
+/**
+ * @brief Load a network, replacing the current one.
+ *
+ * @param path The path of the network file.
+ * @return True if the network was loaded, false otherwise (the current network is then unloaded).
+ */
+[[nodiscard]] bool load(const std::string& path);
+
+/**
+ * @brief Unload the current network, if any, going back to the hand-crafted evaluation.
+ *
+ * @note Must not be called while a search is running.
+ */
+void unload();
+
+/**
+ * @brief Check if a network is loaded.
+ *
+ * @return True if a network is loaded, false otherwise.
+ */
+[[nodiscard]] bool isLoaded();
+
+/**
+ * @brief Get the input of a piece on a square, seen from a perspective.
+ *
+ * @param perspective The side the input is seen from.
+ * @param kingSquare The square of the king of the perspective.
+ * @param piece The piece (not a king).
+ * @param square The square of the piece.
+ * @return The index of the input.
+ */
+[[nodiscard]] int getFeatureIndex(Side perspective, Square kingSquare, PieceWithColor piece, Square square);
+
+/**
+ * @brief Add an input to the accumulator of a perspective.
+ *
+ * @param accumulator The accumulator to update.
+ * @param perspective The perspective to update.
+ * @param featureIndex The input to add (see getFeatureIndex).
+ */
+void addFeature(Accumulator& accumulator, Side perspective, int featureIndex);
+
+/**
+ * @brief Remove an input from the accumulator of a perspective.
+ *
+ * @param accumulator The accumulator to update.
+ * @param perspective The perspective to update.
+ * @param featureIndex The input to remove (see getFeatureIndex).
+ */
+void removeFeature(Accumulator& accumulator, Side perspective, int featureIndex);
+
+/**
+ * @brief Recompute the accumulator of a perspective from scratch.
+ *
+ * @param accumulator The accumulator to update.
+ * @param perspective The perspective to update.
+ * @param pieces The bitboards of the pieces on the board.
+ */
+void refresh(Accumulator& accumulator, Side perspective, const std::array<Bitboard, 12>& pieces);
+
+/**
+ * @brief Evaluate a position from its accumulators.
+ *
+ * @param accumulator The accumulators of the position.
+ * @param sideToMove The side to move.
+ * @return The evaluation score in centipawns, from the point of view of the side to move.
+ */
+[[nodiscard]] int evaluate(const Accumulator& accumulator, Side sideToMove);
+} // namespace chess_engine::nnue
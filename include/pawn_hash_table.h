@@ -0,0 +1,64 @@
+/**
+ * @file pawn_hash_table.h
+ * @brief Declaration of the PawnHashTable class used to cache the evaluation of the pawn structures.
+ *
+ * The pawn structure only changes when a pawn moves or is captured, so most of the evaluated positions
+ * share their pawn structure with many others. The table is indexed by the Zobrist hash of the pawns only
+ * (see Board::getPawnKey), and stores the pawn structure score along with the bitboards the other terms of
+ * the evaluation need.
+ *
+ * Each search thread owns its own table, so no synchronization is needed.
+ *
+ * @see https://www.chessprogramming.org/Pawn_Hash_Table
+ */
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include "bitboard.h"
+#include "large_pages.h"
+
+namespace chess_engine
+{
+/**
+ * @brief The evaluation of a pawn structure.
+ *
+ * The default entry is the one of a position without pawns (the pawn key of such a position is 0).
+ */
+struct PawnEntry
+{
+    uint64_t key                         = 0;            //< Zobrist hash of the pawns
+    int score                            = 0;            //< Pawn structure score, White minus Black
+    std::array<Bitboard, 2> pawnAttacks  = {};           //< Squares attacked by the pawns of each side
+    std::array<Bitboard, 2> passedPawns  = {};           //< Passed pawns of each side
+    std::array<uint8_t, 2> semiOpenFiles = {0xFF, 0xFF}; //< Files without pawns of each side (bit i for the file i)
+};
+
+/**
+ * @brief Fixed size hash table storing the evaluation of the pawn structures.
+ */
+class PawnHashTable
+{
+public:
+    static constexpr size_t s_numberOfEntries = 1 << 13; //< Number of entries of the table (a power of two)
+
+    /**
+     * @brief Construct an empty pawn hash table.
+     */
+    PawnHashTable();
+
+    /**
+     * @brief Get the entry a pawn structure is stored in.
+     *
+     * The entry can hold another pawn structure: its key must be checked, and the entry overwritten if it does not match.
+     *
+     * @param key The Zobrist hash of the pawns.
+     * @return The entry of the table for the key.
+     */
+    [[nodiscard]] PawnEntry& getEntry(uint64_t key);
+
+private:
+    large_pages::UniqueArray<PawnEntry> m_entries; //< The entries of the table
+};
+} // namespace chess_engine
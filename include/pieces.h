@@ -7,6 +7,7 @@
  */
 #pragma once
 
+#include <cstdint>
 #include <utility>
 
 namespace chess_engine
@@ -36,8 +37,10 @@ enum class Piece : int
 
 /**
  * @brief Pieces with color definitions.
+ *
+ * Stored on one byte, so that the board mailbox (see Board::getPieceOnSquare) fits in a cache line.
  */
-enum class PieceWithColor : int
+enum class PieceWithColor : uint8_t
 {
     WhitePawn,
     WhiteKnight,
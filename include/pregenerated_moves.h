@@ -1,10 +1,23 @@
 /**
  * @file pregenerated_moves.h
  * @brief Contains precomputed moves for pieces to optimize move generation.
+ *
+ * The slider (bishop and rook) attacks are stored in one shared table per piece, where each square
+ * only takes as many entries as its number of relevant occupancies ("fancy" magic bitboards).
+ * The index inside the square's slice is computed either with a magic multiplication, or with the BMI2
+ * PEXT instruction when USE_PEXT is defined (see the PEXT CMake option).
+ *
+ * @see https://www.chessprogramming.org/Magic_Bitboards
+ * @see https://www.chessprogramming.org/BMI2#PEXTBitboards
  */
 #pragma once
 
 #include <array>
+#include <cstdint>
+
+#ifdef USE_PEXT
+#include <immintrin.h>
+#endif
 
 #include "bitboard.h"
 #include "board.h"
@@ -12,18 +25,52 @@
 #include "slider_utils.h"
 
 // Note: Not sure if a static class is preferred here, instead of a namespace
-// Note: Can be computed at compile time?
 namespace chess_engine::pregenerated_moves
 {
-inline std::array<Bitboard, 64> whitePawnsAttacks;              //< Precomputed pawn attacks for white pawns
-inline std::array<Bitboard, 64> blackPawnsAttacks;              //< Precomputed pawn attacks for black pawns
-inline std::array<Bitboard, 64> knightAttacks;                  //< Precomputed knight attacks
-inline std::array<Bitboard, 64> kingAttacks;                    //< Precomputed king attacks
-inline std::array<std::array<Bitboard, 512>, 64> bishopAttacks; //< Precomputed bishop attacks ([square][occupancy])
-inline std::array<std::array<Bitboard, 4096>, 64> rookAttacks;  //< Precomputed rook attacks ([square][occupancy])
+/**
+ * @brief Data needed to look up the attacks of a slider piece on a given square.
+ */
+struct MagicEntry
+{
+    Bitboard mask;   //< Relevant occupancy mask (attacks on an empty board, without the edges)
+    Bitboard magic;  //< Magic number (unused with PEXT)
+    int shift;       //< 64 minus the number of relevant occupancy bits
+    uint32_t offset; //< Offset of the attacks of the square in the shared attack table
+
+    /**
+     * @brief Get the index of the attacks for a given occupancy, relative to the offset of the square.
+     *
+     * @param occupancy The occupancy bitboard.
+     * @return The index of the attacks in the slice of the square.
+     */
+    [[nodiscard]] uint64_t getIndex(const Bitboard occupancy) const
+    {
+#ifdef USE_PEXT
+        return _pext_u64(occupancy.getBitboard(), mask.getBitboard());
+#else
+        return (occupancy & mask).getBitboard() * magic.getBitboard() >> shift;
+#endif
+    }
+};
+
+/**
+ * @brief Compute the size of a shared slider attack table.
+ *
+ * @param relevantBits The number of relevant occupancy bits for each square.
+ * @return The total number of occupancies of all the squares.
+ */
+[[nodiscard]] constexpr size_t getAttackTableSize(const std::array<int, 64>& relevantBits)
+{
+    size_t size = 0;
+    for (const int bits: relevantBits)
+    {
+        size += size_t{1} << bits;
+    }
+    return size;
+}
 
-inline std::array<Bitboard, 64> bishopAttacksMasks; //< Precomputed bishop attack masks
-inline std::array<Bitboard, 64> rookAttacksMasks;   //< Precomputed rook attack masks
+static constexpr size_t BISHOP_ATTACK_TABLE_SIZE = getAttackTableSize(slider_utils::BISHOP_RELEVANT_BITS); //< 5248 entries (41 KB)
+static constexpr size_t ROOK_ATTACK_TABLE_SIZE   = getAttackTableSize(slider_utils::ROOK_RELEVANT_BITS);   //< 102400 entries (800 KB)
 
 static constexpr Bitboard NOT_A_FILE{18374403900871474942ULL};  //< All squares set to 1 except the 'a' file
 static constexpr Bitboard NOT_H_FILE{9187201950435737471ULL};   //< All squares set to 1 except the 'h' file
@@ -110,6 +157,188 @@ static constexpr Bitboard NOT_GH_FILE{4557430888798830399ULL};  //< All squares
     return attacks;
 }
 
+/**
+ * @brief Generates the attacks of a leaper piece (pawn, knight, king) for all the squares.
+ *
+ * @tparam GenerateAttacks A callable that generates attacks for a given square.
+ * @param generateAttacks The attack generator.
+ * @return The attacks from each square.
+ */
+template<typename GenerateAttacks>
+[[nodiscard]] constexpr std::array<Bitboard, 64> generateLeaperAttacks(GenerateAttacks generateAttacks)
+{
+    std::array<Bitboard, 64> attacks;
+    for (Square square = Square::a8; square <= Square::h1; square++)
+    {
+        attacks[static_cast<int>(square)] = generateAttacks(square);
+    }
+    return attacks;
+}
+
+/**
+ * @brief Generates the lookup data of a slider piece (bishop, rook) for all the squares.
+ *
+ * The attacks of each square are placed right after the ones of the previous square in the shared attack table.
+ *
+ * @tparam GenerateAttacks A callable that generates attacks for a given square.
+ * @tparam MagicNumbers An array holding the magic numbers.
+ * @tparam RelevantBits An array holding the number of relevant bits for each square.
+ * @param generateAttacks The generator of the relevant occupancy masks.
+ * @param magicNumbers The magic numbers of each square.
+ * @param relevantBitsArray The number of relevant occupancy bits of each square.
+ * @return The lookup data of each square.
+ */
+template<typename GenerateAttacks, typename MagicNumbers, typename RelevantBits>
+[[nodiscard]] constexpr std::array<MagicEntry, 64> generateSliderMagics(
+        GenerateAttacks generateAttacks,
+        const MagicNumbers& magicNumbers,
+        const RelevantBits& relevantBitsArray)
+{
+    std::array<MagicEntry, 64> magics{};
+    uint32_t offset = 0;
+
+    for (Square square = Square::a8; square <= Square::h1; square++)
+    {
+        // Determine the number of relevant occupancy bits for the given square and piece
+        // (how many different blocker configurations can exist for this square)
+        const int relevantBits = relevantBitsArray[static_cast<int>(square)];
+
+        MagicEntry& entry = magics[static_cast<int>(square)];
+        entry.mask        = generateAttacks(square); // Get all possible attacks for the square
+        entry.magic       = magicNumbers[static_cast<int>(square)];
+        entry.shift       = 64 - relevantBits;
+        entry.offset      = offset;
+
+        offset += 1U << relevantBits;
+    }
+
+    return magics;
+}
+
+/**
+ * @brief Generates the shared attack table of a slider piece (bishop, rook).
+ *
+ * @tparam Size The size of the table (see getAttackTableSize).
+ * @tparam GenerateAttacksOnTheFly A callable that generates attacks on the fly based on occupancy.
+ * @param magics The lookup data of each square (see generateSliderMagics).
+ * @param generateAttacksOnTheFly The attack generator.
+ * @return The attacks of all the squares, for all their relevant occupancies.
+ */
+template<size_t Size, typename GenerateAttacksOnTheFly>
+[[nodiscard]] constexpr std::array<Bitboard, Size> generateSliderAttacks(
+        const std::array<MagicEntry, 64>& magics,
+        GenerateAttacksOnTheFly generateAttacksOnTheFly)
+{
+    std::array<Bitboard, Size> attacks;
+
+    for (Square square = Square::a8; square <= Square::h1; square++)
+    {
+        const MagicEntry& entry    = magics[static_cast<int>(square)];
+        const int totalOccupancies = 1 << (64 - entry.shift);
+
+        for (int index = 0; index < totalOccupancies; index++)
+        {
+            const Bitboard occupancy = slider_utils::generateOccupancyMask(index, entry.mask);
+#ifdef USE_PEXT
+            // PEXT packs the occupancy bits in the same order as generateOccupancyMask: the index is the occupancy index
+            const uint64_t attacksIndex = index;
+#else
+            const uint64_t attacksIndex = occupancy.getBitboard() * entry.magic.getBitboard() >> entry.shift;
+#endif
+            // Save the set of squares that can be attacked given a specific blocker configuration for the square
+            attacks[entry.offset + attacksIndex] = generateAttacksOnTheFly(square, occupancy);
+        }
+    }
+
+    return attacks;
+}
+
+// All the tables are generated at compile time, so they need no initialization and live in read-only memory
+inline constexpr std::array<Bitboard, 64> whitePawnsAttacks = generateLeaperAttacks([](const Square square) { return generatePawnAttacks(White, square); }); //< Precomputed pawn attacks for white pawns
+inline constexpr std::array<Bitboard, 64> blackPawnsAttacks = generateLeaperAttacks([](const Square square) { return generatePawnAttacks(Black, square); }); //< Precomputed pawn attacks for black pawns
+inline constexpr std::array<Bitboard, 64> knightAttacks     = generateLeaperAttacks(generateKnightAttacks);                                               //< Precomputed knight attacks
+inline constexpr std::array<Bitboard, 64> kingAttacks       = generateLeaperAttacks(generateKingAttacks);                                                 //< Precomputed king attacks
+
+inline constexpr std::array<MagicEntry, 64> bishopMagics = generateSliderMagics(slider_utils::generateBishopAttacks, Magic::m_bishopMagicNumbers, slider_utils::BISHOP_RELEVANT_BITS); //< Lookup data of the bishop attacks of each square
+inline constexpr std::array<MagicEntry, 64> rookMagics   = generateSliderMagics(slider_utils::generateRookAttacks, Magic::m_rookMagicNumbers, slider_utils::ROOK_RELEVANT_BITS);       //< Lookup data of the rook attacks of each square
+
+/**
+ * @brief Generates the squares strictly between any two squares on the same rank, file or diagonal.
+ *
+ * @return The squares between each pair of squares (empty if they are not aligned).
+ */
+[[nodiscard]] constexpr std::array<std::array<Bitboard, 64>, 64> generateBetweenSquares()
+{
+    std::array<std::array<Bitboard, 64>, 64> betweenSquares;
+
+    for (Square from = Square::a8; from <= Square::h1; from++)
+    {
+        for (Square to = Square::a8; to <= Square::h1; to++)
+        {
+            const Bitboard fromBitboard(from);
+            const Bitboard toBitboard(to);
+
+            // The rays from each square, stopped by the other one, only overlap in between if they are aligned
+            if ((slider_utils::generateRookAttacksOnTheFly(from, Bitboard()) & toBitboard) != Bitboard())
+            {
+                betweenSquares[static_cast<int>(from)][static_cast<int>(to)] = slider_utils::generateRookAttacksOnTheFly(from, toBitboard) &
+                                                                               slider_utils::generateRookAttacksOnTheFly(to, fromBitboard);
+            }
+            else if ((slider_utils::generateBishopAttacksOnTheFly(from, Bitboard()) & toBitboard) != Bitboard())
+            {
+                betweenSquares[static_cast<int>(from)][static_cast<int>(to)] = slider_utils::generateBishopAttacksOnTheFly(from, toBitboard) &
+                                                                               slider_utils::generateBishopAttacksOnTheFly(to, fromBitboard);
+            }
+        }
+    }
+
+    return betweenSquares;
+}
+
+/**
+ * @brief Generates the full line (rank, file or diagonal) going through any two aligned squares.
+ *
+ * Used for the pinned pieces, which can only move along the line between their king and the pinner.
+ *
+ * @return The line through each pair of squares, including both squares (empty if they are not aligned).
+ */
+[[nodiscard]] constexpr std::array<std::array<Bitboard, 64>, 64> generateLineSquares()
+{
+    std::array<std::array<Bitboard, 64>, 64> lineSquares;
+
+    for (Square from = Square::a8; from <= Square::h1; from++)
+    {
+        for (Square to = Square::a8; to <= Square::h1; to++)
+        {
+            const Bitboard fromBitboard(from);
+            const Bitboard toBitboard(to);
+
+            // The empty board rays of both squares overlap on the two halves of the line outside of the squares
+            if ((slider_utils::generateRookAttacksOnTheFly(from, Bitboard()) & toBitboard) != Bitboard())
+            {
+                lineSquares[static_cast<int>(from)][static_cast<int>(to)] = (slider_utils::generateRookAttacksOnTheFly(from, Bitboard()) &
+                                                                             slider_utils::generateRookAttacksOnTheFly(to, Bitboard())) |
+                                                                            fromBitboard | toBitboard;
+            }
+            else if ((slider_utils::generateBishopAttacksOnTheFly(from, Bitboard()) & toBitboard) != Bitboard())
+            {
+                lineSquares[static_cast<int>(from)][static_cast<int>(to)] = (slider_utils::generateBishopAttacksOnTheFly(from, Bitboard()) &
+                                                                             slider_utils::generateBishopAttacksOnTheFly(to, Bitboard())) |
+                                                                            fromBitboard | toBitboard;
+            }
+        }
+    }
+
+    return lineSquares;
+}
+
+// The slider attack tables are defined in pregenerated_moves.cpp, so that they are only generated once
+extern const std::array<Bitboard, BISHOP_ATTACK_TABLE_SIZE> bishopAttacks; //< Precomputed bishop attacks of all the squares
+extern const std::array<Bitboard, ROOK_ATTACK_TABLE_SIZE> rookAttacks;     //< Precomputed rook attacks of all the squares
+
+extern const std::array<std::array<Bitboard, 64>, 64> betweenSquares; //< Squares strictly between two aligned squares ([from][to])
+extern const std::array<std::array<Bitboard, 64>, 64> lineSquares;    //< Line through two aligned squares, both included ([from][to])
+
 /**
  * @brief Gets the precomputed knight attacks for a given square.
  *
@@ -136,13 +365,8 @@ static constexpr Bitboard NOT_GH_FILE{4557430888798830399ULL};  //< All squares
  */
 [[nodiscard]] constexpr Bitboard getBishopAttacks(const Square square, const Bitboard occupancy)
 {
-    // Get the number of relevant occupancy bits for the given square
-    const int relevantBits = slider_utils::BISHOP_RELEVANT_BITS[std::to_underlying(square)];
-    // Calculate the magic index based on the occupancy and the precomputed magic number
-    const int magicIndex = (occupancy.getBitboard() & bishopAttacksMasks[std::to_underlying(square)].getBitboard()) *
-                                   Magic::m_bishopMagicNumbers[std::to_underlying(square)].getBitboard() >>
-                           (64 - relevantBits);
-    return bishopAttacks[std::to_underlying(square)][magicIndex];
+    const MagicEntry& entry = bishopMagics[std::to_underlying(square)];
+    return bishopAttacks[entry.offset + entry.getIndex(occupancy)];
 }
 
 /**
@@ -154,13 +378,8 @@ static constexpr Bitboard NOT_GH_FILE{4557430888798830399ULL};  //< All squares
  */
 [[nodiscard]] constexpr Bitboard getRookAttacks(const Square square, const Bitboard occupancy)
 {
-    // Get the number of relevant occupancy bits for the given square
-    const int relevantBits = slider_utils::ROOK_RELEVANT_BITS[std::to_underlying(square)];
-    // Calculate the magic index based on the occupancy and the precomputed magic number
-    const int magicIndex = (occupancy.getBitboard() & rookAttacksMasks[std::to_underlying(square)].getBitboard()) *
-                                   Magic::m_rookMagicNumbers[std::to_underlying(square)].getBitboard() >>
-                           (64 - relevantBits);
-    return rookAttacks[std::to_underlying(square)][magicIndex];
+    const MagicEntry& entry = rookMagics[std::to_underlying(square)];
+    return rookAttacks[entry.offset + entry.getIndex(occupancy)];
 }
 
 /**
@@ -192,93 +411,4 @@ static constexpr Bitboard NOT_GH_FILE{4557430888798830399ULL};  //< All squares
     // King attacks are precomputed for each square
     return kingAttacks[std::to_underlying(square)];
 }
-
-/**
- * @brief Initializes precomputed attacks for leaper pieces (pawns, knights, kings).
- */
-constexpr void initLeaperAttacks()
-{
-    for (int i = 0; i < board_dimensions::N_SQUARES; ++i)
-    {
-        whitePawnsAttacks[i] = generatePawnAttacks(White, static_cast<Square>(i));
-        blackPawnsAttacks[i] = generatePawnAttacks(Black, static_cast<Square>(i));
-        knightAttacks[i]     = generateKnightAttacks(static_cast<Square>(i));
-        kingAttacks[i]       = generateKingAttacks(static_cast<Square>(i));
-    }
-}
-
-/**
- * @brief Initializes precomputed attacks for slider pieces (bishops and rooks).
- *
- * @tparam GenerateAttacks A callable that generates attacks for a given square.
- * @tparam GenerateAttacksOnTheFly A callable that generates attacks on the fly based on occupancy.
- * @tparam AttackMasks An array holding the attack masks for each square.
- * @tparam Attacks An array holding the precomputed attacks for each square and occupancy.
- * @tparam MagicNumbers An array holding the magic numbers.
- * @tparam RelevantBits An array holding the number of relevant bits for each square.
- */
-template<typename GenerateAttacks, typename GenerateAttacksOnTheFly, typename AttackMasks, typename Attacks, typename MagicNumbers, typename RelevantBits>
-constexpr void initSlider(
-        GenerateAttacks generateAttacks,
-        GenerateAttacksOnTheFly generateAttacksOnTheFly,
-        AttackMasks& attackMasks,
-        Attacks& attacks,
-        const MagicNumbers& magicNumbers,
-        const RelevantBits& relevantBitsArray)
-{
-    for (Square square = Square::a8; square <= Square::h1; square++)
-    {
-        // Get all possible attacks for the square
-        attackMasks[static_cast<int>(square)] = generateAttacks(square);
-
-        // Determine the number of relevant occupancy bits for the given square and piece
-        // (how many different blocker configurations can exist for this square)
-        const int relevantBits     = relevantBitsArray[static_cast<int>(square)];
-        const int totalOccupancies = 1 << relevantBits;
-
-        for (int index = 0; index < totalOccupancies; index++)
-        {
-            // Determine the number of relevant occupancy bits for the given square and piece
-            // (how many different blocker configurations can exist for this square)
-            Bitboard occupancy = slider_utils::generateOccupancyMask(index, attackMasks[static_cast<int>(square)]);
-            int magicIndex     = (occupancy.getBitboard() * magicNumbers[static_cast<int>(square)].getBitboard()) >> (64 - relevantBits);
-            // Save the set of squares that can be attacked given a specific blocker configuration for the square
-            attacks[static_cast<int>(square)][magicIndex] = generateAttacksOnTheFly(square, occupancy);
-        }
-    }
-}
-
-/**
- * @brief Initializes precomputed attacks for slider pieces (bishops and rooks).
- *
- * Initializes the precomputed attacks for bishops and rooks using the
- * `initSlider` function template.
- */
-constexpr void initSliderAttacks()
-{
-    initSlider(
-            slider_utils::generateBishopAttacks,
-            slider_utils::generateBishopAttacksOnTheFly,
-            bishopAttacksMasks,
-            bishopAttacks,
-            Magic::m_bishopMagicNumbers,
-            slider_utils::BISHOP_RELEVANT_BITS);
-
-    initSlider(
-            slider_utils::generateRookAttacks,
-            slider_utils::generateRookAttacksOnTheFly,
-            rookAttacksMasks,
-            rookAttacks,
-            Magic::m_rookMagicNumbers,
-            slider_utils::ROOK_RELEVANT_BITS);
-}
-
-/**
- * @brief Initializes all precomputed piece attacks.
- */
-inline void initAllPieces()
-{
-    initLeaperAttacks();
-    initSliderAttacks();
-}
 } // namespace chess_engine::pregenerated_moves
\ No newline at end of file
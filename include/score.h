@@ -0,0 +1,42 @@
+/**
+ * @file score.h
+ * @brief Definition of the TaperedScore struct, a score with a middle game and an end game value.
+ *
+ * The two values are interpolated with the game phase (the remaining material) by the evaluation.
+ *
+ * @see https://www.chessprogramming.org/Tapered_Eval
+ */
+#pragma once
+
+namespace chess_engine
+{
+/**
+ * @brief Score with a middle game and an end game value, in centipawns.
+ */
+struct TaperedScore
+{
+    int middleGame = 0; //< Score in the middle game (and the opening)
+    int endGame    = 0; //< Score in the end game
+
+    constexpr TaperedScore& operator+=(const TaperedScore& other)
+    {
+        middleGame += other.middleGame;
+        endGame += other.endGame;
+        return *this;
+    }
+
+    constexpr TaperedScore& operator-=(const TaperedScore& other)
+    {
+        middleGame -= other.middleGame;
+        endGame -= other.endGame;
+        return *this;
+    }
+
+    constexpr TaperedScore operator-() const
+    {
+        return {-middleGame, -endGame};
+    }
+
+    bool operator==(const TaperedScore& other) const = default;
+};
+} // namespace chess_engine
@@ -1,49 +1,140 @@
 #pragma once
 
+#include <atomic>
 #include <limits>
+#include <vector>
 
 #include "evaluate.h"
+#include "move_picker.h"
+#include "pawn_hash_table.h"
+#include "search_stats.h"
+#include "transposition_table.h"
 
 namespace chess_engine
 {
+class ThreadPool;
+
+/**
+ * @brief Search of a single thread.
+ *
+ * Each search thread owns its own search data (node counter, killer moves, history heuristic, pawn hash table),
+ * while the transposition table is shared by all the threads of the ThreadPool.
+ */
 class Search
 {
 public:
-    static constexpr int maxPly = 256;
-    struct PVLine
-    {
-        std::array<Move, maxPly> moves = {};
-        int length                     = 0;
-    };
-
-    static inline PVLine emptyLine = {std::array<Move, maxPly>{}, 0};
+    static constexpr int maxPly           = 256;
+    static constexpr int positiveInfinity = 100000;                    //< Bound of the scores, above any mate score
+    static constexpr int mateThreshold    = positiveInfinity - maxPly; //< Scores above this value are mate scores
+    static constexpr int tbWinScore       = mateThreshold - maxPly;    //< Score of a tablebase win at the root (minus the ply), below the mates
+    static constexpr int tbThreshold      = tbWinScore - maxPly;       //< Scores above this value are tablebase or mate scores
 
 public:
+    /**
+     * @brief Construct the search of a thread.
+     *
+     * @param threadPool The pool the thread belongs to.
+     * @param threadId The index of the thread in the pool (0 is the main thread).
+     */
+    Search(ThreadPool& threadPool, int threadId);
+
     /**
      * @brief Perform a search to find the best move.
      *
      * Initiate a search to find the best move for the current position on the board
-     * up to a specified depth. Use the negamax algorithm with alpha-beta pruning.
+     * within the limits of the ThreadPool (see ThreadPool::getLimits). Use the negamax algorithm with alpha-beta pruning.
+     *
+     * Only the main thread prints the search information and checks the limits. Helper threads start from
+     * a different depth to better fill the shared transposition table, and run until the main thread is done.
      *
      * @param board The current board position.
-     * @param depth The maximum depth to search.
      * @return The evaluation score of the best move found.
      */
-    static int search(Board& board, int depth);
+    int search(Board& board);
+
+    /**
+     * @brief Get the best move found by the last search.
+     *
+     * @return The best move.
+     */
+    [[nodiscard]] Move getBestMove() const;
+
+    /**
+     * @brief Get the expected reply to the best move found by the last search.
+     *
+     * @return The second move of the principal variation (can be an invalid move if there is none).
+     */
+    [[nodiscard]] Move getPonderMove() const;
+
+    /**
+     * @brief Get the principal variation of the last iteration completed by the last search.
+     *
+     * @return The moves of the principal variation (empty if there is no legal move).
+     */
+    [[nodiscard]] const std::vector<Move>& getPrincipalVariation() const;
+
+    /**
+     * @brief Get the depth of the last iteration completed by the last search.
+     *
+     * @return The depth (0 if no iteration was completed).
+     */
+    [[nodiscard]] int getCompletedDepth() const;
+
+    /**
+     * @brief Get the number of nodes searched by this thread.
+     *
+     * @return The number of nodes searched.
+     */
+    [[nodiscard]] uint64_t getNodes() const;
+
+    /**
+     * @brief Get the number of positions found in the endgame tablebases by this thread.
+     *
+     * @return The number of tablebase hits.
+     */
+    [[nodiscard]] uint64_t getTBHits() const;
+
+    /**
+     * @brief Get the counters of the last search of this thread (only collected with USE_SEARCH_STATS).
+     *
+     * @return The search statistics.
+     */
+    [[nodiscard]] const SearchStats& getStats() const;
+
+    /** @brief Convert a score to the format stored in the transposition table.
+     *
+     * Mate and tablebase scores are stored relative to the current node instead of the root,
+     * so that they stay valid when the position is reached through a different path.
+     *
+     * @param score The score relative to the root.
+     * @param ply The current ply (depth from the root).
+     * @return The score to store in the transposition table.
+     */
+    [[nodiscard]] static int scoreToTT(int score, int ply);
+
+    /** @brief Convert a score read from the transposition table back to a score relative to the root.
+     *
+     * @param score The score stored in the transposition table.
+     * @param ply The current ply (depth from the root).
+     * @return The score relative to the root.
+     * @see scoreToTT
+     */
+    [[nodiscard]] static int scoreFromTT(int score, int ply);
 
 private:
     /**
      * @brief Negamax search with alpha-beta pruning.
      *
+     * The principal variation found from the node is stored in the row ply of the triangular PV table.
+     *
      * @param alpha The alpha value for alpha-beta pruning.
      * @param beta The beta value for alpha-beta pruning.
      * @param board The current board position.
-     * @param pvLine The principal variation line to store the best moves.
      * @param depth The remaining depth to search. Can be extended in certain situations (e.g., check).
      * @param ply The current ply (depth from the root).
      * @return The evaluation score of the best move found.
      */
-    [[nodiscard]] static int negamax(int alpha, int beta, Board& board, PVLine& pvLine, int depth, int ply = 0);
+    [[nodiscard]] int negamax(int alpha, int beta, Board& board, int depth, int ply = 0);
 
     /**
      * @brief Quiescence search to evaluate "quiet" positions.
@@ -57,22 +148,34 @@ private:
      * @param ply The current ply (depth from the root).
      * @return The evaluation score of the position.
      */
-    [[nodiscard]] static int quiescence(int alpha, int beta, Board& board, int ply);
+    [[nodiscard]] int quiescence(int alpha, int beta, Board& board, int ply);
 
-    /** @brief Sort moves based on their scores to improve search efficiency.
+    /**
+     * @brief Evaluate a position, with the NNUE network if one is loaded, otherwise with the hand-crafted evaluation.
      *
-     * @param moves The list of moves to sort.
-     * @param ply The current ply for killer move and history heuristic.
-     * @param pvLine The principal variation line to prioritize moves in the PV.
+     * @param board The board to evaluate.
+     * @return The evaluation score in centipawns, from the point of view of the side to move.
      */
-    static void sortMoves(std::vector<Move>& moves, int ply, const PVLine& pvLine = emptyLine);
+    [[nodiscard]] int evaluate(const Board& board);
 
     /** @brief Reset search data.
      *
      * This function resets the search data, including the number of nodes searched,
      * killer moves, and history heuristic tables.
      */
-    static void resetSearchData();
+    void resetSearchData();
+
+    /** @brief Count a searched node.
+     *
+     * The main thread also checks the limits of the search every limitsCheckInterval nodes.
+     */
+    void countNode();
+
+    /** @brief Check if the search must be interrupted.
+     *
+     * @return True if the search has been stopped, false otherwise.
+     */
+    [[nodiscard]] bool isStopped() const;
 
     /** @brief Determine if a move can be reduced using Late Move Reductions (LMR).
      *
@@ -94,26 +197,49 @@ private:
      * @param isCheck Indicates if the current position is a check.
      * @param depth The current search depth.
      * @param ply The current ply (depth from the root).
-     * @param pvLineLength The length of the principal variation line.
+     * @param isPVNode Indicates if the node is searched with an open window (a principal variation node).
      * @return True if pruning can be applied, false otherwise.
      */
-    static bool canPrune(bool isCheck, int depth, int ply, int pvLineLength);
+    static bool canPrune(bool isCheck, int depth, int ply, bool isPVNode);
+
+    /** @brief Update the principal variation of a node with a new best move.
+     *
+     * The principal variation of the node becomes the move followed by the principal variation of the child node.
+     *
+     * @param move The new best move.
+     * @param ply The current ply (depth from the root).
+     */
+    void updatePV(const Move& move, int ply);
 
 private:
-    static constexpr int positiveInfinity           = 100000;//std::numeric_limits<int>::max();
     static constexpr int negativeInfinity           = -positiveInfinity;
     static constexpr int aspirationWindowSize       = 50;
     static constexpr int lateMoveReductionThreshold = 3;
     static constexpr int minDepthForLMR             = 2;
     static constexpr int LMRReduction               = 2;
     static constexpr int NullMovePruningReduction   = 2;
+    static constexpr int deltaPruningMargin         = 200;                       //< Margin of the delta pruning in the quiescence search
+    static constexpr int tbDepthBonus               = 6;                         //< Depth added to the tablebase scores stored in the transposition table
+    static constexpr uint64_t limitsCheckInterval   = 1024;                      //< Number of nodes between two checks of the limits (a power of two)
 
-public:
-    static Move s_bestMove; //< The best move found during the search
+    ThreadPool& m_threadPool;                 //< The pool the thread belongs to
+    TranspositionTable& m_transpositionTable; //< Transposition table shared by all the threads
+    const int m_threadId;                     //< Index of the thread in the pool (0 is the main thread)
+
+    Move m_bestMove;                   //< The best move found during the search
+    Move m_ponderMove;                 //< The expected reply to the best move
+    std::vector<Move> m_rootPV;        //< The principal variation of the last completed iteration
+    int m_completedDepth = 0;          //< The depth of the last completed iteration
+    std::atomic<uint64_t> m_nodes  = 0; //< The number of nodes searched (read by the main thread)
+    std::atomic<uint64_t> m_tbHits = 0; //< The number of positions found in the tablebases (read by the main thread)
 
-    static inline int s_nodes = 0; //< The number of nodes searched
+    std::array<KillerMoves, maxPly> m_killerMoves = {}; //< Killer moves table for move ordering (2 moves per ply)
+    HistoryTable m_historyHeuristic               = {}; //< History heuristic table for move ordering
+    PawnHashTable m_pawnHashTable;                      //< Evaluation of the pawn structures, kept across searches
 
-    static inline std::array<std::array<Move, maxPly>, 2> s_killerMoves                           = {}; //< Killer moves table for move ordering (2 moves per ply)
-    static inline std::array<std::array<int, board_dimensions::N_SQUARES>, 12> s_historyHeuristic = {}; //< History heuristic table for move ordering
+    // Triangular PV table: the principal variation of the node at ply p is m_pvTable[p][p..m_pvLength[p])
+    std::array<std::array<Move, maxPly + 1>, maxPly + 1> m_pvTable = {}; //< Principal variation of each ply
+    std::array<int, maxPly + 1> m_pvLength                         = {}; //< End of the principal variation of each ply
+    SearchStats m_stats;                                //< Counters of the search (only collected with USE_SEARCH_STATS)
 };
-} // namespace chess_engine
\ No newline at end of file
+} // namespace chess_engine
@@ -0,0 +1,73 @@
+/**
+ * @file search_stats.h
+ * @brief Declaration of the SearchStats struct, counters of the search used to tune the pruning and the move ordering.
+ *
+ * The counters are only collected when the engine is built with the SEARCH_STATS CMake option (which defines
+ * USE_SEARCH_STATS). Otherwise SearchStats::add does nothing and is optimized away: the search is not slowed down.
+ */
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace chess_engine
+{
+/**
+ * @brief Counters of a search, kept by each search thread and summed by the ThreadPool.
+ */
+struct SearchStats
+{
+#ifdef USE_SEARCH_STATS
+    static constexpr bool s_enabled = true; //< True if the counters are collected
+#else
+    static constexpr bool s_enabled = false; //< True if the counters are collected
+#endif
+
+    uint64_t nodes            = 0; //< Nodes of the main search (negamax)
+    uint64_t quiescenceNodes  = 0; //< Nodes of the quiescence search
+    uint64_t evalCalls        = 0; //< Calls to the evaluation
+    uint64_t ttProbes         = 0; //< Lookups in the transposition table
+    uint64_t ttHits           = 0; //< Lookups finding the position
+    uint64_t tbProbes         = 0; //< Probes of the endgame tablebases
+    uint64_t tbHits           = 0; //< Probes finding the position
+    uint64_t betaCutoffs      = 0; //< Beta cutoffs of the main search
+    uint64_t firstMoveCutoffs = 0; //< Beta cutoffs on the first move searched (the higher the better the move ordering)
+    uint64_t nullMoveSearches = 0; //< Null move searches
+    uint64_t nullMoveCutoffs  = 0; //< Null move searches failing high
+    uint64_t lmrSearches      = 0; //< Searches with a late move reduction
+    uint64_t lmrResearches    = 0; //< Reduced searches failing high, re-searched at full depth
+    uint64_t allNodes         = 0; //< Nodes searching all their moves (no cutoff)
+    uint64_t allNodesMoves    = 0; //< Moves searched in those nodes (i.e. the length of their move lists)
+    std::vector<int64_t> depthTimes;   //< Time at the end of each iteration of the main thread, in milliseconds
+
+    /**
+     * @brief Add to a counter, if the counters are collected.
+     *
+     * @param counter The counter to add to.
+     * @param value The value to add.
+     */
+    void add(uint64_t SearchStats::* const counter, const uint64_t value = 1)
+    {
+        if constexpr (s_enabled)
+        {
+            this->*counter += value;
+        }
+    }
+
+    /**
+     * @brief Add the counters of another thread (the depth times are those of the main thread only).
+     *
+     * @param other The counters to add.
+     * @return The summed counters.
+     */
+    SearchStats& operator+=(const SearchStats& other);
+
+    /**
+     * @brief Format the counters as UCI "info string" lines.
+     *
+     * @return The lines, each one ending with a newline.
+     */
+    [[nodiscard]] std::string toString() const;
+};
+} // namespace chess_engine
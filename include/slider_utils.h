@@ -214,8 +214,7 @@ constexpr Bitboard generateOccupancyMask(const int index, Bitboard attackMask)
     const int relevantBits = attackMask.getNumberOfBitsSet();
     for (int i = 0; i < relevantBits; i++)
     {
-        const Square square = attackMask.getSquareOfLeastSignificantBitIndex();
-        attackMask.clearBit(square);
+        const Square square = attackMask.popLsb();
 
         if (index & (1 << i))
         {
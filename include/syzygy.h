@@ -0,0 +1,90 @@
+/**
+ * @file syzygy.h
+ * @brief Probing of the Syzygy endgame tablebases, with the Fathom library.
+ *
+ * The tablebases give the exact result of the positions with few pieces: WDL (win/draw/loss) tables are probed
+ * inside the search, DTZ (distance to zeroing the fifty-move counter) tables at the root to only keep the moves
+ * preserving the result.
+ *
+ * The table files are memory mapped read-only by Fathom when first probed, so that they are shared by all the search
+ * threads and by all the engine processes using them.
+ *
+ * The probing is only available when the engine is built with the SYZYGY CMake option (which defines USE_SYZYGY),
+ * otherwise no tables are ever found.
+ *
+ * @see https://www.chessprogramming.org/Syzygy_Bases
+ * @see https://github.com/jdart1/Fathom
+ */
+#pragma once
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "board.h"
+#include "move.h"
+
+namespace chess_engine::syzygy
+{
+/**
+ * @brief Result of a tablebase position, for the side to move.
+ *
+ * A cursed win (blessed loss) is a win (loss) that the fifty-move rule turns into a draw.
+ */
+enum class WDL : int
+{
+    Loss,
+    BlessedLoss,
+    Draw,
+    CursedWin,
+    Win
+};
+
+/**
+ * @brief Load the tablebases of a path, replacing the current ones.
+ *
+ * @param path The directories of the table files, separated by ':' (';' on Windows), or "" or "<empty>" to unload them.
+ * @return True if tables were found, false otherwise.
+ * @note Must not be called while a search is running.
+ */
+[[nodiscard]] bool init(const std::string& path);
+
+/**
+ * @brief Get the maximum number of pieces of the loaded tables.
+ *
+ * @return The number of pieces, including the kings (0 if no tables are loaded).
+ */
+[[nodiscard]] int getMaxPieces();
+
+/**
+ * @brief Check if the WDL tables can be probed for a position.
+ *
+ * They can only be probed without castling rights, right after a capture or a pawn move (they do not know
+ * the fifty-move counter), and with at most getMaxPieces pieces.
+ *
+ * @param board The position.
+ * @return True if probeWDL can be called, false otherwise.
+ */
+[[nodiscard]] bool canProbe(const Board& board);
+
+/**
+ * @brief Probe the WDL tables.
+ *
+ * Thread-safe.
+ *
+ * @param board The position (see canProbe).
+ * @return The result of the position for the side to move, or std::nullopt if the table is missing.
+ */
+[[nodiscard]] std::optional<WDL> probeWDL(const Board& board);
+
+/**
+ * @brief Get the moves of a position keeping its tablebase result, using the DTZ tables.
+ *
+ * The fifty-move counter is taken into account: a win that would be too long is a draw.
+ *
+ * @param board The position (with any fifty-move counter, but without castling rights).
+ * @return The moves with the best result for the side to move, or an empty list if the position is not in the tables.
+ * @note Not thread-safe: called once per search, before the threads start.
+ */
+[[nodiscard]] std::vector<Move> getRootMoves(const Board& board);
+} // namespace chess_engine::syzygy
@@ -0,0 +1,252 @@
+/**
+ * @file thread_pool.h
+ * @brief Declaration of the ThreadPool class running a multi-threaded search.
+ *
+ * The search is parallelized with Lazy SMP: all the threads search the same root position
+ * and only communicate through the shared transposition table. The main thread reports the result.
+ *
+ * The search runs on its own thread, so that the UCI loop can keep reading commands ("stop", "ponderhit",
+ * "isready") while the engine is thinking.
+ *
+ * @see https://www.chessprogramming.org/Lazy_SMP
+ */
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "search.h"
+#include "time_manager.h"
+#include "transposition_table.h"
+
+namespace chess_engine
+{
+class ThreadPool
+{
+public:
+    static constexpr int s_maxThreads = 1024; //< Maximum number of search threads
+
+    /**
+     * @brief Construct a pool with a single (main) search thread.
+     */
+    ThreadPool();
+
+    /**
+     * @brief Stop the current search, if any, and wait for it to finish.
+     */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&)            = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Set the number of search threads, including the main thread.
+     *
+     * @param numberOfThreads The number of threads (clamped between 1 and s_maxThreads).
+     */
+    void setNumberOfThreads(int numberOfThreads);
+
+    /**
+     * @brief Get the number of search threads, including the main thread.
+     *
+     * @return The number of threads.
+     */
+    [[nodiscard]] int getNumberOfThreads() const;
+
+    /**
+     * @brief Enable or disable the "info" lines printed by the main thread after each iteration.
+     *
+     * @param isSilent True to search without printing anything (e.g. in the batch analysis mode).
+     */
+    void setSilent(bool isSilent);
+
+    /**
+     * @brief Check if the search information is printed.
+     *
+     * @return True if the search does not print anything, false otherwise.
+     */
+    [[nodiscard]] bool isSilent() const;
+
+    /**
+     * @brief Search the position with all the threads of the pool.
+     *
+     * The main thread searches on the calling thread, while the helper threads search
+     * on their own std::thread until the main thread is done.
+     * An infinite or ponder search does not return before "stop" (or "ponderhit" when pondering).
+     *
+     * @param board The current board position.
+     * @param limits The limits of the search.
+     * @return The evaluation score of the best move found by the main thread.
+     */
+    int search(const Board& board, const SearchLimits& limits);
+
+    /**
+     * @brief Start a search in the background and print the best move when it is done.
+     *
+     * The previous search, if any, is waited for first.
+     *
+     * @param board The current board position.
+     * @param limits The limits of the search.
+     */
+    void startSearch(const Board& board, const SearchLimits& limits);
+
+    /**
+     * @brief Wait until the background search, if any, is finished.
+     */
+    void waitForSearchFinished();
+
+    /**
+     * @brief Check if a background search is running (including pondering and infinite searches).
+     *
+     * @return True from startSearch until the best move of the search is printed, false otherwise.
+     */
+    [[nodiscard]] bool isSearching() const;
+
+    /**
+     * @brief Interrupt the current search.
+     */
+    void stop();
+
+    /**
+     * @brief Signal that the opponent played the expected move while pondering.
+     *
+     * The search goes on as a normal search, limited by the time of the original "go ponder" command.
+     */
+    void ponderhit();
+
+    /**
+     * @brief Check the limits of the current search, and stop it if one of them is reached.
+     *
+     * Called periodically by the main thread during the search.
+     */
+    void checkLimits();
+
+    /**
+     * @brief Get the best move found by the main thread in the last search.
+     *
+     * @return The best move.
+     */
+    [[nodiscard]] Move getBestMove() const;
+
+    /**
+     * @brief Get the move the main thread expects the opponent to reply with, to ponder on.
+     *
+     * @return The ponder move (can be an invalid move if there is none).
+     */
+    [[nodiscard]] Move getPonderMove() const;
+
+    /**
+     * @brief Get the principal variation of the last iteration completed by the main thread.
+     *
+     * @return The moves of the principal variation (empty if there is no legal move).
+     */
+    [[nodiscard]] const std::vector<Move>& getPrincipalVariation() const;
+
+    /**
+     * @brief Get the depth of the last iteration completed by the main thread in the last search.
+     *
+     * @return The depth (0 if no iteration was completed).
+     */
+    [[nodiscard]] int getCompletedDepth() const;
+
+    /**
+     * @brief Get the number of nodes searched by all the threads in the current (or last) search.
+     *
+     * @return The total number of nodes searched.
+     */
+    [[nodiscard]] uint64_t getTotalNodes() const;
+
+    /**
+     * @brief Get the number of positions found in the endgame tablebases by all the threads in the current (or last) search.
+     *
+     * @return The total number of tablebase hits.
+     */
+    [[nodiscard]] uint64_t getTotalTBHits() const;
+
+    /**
+     * @brief Get the root moves keeping the tablebase result of the position of the current (or last) search.
+     *
+     * @return The moves to search, or an empty list to search all the moves (the root is not in the tablebases).
+     * @see syzygy::getRootMoves
+     */
+    [[nodiscard]] const std::vector<Move>& getRootMoves() const;
+
+    /**
+     * @brief Check if the search must be interrupted.
+     *
+     * @return True if the search has been stopped, false otherwise.
+     */
+    [[nodiscard]] bool isStopped() const;
+
+    /**
+     * @brief Get the transposition table shared by all the threads.
+     *
+     * @return The transposition table.
+     */
+    [[nodiscard]] TranspositionTable& getTranspositionTable();
+
+    /**
+     * @brief Get the limits of the current (or last) search.
+     *
+     * @return The search limits.
+     */
+    [[nodiscard]] const SearchLimits& getLimits() const;
+
+    /**
+     * @brief Get the time manager of the current (or last) search.
+     *
+     * @return The time manager.
+     */
+    [[nodiscard]] const TimeManager& getTimeManager() const;
+
+    /**
+     * @brief Get the counters of the last finished search, summed over all the threads.
+     *
+     * Only collected with USE_SEARCH_STATS (see search_stats.h).
+     *
+     * @return The search statistics.
+     */
+    [[nodiscard]] SearchStats getStats();
+
+private:
+    /**
+     * @brief Reset the state of the pool for a new search.
+     *
+     * @param board The position to search.
+     * @param limits The limits of the search.
+     */
+    void prepareSearch(const Board& board, const SearchLimits& limits);
+
+    /**
+     * @brief Run a search prepared by prepareSearch.
+     *
+     * @param board The position to search.
+     * @return The evaluation score of the best move found by the main thread.
+     */
+    int runSearch(const Board& board);
+
+    /**
+     * @brief Print the "bestmove" command for the last search.
+     *
+     * @param board The position that was searched, used to pick a legal move if the search found none.
+     */
+    void printBestMove(const Board& board) const;
+
+    TranspositionTable m_transpositionTable;        //< Transposition table shared by all the threads
+    std::vector<std::unique_ptr<Search>> m_threads; //< Search data of each thread (index 0 is the main thread)
+    std::atomic<bool> m_stop;                       //< Set to interrupt the search
+    SearchLimits m_limits;                          //< Limits of the current search
+    std::vector<Move> m_rootMoves;                  //< Root moves keeping the tablebase result, empty to search all the moves
+    TimeManager m_timeManager;                      //< Time allocated to the current search
+    std::thread m_searchThread;                     //< Thread running the background search
+    std::atomic<bool> m_isSearching = false;        //< Set while the background search is running
+    std::mutex m_mutex;                             //< Protects the wait for "stop" or "ponderhit"
+    std::condition_variable m_condition;            //< Notified on "stop" and "ponderhit"
+    SearchStats m_stats;                            //< Counters of the last finished search (protected by m_mutex)
+    bool m_isSilent = false;                        //< Do not print the search information
+};
+} // namespace chess_engine
@@ -0,0 +1,126 @@
+/**
+ * @file time_manager.h
+ * @brief Declaration of the search limits and of the TimeManager class.
+ *
+ * The time manager allocates two limits for each move:
+ * - a soft limit, checked between two iterations of the iterative deepening: a new iteration is not started past it.
+ * - a hard limit, checked during the search: the search is interrupted as soon as it is reached.
+ *
+ * @see https://www.chessprogramming.org/Time_Management
+ */
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#include "pieces.h"
+
+namespace chess_engine
+{
+/**
+ * @brief Limits of a search, as given by the UCI "go" command.
+ */
+struct SearchLimits
+{
+    int depth                        = 0;     //< Maximum depth to search (0 if not limited)
+    uint64_t nodes                   = 0;     //< Maximum number of nodes to search (0 if not limited)
+    int64_t moveTime                 = 0;     //< Time to search in milliseconds (0 if not limited)
+    std::array<int64_t, 2> time      = {};    //< Remaining time of each side in milliseconds (0 if not limited)
+    std::array<int64_t, 2> increment = {};    //< Increment per move of each side in milliseconds
+    int movesToGo                    = 0;     //< Number of moves to the next time control (0 if sudden death)
+    bool infinite                    = false; //< Search until the "stop" command
+    bool ponder                      = false; //< Search in ponder mode until "ponderhit" or "stop"
+
+    /**
+     * @brief Check if the search is limited by time.
+     *
+     * @param side The side to move.
+     * @return True if the search must be stopped when the allocated time is over, false otherwise.
+     */
+    [[nodiscard]] bool isTimeManaged(Side side) const;
+};
+
+/**
+ * @brief Allocate and track the time of a search.
+ */
+class TimeManager
+{
+public:
+    /**
+     * @brief Start tracking the time of a new search and compute its limits.
+     *
+     * @param limits The limits of the search.
+     * @param side The side to move.
+     */
+    void start(const SearchLimits& limits, Side side);
+
+    /**
+     * @brief Switch from pondering to the normal search: the time limits start being enforced.
+     *
+     * The elapsed time is counted from the moment of the ponderhit, since the opponent clock
+     * was running while pondering.
+     */
+    void ponderhit();
+
+    /**
+     * @brief Get the elapsed time since the start of the search.
+     *
+     * @return The elapsed time in milliseconds.
+     */
+    [[nodiscard]] int64_t getElapsedTime() const;
+
+    /**
+     * @brief Check if a new iteration of the iterative deepening should not be started.
+     *
+     * @return True if the soft limit is reached, false otherwise.
+     */
+    [[nodiscard]] bool isSoftLimitReached() const;
+
+    /**
+     * @brief Check if the search must be interrupted.
+     *
+     * @return True if the hard limit is reached, false otherwise.
+     */
+    [[nodiscard]] bool isHardLimitReached() const;
+
+    /**
+     * @brief Check if the engine is pondering, i.e. searching on the opponent's time.
+     *
+     * @return True until "ponderhit" if the search was started with "go ponder", false otherwise.
+     */
+    [[nodiscard]] bool isPondering() const;
+
+    /**
+     * @brief Get the soft limit of the current search.
+     *
+     * @return The soft limit in milliseconds (0 if the search is not limited by time).
+     */
+    [[nodiscard]] int64_t getSoftLimit() const;
+
+    /**
+     * @brief Get the hard limit of the current search.
+     *
+     * @return The hard limit in milliseconds (0 if the search is not limited by time).
+     */
+    [[nodiscard]] int64_t getHardLimit() const;
+
+private:
+    /**
+     * @brief Get the current time.
+     *
+     * @return The current time in milliseconds, from a monotonic clock.
+     */
+    [[nodiscard]] static int64_t now();
+
+    static constexpr int64_t s_moveOverhead    = 30; //< Time kept for the communication with the GUI (milliseconds)
+    static constexpr int s_defaultMovesToGo    = 30; //< Expected number of moves left in sudden death time controls
+    static constexpr int s_hardLimitMultiplier = 4;  //< Hard limit in terms of the soft limit
+
+    std::atomic<int64_t> m_startTime = 0;     //< Time the search (or the ponderhit) started at, in milliseconds
+    int64_t m_softLimit              = 0;     //< Soft limit in milliseconds
+    int64_t m_hardLimit              = 0;     //< Hard limit in milliseconds
+    bool m_isTimeManaged             = false; //< True if the search is limited by time
+    std::atomic<bool> m_isPondering  = false; //< True while pondering, the limits are not enforced
+};
+} // namespace chess_engine
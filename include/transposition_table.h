@@ -0,0 +1,276 @@
+/**
+ * @file transposition_table.h
+ * @brief Declaration of the TranspositionTable class used to cache search results.
+ *
+ * The table is indexed by the Zobrist hash of the position (see Board::getZobristHash) and is
+ * organized in buckets of a few entries each. The number of buckets is always a power of two,
+ * so that the bucket index can be computed with a simple mask.
+ *
+ * The table is shared by all the search threads without any lock: each entry is stored as two
+ * 64-bit words, the key XOR-ed with the data and the data itself. An entry torn by concurrent writes
+ * no longer matches its key and is simply ignored.
+ *
+ * The table can be saved to a file and loaded back (see save and load), so that a new process starts from the results
+ * of previous searches. A loaded file is mapped copy-on-write: the processes loading the same file share its pages
+ * until they overwrite them, and the file itself is never modified.
+ *
+ * Otherwise the table is allocated on huge pages if possible (see large_pages.h), and initialized and cleared by as many
+ * threads as the search uses, each one writing its own slice of the table first: on a NUMA system the pages of the table
+ * are spread over the nodes the threads run on, instead of all being placed on the node of a single thread.
+ *
+ * File format (native endianness):
+ * - header (64 bytes): "CETTHASH", the format version (uint32), the number of entries of a bucket (uint32),
+ *   the signature of the Zobrist keys (uint64, see zobrist::getKeysSignature), the number of buckets (uint64),
+ *   the generation (uint8), then zeros,
+ * - the buckets, as stored in memory.
+ *
+ * @see https://www.chessprogramming.org/Transposition_Table
+ */
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "large_pages.h"
+#include "move.h"
+
+namespace chess_engine
+{
+/**
+ * @brief Type of bound stored in a transposition table entry.
+ */
+enum class TTBound : uint8_t
+{
+    None,       // Empty entry
+    Exact,      // The score is exact (PV node)
+    LowerBound, // The score is a lower bound (fail-high, beta cutoff)
+    UpperBound  // The score is an upper bound (fail-low, no move raised alpha)
+};
+
+/**
+ * @brief A single entry of the transposition table, as returned by TranspositionTable::probe.
+ *
+ * Inside the table the entry is packed in 16 bytes, so that a whole bucket fits in a cache line.
+ */
+struct TTEntry
+{
+    uint64_t key       = 0;             //< Zobrist hash of the position
+    int32_t score      = 0;             //< Score of the position
+    uint16_t move      = 0;             //< Best move found, packed (see TranspositionTable::packMove)
+    uint8_t depth      = 0;             //< Depth the position was searched to
+    TTBound bound      = TTBound::None; //< Type of bound of the score
+    uint8_t generation = 0;             //< Search generation the entry was written in (6 bits)
+};
+
+/**
+ * @brief Fixed size hash table storing the results of previous searches.
+ */
+class TranspositionTable
+{
+public:
+    static constexpr size_t s_defaultSizeInMB = 16;    //< Default size of the table
+    static constexpr size_t s_maxSizeInMB     = 65536; //< Maximum size of the table
+
+    /**
+     * @brief Construct a transposition table of the default size.
+     */
+    TranspositionTable();
+
+    /**
+     * @brief Construct a transposition table of the given size.
+     *
+     * @param sizeInMB The size of the table in megabytes.
+     */
+    explicit TranspositionTable(size_t sizeInMB);
+
+    /**
+     * @brief Resize the table. All the stored entries are lost.
+     *
+     * The number of buckets is rounded down to a power of two, and halved as long as the memory cannot be allocated
+     * (see getSizeInMB for the size actually used).
+     *
+     * @param sizeInMB The new size of the table in megabytes.
+     * @return True if the table has the requested size, false if it had to be made smaller.
+     * @throws std::bad_alloc If not even 1 MB can be allocated.
+     */
+    bool resize(size_t sizeInMB);
+
+    /**
+     * @brief Set the number of threads the table is initialized and cleared by (the number of search threads).
+     *
+     * If the number changes, the table is allocated again (all the stored entries are lost) so that its pages are
+     * spread over the threads, unless it was loaded from a file.
+     *
+     * @param numberOfThreads The number of threads.
+     */
+    void setNumberOfThreads(int numberOfThreads);
+
+    /**
+     * @brief Remove all the entries from the table.
+     *
+     * @note Must not be called while a search is running.
+     */
+    void clear();
+
+    /**
+     * @brief Signal the start of a new search.
+     *
+     * Entries written in previous searches become preferred candidates for replacement.
+     */
+    void newSearch();
+
+    /**
+     * @brief Look up a position in the table.
+     *
+     * @param key The Zobrist hash of the position.
+     * @param entry The entry found, if any.
+     * @return True if the position was found, false otherwise.
+     */
+    [[nodiscard]] bool probe(uint64_t key, TTEntry& entry) const;
+
+    /**
+     * @brief Store a position in the table.
+     *
+     * If the position is already stored, the entry is overwritten. Otherwise the entry
+     * of the bucket with the lowest depth (entries from older searches count as shallower) is replaced.
+     *
+     * @param key The Zobrist hash of the position.
+     * @param depth The depth the position was searched to.
+     * @param score The score of the position.
+     * @param bound The type of bound of the score.
+     * @param move The best move found (can be an invalid move if there is none).
+     */
+    void store(uint64_t key, int depth, int score, TTBound bound, const Move& move);
+
+    /**
+     * @brief Save the table to a file.
+     *
+     * The table is written to a temporary file first, then renamed, so that the processes that loaded a previous version
+     * of the file (see load) keep their mapping intact.
+     *
+     * @note Must not be called while a search is running.
+     *
+     * @param path The path of the file.
+     * @return True if the table was saved, false otherwise.
+     */
+    [[nodiscard]] bool save(const std::string& path) const;
+
+    /**
+     * @brief Load a table saved with save, replacing the current one.
+     *
+     * The table takes the size of the saved one. The file is rejected if it was written with another format version,
+     * or with other Zobrist keys (by another build of the engine).
+     *
+     * @note Must not be called while a search is running.
+     *
+     * @param path The path of the file.
+     * @return True if the table was loaded, false otherwise (the current table is then left unchanged).
+     */
+    [[nodiscard]] bool load(const std::string& path);
+
+    /**
+     * @brief Get the size of the table.
+     *
+     * @return The size of the table in megabytes (rounded down).
+     */
+    [[nodiscard]] size_t getSizeInMB() const;
+
+    /**
+     * @brief Get a description of the memory of the table, for the logs.
+     *
+     * @return The size of the table, the kind of pages it was allocated on and their placement (see large_pages::describePlacement).
+     */
+    [[nodiscard]] std::string describeMemory() const;
+
+    /**
+     * @brief Get an approximation of how full the table is.
+     *
+     * @return The number of used entries per thousand, as expected by the UCI "hashfull" info.
+     */
+    [[nodiscard]] int hashfull() const;
+
+    /**
+     * @brief Pack the source and target squares and the promoted piece of a move into 16 bits.
+     *
+     * This is the lower half of the packed move (see Move::getShortData), 0 for the null move.
+     *
+     * @param move The move to pack.
+     * @return The packed move.
+     */
+    [[nodiscard]] static uint16_t packMove(const Move& move);
+
+private:
+    static constexpr size_t s_bucketSize      = 4;  //< Number of entries in a bucket
+    static constexpr uint8_t s_generationMask = 63; //< Generations are stored in 6 bits
+    static constexpr uint32_t s_fileVersion   = 1;  //< Version of the file format, to change with the packing of the entries
+
+    /**
+     * @brief An entry as stored in the table.
+     *
+     * The data word holds the score (32 bits), the move (16 bits), the depth (8 bits),
+     * the bound (2 bits) and the generation (6 bits).
+     */
+    struct PackedEntry
+    {
+        std::atomic<uint64_t> keyXorData; //< Zobrist hash XOR-ed with the data
+        std::atomic<uint64_t> data;       //< Packed entry data
+    };
+
+    /**
+     * @brief A group of entries sharing the same index.
+     */
+    struct alignas(64) Bucket
+    {
+        std::array<PackedEntry, s_bucketSize> entries;
+    };
+
+    /**
+     * @brief Release the memory of the buckets, allocated with large_pages::allocate or mapped from a file.
+     */
+    struct BucketsDeleter
+    {
+        void* mapping;                  //< Start of the file mapping (nullptr if the buckets were allocated)
+        size_t size;                    //< Size of the allocation or of the file mapping, in bytes
+        large_pages::PageKind pageKind; //< Kind of pages of the allocation
+
+        void operator()(Bucket* buckets) const;
+    };
+
+    /**
+     * @brief Run a function on slices of the buckets, each one in its own thread (see setNumberOfThreads).
+     *
+     * The slices are made of whole huge pages, so that each page is written to by a single thread.
+     *
+     * @param function The function, called with the index of the first bucket of a slice and the index after its last one.
+     */
+    void forEachSlice(const std::function<void(size_t, size_t)>& function);
+
+    /**
+     * @brief Pack the data of an entry in a 64-bit word.
+     *
+     * @param entry The entry to pack (the key is ignored).
+     * @return The packed data.
+     */
+    [[nodiscard]] static uint64_t packData(const TTEntry& entry);
+
+    /**
+     * @brief Unpack the data of an entry.
+     *
+     * @param key The Zobrist hash of the entry.
+     * @param data The packed data.
+     * @return The unpacked entry.
+     */
+    [[nodiscard]] static TTEntry unpackData(uint64_t key, uint64_t data);
+
+    std::unique_ptr<Bucket[], BucketsDeleter> m_buckets; //< The buckets of the table
+    size_t m_numberOfBuckets;                            //< Number of buckets of the table (a power of two)
+    size_t m_mask;                                       //< Mask to get the bucket index from a key (number of buckets - 1)
+    uint8_t m_generation;                                //< Current search generation
+    int m_numberOfThreads;                               //< Number of threads initializing and clearing the table
+};
+} // namespace chess_engine
@@ -1,6 +1,10 @@
 #pragma once
 
+#include <cstdint>
+#include <string>
+
 #include "board.h"
+#include "thread_pool.h"
 
 namespace chess_engine
 {
@@ -12,7 +16,9 @@ public:
      *
      * This function continuously listens for UCI commands and processes them
      * accordingly. It handles commands such as "uci", "isready",
-     * "position", "go", and "quit".
+     * "position", "setoption", "go", "stop", "ponderhit" and "quit", and the non-standard
+     * "bench [depth] [threads] [hash]" (see benchmark.h) and "stats" (see search_stats.h). Unknown commands are ignored.
+     * The search runs in the background, so that "stop", "ponderhit" and "isready" are handled while searching.
      *
      * @param board The board to interact with.
      * @see https://official-stockfish.github.io/docs/stockfish-wiki/UCI-&-Commands.html
@@ -23,12 +29,14 @@ private:
     /**
      * @brief Parse the "position" command to set up the board state.
      *
+     * When the command only adds moves to the previous one (GUIs send the whole game before each move),
+     * only the new moves are applied. The moves after an illegal one are ignored.
+     *
      * @param command The full "position" command string.
      * param board The board to set up.
      */
     static void parsePosition(std::string_view command, Board& board);
 
-    // FIXME: Is return type bool needed?
     /**
      * @brief Parse a move in UCI format and apply it to the board.
      *
@@ -39,11 +47,46 @@ private:
     static bool parseMove(std::string_view moveAsString, Board& board);
 
     /**
-     * @brief Parse the "go" command to start the engine's move calculation.
+     * @brief Parse the "setoption" command to change an option of the engine.
+     *
+     * Supported options:
+     * - Hash: size of the transposition table in MB.
+     * - Threads: number of search threads.
+     * - EvalFile: path of the NNUE network to evaluate the positions with (see nnue.h), "<empty>" for the hand-crafted evaluation.
+     * - HashFile: path of a saved transposition table, loaded now and by each "ucinewgame" (see TranspositionTable::load).
+     * - SaveHash: save the transposition table to the HashFile.
+     * - SyzygyPath: directories of the Syzygy endgame tablebases (see syzygy.h), "<empty>" to not use them.
+     *
+     * @param command The full "setoption" command string.
+     */
+    static void parseSetOption(std::string_view command);
+
+    /**
+     * @brief Parse the "go" command and start the engine's move calculation in the background.
+     *
+     * Supported limits: wtime, btime, winc, binc, movestogo, movetime, nodes, depth, infinite and ponder.
+     * Without any limit, the search is limited to a default depth.
      *
      * @param command The full "go" command string.
      * param board The board to analyze.
      */
-    static void parseGo(std::string_view command, Board& board);
+    static void parseGo(std::string_view command, const Board& board);
+
+    /**
+     * @brief Print the size, the kind of pages and the NUMA placement of the large tables, as "info string" lines.
+     *
+     * Printed at startup, and when the Hash or Threads options change.
+     */
+    static void printMemoryPlacement();
+
+    /**
+     * @brief Stop the background search, if any, and wait for it to print its best move.
+     */
+    static void stopSearch();
+
+    static inline ThreadPool s_threadPool;           //< Search threads and their shared transposition table
+    static inline std::string s_lastPositionCommand; //< Last "position" command, empty if the next one must be parsed from scratch
+    static inline uint64_t s_lastPositionHash = 0;   //< Zobrist hash of the board after the last "position" command
+    static inline std::string s_hashFile;            //< Transposition table file (HashFile option), empty if none
 };
 } // namespace chess_engine
\ No newline at end of file
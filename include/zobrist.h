@@ -77,5 +77,15 @@ extern const std::array<uint64_t, 8> EN_PASSANT_KEYS;
     return EN_PASSANT_KEYS[file & 0x7]; // Mask to 3 bits
 }
 
+/**
+ * @brief Get a signature of all the Zobrist keys.
+ *
+ * The keys depend on the random number distribution of the standard library the engine was built with,
+ * so hashes saved by another build (e.g. a transposition table file) are only valid if the signatures match.
+ *
+ * @return The signature of the keys.
+ */
+[[nodiscard]] uint64_t getKeysSignature();
+
 } // namespace chess_engine::zobrist
 
@@ -0,0 +1,361 @@
+#include "analysis.h"
+
+#include <algorithm>
+#include <charconv>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <print>
+#include <ranges>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include "board.h"
+#include "thread_pool.h"
+
+namespace chess_engine::analysis
+{
+namespace
+{
+/**
+ * @brief Result of the search of a position.
+ */
+struct AnalysisResult
+{
+    Move bestMove;                        //< Best move (null if there is no legal move)
+    int score = 0;                        //< Score in centipawns, from the point of view of the side to move
+    std::vector<Move> principalVariation; //< Principal variation
+    uint64_t nodes = 0;                   //< Nodes searched
+};
+
+/**
+ * @brief Check if a string is a non-negative integer.
+ */
+bool isNumber(const std::string_view string)
+{
+    return !string.empty() && std::ranges::all_of(string, [](const char c) { return c >= '0' && c <= '9'; });
+}
+
+/**
+ * @brief Check the first 4 fields of a FEN or EPD line, which the board parses without any validation.
+ *
+ * The placement must have 8 ranks of 8 squares, exactly one king per side and no pawn on the first or last rank, and
+ * the side to move, the castling rights and the en passant square must be well-formed.
+ */
+bool isValidPosition(const std::span<const std::string_view> fields)
+{
+    constexpr std::string_view pieces = "PNBRQKpnbrqk";
+
+    int ranks = 0, whiteKings = 0, blackKings = 0;
+    for (const auto rankRange: std::views::split(fields[0], '/'))
+    {
+        const std::string_view rank(rankRange.begin(), rankRange.end());
+        int squares = 0;
+        for (const char c: rank)
+        {
+            if (c >= '1' && c <= '8')
+            {
+                squares += c - '0';
+                continue;
+            }
+            if (!pieces.contains(c) || ((c == 'P' || c == 'p') && (ranks == 0 || ranks == 7)))
+            {
+                return false;
+            }
+            whiteKings += c == 'K' ? 1 : 0;
+            blackKings += c == 'k' ? 1 : 0;
+            squares++;
+        }
+        if (squares != 8 || ++ranks > 8)
+        {
+            return false;
+        }
+    }
+    if (ranks != 8 || whiteKings != 1 || blackKings != 1)
+    {
+        return false;
+    }
+
+    if (fields[1] != "w" && fields[1] != "b")
+    {
+        return false;
+    }
+
+    // Each castling right at most once
+    const auto isCastlingRight = [&fields](const char c) { return std::string_view("KQkq").contains(c) && std::ranges::count(fields[2], c) == 1; };
+    if (fields[2] != "-" && !std::ranges::all_of(fields[2], isCastlingRight))
+    {
+        return false;
+    }
+
+    // The en passant square is behind a pawn that just moved two squares, on the 6th rank of the side to move
+    const char enPassantRank = fields[1] == "w" ? '6' : '3';
+    return fields[3] == "-" || (fields[3].size() == 2 && fields[3][0] >= 'a' && fields[3][0] <= 'h' && fields[3][1] == enPassantRank);
+}
+
+/**
+ * @brief Escape a string for a JSON string literal.
+ */
+std::string escapeJSON(const std::string_view string)
+{
+    std::string result;
+    for (const char c: string)
+    {
+        if (c == '"' || c == '\\')
+        {
+            result += '\\';
+        }
+        result += c;
+    }
+    return result;
+}
+
+/**
+ * @brief Escape a string for a CSV field (quoted if needed, with the quotes doubled).
+ */
+std::string escapeCSV(const std::string_view string)
+{
+    if (string.find_first_of(",\"") == std::string_view::npos)
+    {
+        return std::string(string);
+    }
+
+    std::string result = "\"";
+    for (const char c: string)
+    {
+        result += c;
+        if (c == '"')
+        {
+            result += '"';
+        }
+    }
+    return result + '"';
+}
+
+/**
+ * @brief Format the result of a position in the output format.
+ */
+std::string formatResult(const size_t index, const AnalysisPosition& position, const AnalysisResult& result, const OutputFormat format)
+{
+    const std::string bestMove = result.bestMove.isNull() ? "0000" : result.bestMove.toString();
+    std::string pv;
+    for (const Move& move: result.principalVariation)
+    {
+        pv += (pv.empty() ? "" : " ") + move.toString();
+    }
+
+    if (format == OutputFormat::CSV)
+    {
+        return std::format("{},{},{},{},{},{},{}\n", index, escapeCSV(position.fen), escapeCSV(position.id), bestMove, result.score, pv, result.nodes);
+    }
+    return std::format(R"({{"index":{},"fen":"{}","id":"{}","bestmove":"{}","score":{},"pv":"{}","nodes":{}}})" "\n",
+                       index, escapeJSON(position.fen), escapeJSON(position.id), bestMove, result.score, pv, result.nodes);
+}
+} // namespace
+
+std::optional<AnalysisOptions> parseArguments(const int argc, const char* const argv[])
+{
+    AnalysisOptions options;
+    for (int i = 0; i < argc; i++)
+    {
+        const std::string_view argument = argv[i];
+        if (i + 1 >= argc)
+        {
+            return std::nullopt; // All the options have a value
+        }
+        const std::string_view value = argv[++i];
+
+        if (argument == "--input")
+        {
+            options.inputPath = value;
+        }
+        else if (argument == "--output")
+        {
+            options.outputPath = value;
+        }
+        else if (argument == "--format" && (value == "jsonl" || value == "csv"))
+        {
+            options.outputFormat = value == "csv" ? OutputFormat::CSV : OutputFormat::JSONL;
+        }
+        else if ((argument == "--depth" || argument == "--threads" || argument == "--hash") && isNumber(value))
+        {
+            int number = 0;
+            std::from_chars(value.data(), value.data() + value.size(), number);
+            if (number <= 0)
+            {
+                return std::nullopt;
+            }
+
+            if (argument == "--depth")
+                options.depth = std::min(number, Search::maxPly - 1);
+            else if (argument == "--threads")
+                options.numberOfThreads = number;
+            else
+                options.hashSizeMB = static_cast<size_t>(number);
+        }
+        else
+        {
+            return std::nullopt;
+        }
+    }
+    return options;
+}
+
+std::optional<AnalysisPosition> parseLine(const std::string_view line)
+{
+    // FEN: 6 fields, EPD: 4 fields followed by the operations ("opcode operand;")
+    std::vector<std::string_view> fields;
+    size_t index = 0;
+    while (fields.size() < 6)
+    {
+        index = line.find_first_not_of(" \t\r", index);
+        if (index == std::string_view::npos)
+        {
+            break;
+        }
+        const size_t end = std::min(line.find_first_of(" \t\r", index), line.size());
+        fields.push_back(line.substr(index, end - index));
+        index = end;
+    }
+
+    if (fields.size() < 4 || fields[0].starts_with('#'))
+    {
+        return std::nullopt;
+    }
+    if (!isValidPosition(fields))
+    {
+        std::println(stderr, "Skipping the invalid position: {}", line);
+        return std::nullopt;
+    }
+
+    AnalysisPosition position;
+    position.fen = std::format("{} {} {} {}", fields[0], fields[1], fields[2], fields[3]);
+    if (fields.size() == 6 && isNumber(fields[4]) && isNumber(fields[5]))
+    {
+        position.fen += std::format(" {} {}", fields[4], fields[5]);
+        return position;
+    }
+    position.fen += " 0 1";
+
+    // The "id" operation names the position (e.g. id "BK.01";)
+    const size_t idIndex = line.find("id \"");
+    if (idIndex != std::string_view::npos)
+    {
+        const size_t idStart = idIndex + 4;
+        const size_t idEnd   = line.find('"', idStart);
+        position.id          = line.substr(idStart, idEnd == std::string_view::npos ? std::string_view::npos : idEnd - idStart);
+    }
+    return position;
+}
+
+size_t analyze(std::istream& input, std::ostream& output, const AnalysisOptions& options)
+{
+    if (options.outputFormat == OutputFormat::CSV)
+    {
+        output << "index,fen,id,bestmove,score,pv,nodes\n";
+    }
+
+    std::mutex inputMutex;  // Protects the input stream and the index of the next position
+    std::mutex outputMutex; // Protects the output stream and the pending results
+    size_t nextIndex = 0, nextIndexToWrite = 0;
+    std::map<size_t, std::string> pendingResults; // Results finished before those of the previous positions
+
+    const auto worker = [&]()
+    {
+        // Each searcher has its own transposition table and search data, and never prints anything
+        ThreadPool threadPool;
+        threadPool.setSilent(true);
+        threadPool.getTranspositionTable().resize(options.hashSizeMB);
+
+        SearchLimits limits;
+        limits.depth = options.depth;
+
+        while (true)
+        {
+            size_t index;
+            AnalysisPosition position;
+            {
+                std::lock_guard lock(inputMutex);
+                std::string line;
+                std::optional<AnalysisPosition> parsedPosition;
+                while (!parsedPosition && std::getline(input, line))
+                {
+                    parsedPosition = parseLine(line);
+                }
+                if (!parsedPosition)
+                {
+                    return; // End of the input
+                }
+                position = std::move(*parsedPosition);
+                index    = nextIndex++;
+            }
+
+            Board board;
+            board.parseFENString(position.fen);
+
+            // The positions are independent: the result must not depend on the previous ones
+            threadPool.getTranspositionTable().clear();
+
+            AnalysisResult result;
+            result.score              = threadPool.search(board, limits);
+            result.bestMove           = threadPool.getBestMove();
+            result.principalVariation = threadPool.getPrincipalVariation();
+            result.nodes              = threadPool.getTotalNodes();
+
+            // Write the results in the order of the input, as soon as all the previous ones are written
+            std::lock_guard lock(outputMutex);
+            pendingResults.emplace(index, formatResult(index, position, result, options.outputFormat));
+            for (auto it = pendingResults.begin(); it != pendingResults.end() && it->first == nextIndexToWrite; it = pendingResults.erase(it))
+            {
+                output << it->second;
+                nextIndexToWrite++;
+            }
+            output.flush();
+        }
+    };
+
+    {
+        std::vector<std::jthread> workers;
+        for (int i = 0; i < options.numberOfThreads; i++)
+        {
+            workers.emplace_back(worker);
+        }
+    } // Join the workers
+
+    return nextIndex;
+}
+
+int run(const AnalysisOptions& options)
+{
+    std::ifstream inputFile;
+    if (!options.inputPath.empty())
+    {
+        inputFile.open(options.inputPath);
+        if (!inputFile)
+        {
+            std::println(stderr, "Could not open the input file {}", options.inputPath);
+            return 1;
+        }
+    }
+
+    std::ofstream outputFile;
+    if (!options.outputPath.empty())
+    {
+        outputFile.open(options.outputPath);
+        if (!outputFile)
+        {
+            std::println(stderr, "Could not open the output file {}", options.outputPath);
+            return 1;
+        }
+    }
+
+    std::istream& input  = options.inputPath.empty() ? std::cin : inputFile;
+    std::ostream& output = options.outputPath.empty() ? std::cout : outputFile;
+    const size_t count   = analyze(input, output, options);
+    std::println(stderr, "Analyzed {} positions", count);
+    return 0;
+}
+} // namespace chess_engine::analysis
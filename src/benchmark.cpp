@@ -0,0 +1,146 @@
+#include "benchmark.h"
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <print>
+#include <sstream>
+#include <string>
+
+#include "board.h"
+#include "thread_pool.h"
+
+namespace chess_engine::benchmark
+{
+// Adapted from the benchmark positions of Stockfish
+const std::array<std::string_view, 50> POSITIONS = {
+        // Openings
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+        "rnbqkbnr/pp1ppppp/8/2p5/4P3/8/PPPP1PPP/RNBQKBNR w KQkq c6 0 2",
+        "r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - 2 3",
+        "rnbqkb1r/ppp2ppp/4pn2/3p4/2PP4/2N5/PP2PPPP/R1BQKBNR w KQkq - 2 4",
+        "rnbqk2r/ppp1ppbp/3p1np1/8/2PPP3/2N5/PP3PPP/R1BQKBNR w KQkq - 0 5",
+        "r1bqk1nr/pppp1ppp/2n5/2b1p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 4 4",
+        "rnbqkb1r/pp3ppp/4pn2/2pp4/3P1B2/4PN2/PPP2PPP/RN1QKB1R w KQkq c6 0 5",
+        "r1bqkb1r/pp1ppppp/2n2n2/8/3NP3/8/PPP2PPP/RNBQKB1R w KQkq - 2 5",
+        // Middle games
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 10",
+        "4rrk1/pp1n3p/3q2pQ/2p1pb2/2PP4/2P3N1/P2B2PP/4RRK1 b - - 7 19",
+        "rq3rk1/ppp2ppp/1bnpb3/3N2B1/3NP3/7P/PPPQ1PP1/2KR3R w - - 7 14",
+        "r1bq1r1k/1pp1n1pp/1p1p4/4p2Q/4Pp2/1BNP4/PPP2PPP/3R1RK1 w - - 2 14",
+        "r3r1k1/2p2ppp/p1p1bn2/8/1q2P3/2NPQN2/PPP3PP/R4RK1 b - - 2 15",
+        "r1bbk1nr/pp3p1p/2n5/1N4p1/2Np1B2/8/PPP2PPP/2KR1B1R w kq - 0 13",
+        "r1bq1rk1/ppp1nppp/4n3/3p3Q/3P4/1BP1B3/PP1N2PP/R4RK1 w - - 1 16",
+        "4r1k1/r1q2ppp/ppp2n2/4P3/5Rb1/1N1BQ3/PPP3PP/R5K1 w - - 1 17",
+        "2rqkb1r/ppp2p2/2npb1p1/1N1Nn2p/2P1PP2/8/PP2B1PP/R1BQK2R b KQ - 0 11",
+        "r1bq1r1k/b1p1npp1/p2p3p/1p6/3PP3/1B2NN2/PP3PPP/R2Q1RK1 w - - 1 16",
+        "3r1rk1/p5pp/bpp1pp2/8/q1PP1P2/b3P3/P2NQRPP/1R2B1K1 b - - 6 22",
+        "r1q2rk1/2p1bppp/2Pp4/p6b/Q1PNp3/4B3/PP1R1PPP/2K4R w - - 2 18",
+        "4k2r/1pb2ppp/1p2p3/1R1p4/3P4/2r1PN2/P4PPP/1R4K1 b - - 3 22",
+        "3q2k1/pb3p1p/4pbp1/2r5/PpN2N2/1P2P2P/5PP1/Q2R2K1 b - - 4 26",
+        "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+        "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+        "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+        "6k1/3b3r/1p1p4/p1n2p2/1PPNpP1q/P3Q1p1/1R1RB1P1/5K2 b - - 0 1",
+        "r2r1n2/pp2bk2/2p1p2p/3q4/3PN1QP/2P3R1/P4PP1/5RK1 w - - 0 1",
+        "2r2rk1/1bqnbpp1/1p1ppn1p/pP6/N1P1P3/P2B1N1P/1B2QPP1/R2R2K1 b - - 0 1",
+        "r1b2rk1/2q1b1pp/p2ppn2/1p6/3QP3/1BN1B3/PPP3PP/R4RK1 w - - 0 1",
+        "3rr1k1/pp3pp1/1qn2np1/8/3p4/PP1R1P2/2P1NQPP/R1B3K1 b - - 0 1",
+        // End games
+        "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 11",
+        "6k1/6p1/6Pp/ppp5/3pn2P/1P3K2/1PP2P2/8 b - - 0 1",
+        "8/8/8/8/5kp1/P7/8/1K1N4 w - - 0 1",
+        "8/8/8/5N2/8/p7/8/2NK3k w - - 0 1",
+        "8/3k4/8/8/8/4B3/4KB2/2B5 w - - 0 1",
+        "8/8/1P6/5pr1/8/4R3/7k/2K5 w - - 0 1",
+        "8/2p4P/8/kr6/6R1/8/8/1K6 w - - 0 1",
+        "8/8/3P3k/8/1p6/8/1P6/1K3n2 b - - 0 1",
+        "8/R7/2q5/8/6k1/8/1P5p/K6R w - - 0 124",
+        "8/8/8/8/4k3/8/4P3/4K3 w - - 0 1",
+        "8/8/4k3/8/8/8/4P3/4K3 w - - 0 1",
+        "8/5pk1/6p1/8/8/6P1/5PK1/8 w - - 0 1",
+        "4k3/8/8/8/8/8/8/R3K3 w Q - 0 1",
+        "8/8/8/3k4/8/8/8/2QK4 w - - 0 1",
+        "8/8/2k5/8/8/8/1r6/4K2R w K - 0 1",
+        "2k5/8/8/8/8/8/3q4/R3K3 w Q - 0 1",
+        "8/8/8/8/8/6k1/6p1/6K1 w - - 0 1",    // Stalemate
+        "7k/7P/6K1/8/3B4/8/8/8 b - - 0 1",    // Mated
+        "3R2k1/5ppp/8/8/8/8/8/6K1 b - - 0 1", // Mated (back rank)
+        "6rk/5Npp/8/8/8/8/8/6K1 b - - 0 1",   // Mated (smothered)
+};
+
+BenchmarkResult run(const int depth, const int numberOfThreads, const size_t hashSizeMB)
+{
+    ThreadPool threadPool;
+    threadPool.setNumberOfThreads(numberOfThreads);
+    threadPool.getTranspositionTable().resize(hashSizeMB);
+
+    SearchLimits limits;
+    limits.depth = depth;
+
+    BenchmarkResult result;
+    for (size_t i = 0; i < POSITIONS.size(); i++)
+    {
+        std::println("\nPosition: {}/{} ({})", i + 1, POSITIONS.size(), POSITIONS[i]);
+
+        Board board;
+        board.parseFENString(POSITIONS[i]);
+
+        // Each position is searched from scratch, so that the node count does not depend on the previous ones
+        threadPool.getTranspositionTable().clear();
+
+        const auto start = std::chrono::steady_clock::now();
+        threadPool.search(board, limits);
+        result.timeMs += std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+        result.nodes += threadPool.getTotalNodes();
+    }
+
+    std::println("\n===========================");
+    std::println("Total time (ms) : {}", result.timeMs);
+    std::println("Nodes searched  : {}", result.nodes);
+    std::println("Nodes/second    : {}", result.nodes * 1000 / static_cast<uint64_t>(std::max<int64_t>(result.timeMs, 1)));
+
+    return result;
+}
+
+BenchmarkResult run(const std::string_view command)
+{
+    // Command is of the form:
+    // bench [depth] [threads] [hash]
+
+    int depth           = DEFAULT_DEPTH;
+    int numberOfThreads = DEFAULT_THREADS;
+    size_t hashSizeMB   = DEFAULT_HASH_SIZE;
+
+    // Parse a parameter, keeping its default value if it is not a number
+    const auto parse = [](const std::string& token, auto& parameter)
+    {
+        auto value              = parameter;
+        const auto [end, error] = std::from_chars(token.data(), token.data() + token.size(), value);
+        if (error != std::errc() || end != token.data() + token.size())
+        {
+            std::println("Invalid parameter {}, usage: bench [depth] [threads] [hash]", token);
+            return;
+        }
+        parameter = value;
+    };
+
+    std::istringstream stream{std::string(command)};
+    std::string token;
+    stream >> token; // Skip "bench"
+    if (stream >> token)
+    {
+        parse(token, depth);
+    }
+    if (stream >> token)
+    {
+        parse(token, numberOfThreads);
+    }
+    if (stream >> token)
+    {
+        parse(token, hashSizeMB);
+    }
+
+    return run(std::max(depth, 1), std::clamp(numberOfThreads, 1, ThreadPool::s_maxThreads), std::max<size_t>(hashSizeMB, 1));
+}
+} // namespace chess_engine::benchmark
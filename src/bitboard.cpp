@@ -27,9 +27,4 @@ void Bitboard::print() const
     // Print the current bitboard value (useful for debugging)
     debug::debug_log("Current bitboard: {}\n", m_bitboard);
 }
-
-uint64_t Bitboard::getBitboard() const
-{
-    return m_bitboard;
-}
 } // namespace chess_engine
\ No newline at end of file
@@ -1,11 +1,36 @@
 #include "board.h"
 
+#include <algorithm>
+#include <cassert>
+#include <cctype>
+#include <cstddef>
+#include <cstdlib>
+
 #include "evaluate.h"
+#include "nnue.h"
 #include "pregenerated_moves.h"
 #include "zobrist.h"
 
 namespace chess_engine
 {
+/**
+ * @brief Castling rights kept when a piece moves from or to each square.
+ *
+ * Moving the king, or moving or capturing a rook on its original square, loses the corresponding rights.
+ */
+constexpr std::array<CastlingRights, board_dimensions::N_SQUARES> castlingRightsMasks = []()
+{
+    std::array<CastlingRights, board_dimensions::N_SQUARES> masks{};
+    masks.fill(static_cast<CastlingRights>(0xF));
+    masks[std::to_underlying(Square::a8)] = static_cast<CastlingRights>(0xF & ~std::to_underlying(CastlingRights::BlackLong));
+    masks[std::to_underlying(Square::h8)] = static_cast<CastlingRights>(0xF & ~std::to_underlying(CastlingRights::BlackShort));
+    masks[std::to_underlying(Square::e8)] = static_cast<CastlingRights>(0xF & ~(std::to_underlying(CastlingRights::BlackShort) | std::to_underlying(CastlingRights::BlackLong)));
+    masks[std::to_underlying(Square::a1)] = static_cast<CastlingRights>(0xF & ~std::to_underlying(CastlingRights::WhiteLong));
+    masks[std::to_underlying(Square::h1)] = static_cast<CastlingRights>(0xF & ~std::to_underlying(CastlingRights::WhiteShort));
+    masks[std::to_underlying(Square::e1)] = static_cast<CastlingRights>(0xF & ~(std::to_underlying(CastlingRights::WhiteShort) | std::to_underlying(CastlingRights::WhiteLong)));
+    return masks;
+}();
+
 /**
  * @brief Helper function to compute Zobrist hash from scratch.
  * This is used when initializing or re-parsing the board state.
@@ -26,9 +51,8 @@ namespace chess_engine
 
         while (bitboard != empty)
         {
-            const Square square = bitboard.getSquareOfLeastSignificantBitIndex();
+            const Square square = bitboard.popLsb();
             hash ^= zobrist::getPieceKey(static_cast<PieceWithColor>(piece), square);
-            bitboard.clearBit(square);
         }
     }
 
@@ -49,15 +73,27 @@ namespace chess_engine
 }
 
 Board::Board()
-    : m_sideToMove(White),
+    : m_zobristHash(0),
+      m_sideToMove(White),
       m_castlingRights(CastlingRights::None),
       m_enPassantSquare(Square::INVALID),
       m_halfMoveClock(0),
+      m_pliesFromNull(0),
+      m_gamePhase(0),
+      m_pawnKey(0),
+      m_stateIndex(0),
       m_fullMoveNumber(0),
-      m_zobristHash(0)
+      m_accumulator(),
+      m_stateHistory()
 {
+    // Keep the hot state in its cache lines when adding members (see the declaration order)
+    static_assert(offsetof(Board, m_zobristHash) + sizeof(m_zobristHash) <= 128, "The bitboards and the hash fit in two cache lines");
+    static_assert(offsetof(Board, m_fullMoveNumber) + sizeof(m_fullMoveNumber) <= 192, "The scalar state fits in one cache line");
+    static_assert(offsetof(Board, m_mailbox) == 192 && sizeof(m_mailbox) == 64, "The mailbox fills one cache line");
+
     std::fill(m_bitboardsPieces.begin(), m_bitboardsPieces.end(), 0);
     std::fill(m_occupancies.begin(), m_occupancies.end(), 0);
+    m_mailbox.fill(InvalidPiece);
 }
 
 void Board::print() const
@@ -70,18 +106,11 @@ void Board::print() const
         {
             const auto square = static_cast<Square>(rank * board_dimensions::N_FILES + file);
 
-            bool isSquareOccupied = false;
-            for (const PieceWithColor piece: PieceWithColor())
+            if (const PieceWithColor piece = m_mailbox[std::to_underlying(square)]; piece != InvalidPiece)
             {
-                if (m_bitboardsPieces[std::to_underlying(piece)].getBit(square) == 1)
-                {
-                    debug::debug_log(" {}", pieceToFENCharacter(piece));
-                    isSquareOccupied = true;
-                    break;
-                }
+                debug::debug_log(" {}", pieceToFENCharacter(piece));
             }
-
-            if (!isSquareOccupied)
+            else
             {
                 debug::debug_log(" .");
             }
@@ -152,11 +181,14 @@ void Board::parseFENString(const std::string_view fenString)
     // Reset the board state
     std::fill(m_bitboardsPieces.begin(), m_bitboardsPieces.end(), 0);
     std::fill(m_occupancies.begin(), m_occupancies.end(), 0);
+    m_mailbox.fill(InvalidPiece);
     m_sideToMove      = White;
     m_castlingRights  = CastlingRights::None;
     m_enPassantSquare = Square::INVALID;
     m_halfMoveClock   = 0;
+    m_pliesFromNull   = 0;
     m_fullMoveNumber  = 0;
+    m_stateIndex      = 0;
 
     // Index to track the current position in the FEN string
     size_t index = 0;
@@ -183,6 +215,7 @@ void Board::parseFENString(const std::string_view fenString)
         {
             const PieceWithColor piece = FENCharacterToPieceWithColor(fenString[index++]);
             m_bitboardsPieces[std::to_underlying(piece)].setBit(square);
+            m_mailbox[std::to_underlying(square)] = piece;
         }
     }
 
@@ -251,9 +284,34 @@ void Board::parseFENString(const std::string_view fenString)
 
     // Compute Zobrist hash from the parsed board state
     m_zobristHash = computeZobristHash(m_bitboardsPieces, m_sideToMove, m_castlingRights, m_enPassantSquare);
+
+    // Compute the piece-square tables score, the game phase and the pawn key, then updated incrementally by putPiece and removePiece
+    m_pieceSquareScore = {};
+    m_gamePhase        = 0;
+    m_pawnKey          = 0;
+    for (const PieceWithColor piece: PieceWithColor())
+    {
+        Bitboard bitboard = m_bitboardsPieces[std::to_underlying(piece)];
+        while (bitboard != Bitboard())
+        {
+            const Square square = bitboard.popLsb();
+            m_pieceSquareScore += Evaluate::s_pieceSquareScores[std::to_underlying(piece)][std::to_underlying(square)];
+            m_gamePhase += Evaluate::s_gamePhaseWeights[std::to_underlying(piece)];
+            if (piece == WhitePawn || piece == BlackPawn)
+            {
+                m_pawnKey ^= zobrist::getPieceKey(piece, square);
+            }
+        }
+    }
+    refreshAccumulators();
 }
 
 bool Board::isSquareAttacked(const Square square, const Side side) const
+{
+    return isSquareAttacked(square, side, m_occupancies[std::to_underlying(WhiteAndBlack)]);
+}
+
+bool Board::isSquareAttacked(const Square square, const Side side, const Bitboard occupancy) const
 {
     PieceWithColor piece;
     constexpr Bitboard empty;
@@ -276,15 +334,15 @@ bool Board::isSquareAttacked(const Square square, const Side side) const
         return true;
 
     piece = side == White ? WhiteBishop : BlackBishop;
-    if ((pregenerated_moves::getBishopAttacks(square, m_occupancies[std::to_underlying(WhiteAndBlack)]) & m_bitboardsPieces[std::to_underlying(piece)]) != empty)
+    if ((pregenerated_moves::getBishopAttacks(square, occupancy) & m_bitboardsPieces[std::to_underlying(piece)]) != empty)
         return true;
 
     piece = side == White ? WhiteRook : BlackRook;
-    if ((pregenerated_moves::getRookAttacks(square, m_occupancies[std::to_underlying(WhiteAndBlack)]) & m_bitboardsPieces[std::to_underlying(piece)]) != empty)
+    if ((pregenerated_moves::getRookAttacks(square, occupancy) & m_bitboardsPieces[std::to_underlying(piece)]) != empty)
         return true;
 
     piece = side == White ? WhiteQueen : BlackQueen;
-    if ((pregenerated_moves::getQueenAttacks(square, m_occupancies[std::to_underlying(WhiteAndBlack)]) & m_bitboardsPieces[std::to_underlying(piece)]) != empty)
+    if ((pregenerated_moves::getQueenAttacks(square, occupancy) & m_bitboardsPieces[std::to_underlying(piece)]) != empty)
         return true;
 
     piece = side == White ? WhiteKing : BlackKing;
@@ -294,6 +352,95 @@ bool Board::isSquareAttacked(const Square square, const Side side) const
     return false;
 }
 
+Bitboard Board::getAttackersTo(const Square square, const Bitboard occupancy) const
+{
+    const auto pieces = [this](const PieceWithColor white, const PieceWithColor black)
+    {
+        return m_bitboardsPieces[std::to_underlying(white)] | m_bitboardsPieces[std::to_underlying(black)];
+    };
+    const int index = std::to_underlying(square);
+
+    return (pregenerated_moves::blackPawnsAttacks[index] & m_bitboardsPieces[std::to_underlying(WhitePawn)]) |
+           (pregenerated_moves::whitePawnsAttacks[index] & m_bitboardsPieces[std::to_underlying(BlackPawn)]) |
+           (pregenerated_moves::knightAttacks[index] & pieces(WhiteKnight, BlackKnight)) |
+           (pregenerated_moves::getBishopAttacks(square, occupancy) & (pieces(WhiteBishop, BlackBishop) | pieces(WhiteQueen, BlackQueen))) |
+           (pregenerated_moves::getRookAttacks(square, occupancy) & (pieces(WhiteRook, BlackRook) | pieces(WhiteQueen, BlackQueen))) |
+           (pregenerated_moves::kingAttacks[index] & pieces(WhiteKing, BlackKing));
+}
+
+int Board::getStaticExchangeEvaluation(const Move& move) const
+{
+    // Value of a piece of any color
+    const auto value = [](const PieceWithColor piece)
+    {
+        return Evaluate::s_piecesValues[std::to_underlying(piece) % 6];
+    };
+
+    const Square target = move.getTarget();
+    Bitboard occupancy  = m_occupancies[std::to_underlying(WhiteAndBlack)];
+    occupancy.clearBit(move.getSource());
+
+    // gains[i] is the material won by the side making the i-th capture, if the exchange stopped right after it
+    std::array<int, 32> gains = {};
+    int depth                 = 0;
+    PieceWithColor onTarget   = move.getPiece();
+
+    if (move.isCapture())
+    {
+        gains[0] = Evaluate::s_piecesValues[std::to_underlying(move.getCapturedPiece())];
+    }
+    if (move.isEnPassant())
+    {
+        // The captured pawn is not on the target square, it can uncover a slider
+        occupancy.clearBit(m_sideToMove == White ? target + 8 : target - 8);
+    }
+    if (move.isPromotion())
+    {
+        gains[0] += value(move.getPromotedPiece()) - value(WhitePawn);
+        onTarget = move.getPromotedPiece();
+    }
+
+    Side side = m_sideToMove == White ? Black : White;
+    while (depth + 1 < static_cast<int>(gains.size()))
+    {
+        // The pieces that left the square are no longer in the occupancy, uncovering the sliders behind them
+        const Bitboard attackers = getAttackersTo(target, occupancy) & occupancy & m_occupancies[std::to_underlying(side)];
+        if (attackers == Bitboard())
+        {
+            break;
+        }
+
+        // Recapture with the least valuable piece
+        const PieceWithColor first = side == White ? WhitePawn : BlackPawn;
+        PieceWithColor attacker    = first;
+        while ((attackers & m_bitboardsPieces[std::to_underlying(attacker)]) == Bitboard())
+        {
+            ++attacker;
+        }
+
+        depth++;
+        gains[depth] = value(onTarget) - gains[depth - 1];
+
+        // Stop once neither side can win material by going on
+        if (std::max(-gains[depth - 1], gains[depth]) < 0)
+        {
+            break;
+        }
+
+        occupancy.clearBit((attackers & m_bitboardsPieces[std::to_underlying(attacker)]).getSquareOfLeastSignificantBitIndex());
+        onTarget = attacker;
+        side     = side == White ? Black : White;
+    }
+
+    // Each side can stop the exchange instead of capturing
+    for (; depth > 0; depth--)
+    {
+        gains[depth - 1] = -std::max(-gains[depth - 1], gains[depth]);
+    }
+
+    return gains[0];
+}
+
 void Board::printAttackedSquares(const Side side) const
 {
     for (int rank = 0; rank < board_dimensions::N_RANKS; rank++)
@@ -307,53 +454,268 @@ void Board::printAttackedSquares(const Side side) const
     }
 }
 
-std::vector<Move> Board::generateMoves()
+MoveList Board::generateMoves() const
+{
+    MoveList moves;
+    generateMoves(moves, MoveGenType::All);
+    return moves;
+}
+
+MoveList Board::generateCaptures() const
 {
-    std::vector<Move> moves;
-    PieceWithColor pawn, king;
+    MoveList moves;
+    generateMoves(moves, MoveGenType::Captures);
+    return moves;
+}
+
+MoveList Board::generateQuiets() const
+{
+    MoveList moves;
+    generateMoves(moves, MoveGenType::Quiets);
+    return moves;
+}
 
+MoveList Board::generateEvasions() const
+{
+    MoveList moves;
+    generateMoves(moves, MoveGenType::Evasions);
+    return moves;
+}
+
+void Board::generateMoves(MoveList& moves, const MoveGenType type) const
+{
     // Determine the side to move and set the pawn and king pieces accordingly
     // This allows us to generate moves for the correct side's pieces
-    if (m_sideToMove == White)
+    const PieceWithColor pawn = m_sideToMove == White ? WhitePawn : BlackPawn;
+    const PieceWithColor king = m_sideToMove == White ? WhiteKing : BlackKing;
+
+    const Bitboard occupancy         = m_occupancies[std::to_underlying(m_sideToMove)];
+    const Bitboard opponentOccupancy = m_occupancies[std::to_underlying(m_sideToMove == White ? Black : White)];
+    const Bitboard allOccupancy      = m_occupancies[std::to_underlying(WhiteAndBlack)];
+
+    // Get the squares the pieces can move to for the kind of moves to generate
+    Bitboard targets;
+    switch (type)
     {
-        pawn = WhitePawn;
-        king = WhiteKing;
+        case MoveGenType::All:
+        case MoveGenType::Evasions:
+            targets = ~occupancy.getBitboard();
+            break;
+        case MoveGenType::Captures:
+            targets = opponentOccupancy;
+            break;
+        case MoveGenType::Quiets:
+            targets = ~allOccupancy.getBitboard();
+            break;
     }
-    else
+
+    // Compute once the pieces giving check and the pinned pieces, so that only the legal moves are generated
+    const Bitboard checkers = getCheckers();
+    const Bitboard pinned   = getPinnedPieces();
+    assert(type != MoveGenType::Evasions || checkers != Bitboard());
+
+    // The king is the only piece that can move in double check
+    if (checkers.getNumberOfBitsSet() > 1)
     {
-        pawn = BlackPawn;
-        king = BlackKing;
+        generateKingMoves(king, moves, targets);
+        return;
     }
 
-    for (PieceWithColor piece = pawn; piece <= king; ++piece)
+    // In check, the other pieces must capture the checker, or block the check
+    Bitboard checkMask = ~uint64_t{0};
+    if (checkers != Bitboard())
+    {
+        const Square kingSquare    = m_bitboardsPieces[std::to_underlying(king)].getSquareOfLeastSignificantBitIndex();
+        const Square checkerSquare = checkers.getSquareOfLeastSignificantBitIndex();
+        checkMask                  = checkers | pregenerated_moves::betweenSquares[std::to_underlying(kingSquare)][std::to_underlying(checkerSquare)];
+    }
+
+    // Generate pawn moves separately
+    generatePawnMoves(pawn, moves, type, checkMask, pinned);
+
+    // Generate moves for all other pieces
+    for (PieceWithColor piece = pawn; ++piece < king;)
+    {
+        generatePieceMoves(piece, moves, targets & checkMask, pinned);
+    }
+    generateKingMoves(king, moves, targets);
+
+    // Generate castling moves for kings (not possible in check)
+    if (type != MoveGenType::Captures && checkers == Bitboard())
+    {
+        generateKingCastlingMoves(king, moves);
+    }
+}
+
+Move Board::unpackMove(const uint16_t packedMove) const
+{
+    const Move move = unpackPseudoLegalMove(packedMove);
+    return move.isNull() || isLegal(move) ? move : Move();
+}
+
+Move Board::parseUCIMove(const std::string_view moveAsString) const
+{
+    // Parse a square from its file and rank characters (e.g. "e4"), Square::INVALID if not valid
+    const auto parseSquare = [](const char file, const char rank)
     {
-        // Generate pawn moves separately
-        if (piece == WhitePawn || piece == BlackPawn)
+        if (file < 'a' || file > 'h' || rank < '1' || rank > '8')
         {
-            generatePawnMoves(piece, moves);
+            return Square::INVALID;
         }
+        return static_cast<Square>((board_dimensions::N_RANKS - (rank - '0')) * board_dimensions::N_FILES + (file - 'a'));
+    };
 
-        // Generate moves for all other pieces
-        else if (piece != WhitePawn && piece != BlackPawn)
+    if (moveAsString.size() != 4 && moveAsString.size() != 5)
+    {
+        return Move();
+    }
+
+    const Square source = parseSquare(moveAsString[0], moveAsString[1]);
+    const Square target = parseSquare(moveAsString[2], moveAsString[3]);
+    if (source == Square::INVALID || target == Square::INVALID)
+    {
+        return Move();
+    }
+
+    // The promoted piece is lowercase in UCI, whatever the side to move
+    PieceWithColor promotedPiece = InvalidPiece;
+    if (moveAsString.size() == 5)
+    {
+        if (moveAsString[4] != 'n' && moveAsString[4] != 'b' && moveAsString[4] != 'r' && moveAsString[4] != 'q')
+        {
+            return Move();
+        }
+        promotedPiece = FENCharacterToPieceWithColor(m_sideToMove == White ? static_cast<char>(std::toupper(moveAsString[4])) : moveAsString[4]);
+    }
+
+    // Only the source, target and promoted piece are needed to rebuild the move (see unpackMove)
+    return unpackMove(Move(source, target, WhitePawn, promotedPiece, Pawn).getShortData());
+}
+
+Move Board::unpackPseudoLegalMove(const uint16_t packedMove) const
+{
+    const Move partialMove             = Move::fromShortData(packedMove);
+    const Square source                = partialMove.getSource();
+    const Square target                = partialMove.getTarget();
+    const PieceWithColor promotedPiece = partialMove.getPromotedPiece();
+
+    const Side opponentSide          = m_sideToMove == White ? Black : White;
+    const Bitboard occupancy         = m_occupancies[std::to_underlying(m_sideToMove)];
+    const Bitboard opponentOccupancy = m_occupancies[std::to_underlying(opponentSide)];
+    const Bitboard allOccupancy      = m_occupancies[std::to_underlying(WhiteAndBlack)];
+
+    // The source must hold a piece of the side to move, and the target must not
+    if (packedMove == 0 || occupancy.getBit(source) == 0 || occupancy.getBit(target) == 1)
+    {
+        return Move();
+    }
+
+    const PieceWithColor piece = m_mailbox[std::to_underlying(source)];
+
+    const bool isCapture      = opponentOccupancy.getBit(target) == 1;
+    const Piece capturedPiece = isCapture ? getOpponentCapturedPiece(target) : Pawn;
+
+    if (pieceFromPieceWithColor(piece) == Pawn)
+    {
+        const int offset        = piece == WhitePawn ? -8 : 8; // White pawns move up, black pawns move down
+        const bool isPromotion  = (piece == WhitePawn && target <= Square::h8) || (piece == BlackPawn && target >= Square::a1);
+        const bool isDoublePush = ((piece == WhitePawn && source >= Square::a2 && source <= Square::h2) ||
+                                   (piece == BlackPawn && source >= Square::a7 && source <= Square::h7)) &&
+                                  target == source + 2 * offset;
+
+        // Pawns reaching the last rank must promote, to a knight, bishop, rook or queen of their side
+        if (isPromotion != (promotedPiece != InvalidPiece) ||
+            (isPromotion && (promotedPiece <= piece || std::to_underlying(promotedPiece) > std::to_underlying(piece) + 4)))
+        {
+            return Move();
+        }
+
+        const Bitboard attacks = piece == WhitePawn
+                                         ? pregenerated_moves::whitePawnsAttacks[std::to_underlying(source)]
+                                         : pregenerated_moves::blackPawnsAttacks[std::to_underlying(source)];
+        if (attacks.getBit(target) == 1)
         {
-            generatePieceMoves(piece, moves);
+            if (isCapture)
+            {
+                return Move(source, target, piece, promotedPiece, capturedPiece, true, false, false, false);
+            }
+            if (target == m_enPassantSquare)
+            {
+                return Move(source, m_enPassantSquare, piece, InvalidPiece, Pawn, true, false, true, false);
+            }
+            return Move();
         }
 
-        // Generate castling moves for kings
-        if (piece == WhiteKing || piece == BlackKing)
+        // Pushes, the target (and the square in between for a double push) must be empty
+        if (isCapture)
         {
-            generateKingCastlingMoves(piece, moves);
+            return Move();
         }
+        if (target == source + offset)
+        {
+            return Move(source, target, piece, promotedPiece, false, false, false, false);
+        }
+        if (isDoublePush && allOccupancy.getBit(source + offset) == 0)
+        {
+            return Move(source, target, piece, InvalidPiece, false, true, false, false);
+        }
+        return Move();
     }
 
-    return moves;
+    if (promotedPiece != InvalidPiece)
+    {
+        return Move();
+    }
+
+    Bitboard attacks;
+    switch (pieceFromPieceWithColor(piece))
+    {
+        case Knight:
+            attacks = pregenerated_moves::getKnightAttacks(source, allOccupancy);
+            break;
+        case Bishop:
+            attacks = pregenerated_moves::getBishopAttacks(source, allOccupancy);
+            break;
+        case Rook:
+            attacks = pregenerated_moves::getRookAttacks(source, allOccupancy);
+            break;
+        case Queen:
+            attacks = pregenerated_moves::getQueenAttacks(source, allOccupancy);
+            break;
+        case King:
+        {
+            // Castling: reuse the generator to check the castling rights and the attacked squares
+            if (std::abs(std::to_underlying(target) - std::to_underlying(source)) == 2)
+            {
+                MoveList castlingMoves;
+                generateKingCastlingMoves(piece, castlingMoves);
+                for (const Move& move: castlingMoves)
+                {
+                    if (move.getTarget() == target)
+                    {
+                        return move;
+                    }
+                }
+                return Move();
+            }
+            attacks = pregenerated_moves::getKingAttacks(source, allOccupancy);
+            break;
+        }
+        default:
+            std::unreachable();
+    }
+
+    if (attacks.getBit(target) == 0)
+    {
+        return Move();
+    }
+
+    return isCapture ? Move(source, target, piece, InvalidPiece, capturedPiece, true, false, false, false)
+                     : Move(source, target, piece, InvalidPiece, false, false, false, false);
 }
 
-bool Board::makeMove(const Move& move)
+void Board::makeMove(const Move& move)
 {
-    // Save the current board state before making the move
-    const Board boardBeforeMove = *this;
-
     const Square source                = move.getSource();
     const Square target                = move.getTarget();
     const PieceWithColor piece         = move.getPiece();
@@ -362,68 +724,67 @@ bool Board::makeMove(const Move& move)
     const bool isPawnDoublePush        = move.isPawnDoublePush();
     const bool isEnPassant             = move.isEnPassant();
     const bool isCastling              = move.isCastling();
+    const bool isPawnMove              = piece == WhitePawn || piece == BlackPawn;
 
-    // Remove the piece from the source square in the hash
-    m_zobristHash ^= zobrist::getPieceKey(piece, source);
+    // Save the state that cannot be recomputed when unmaking the move
+    StateInfo& state      = m_stateHistory[m_stateIndex++ & (s_stateHistorySize - 1)];
+    state.zobristHash     = m_zobristHash;
+    state.castlingRights  = m_castlingRights;
+    state.enPassantSquare = m_enPassantSquare;
+    state.halfMoveClock   = m_halfMoveClock;
+    state.pliesFromNull   = m_pliesFromNull;
+    state.capturedPiece   = InvalidPiece;
 
-    // Move the piece
-    m_bitboardsPieces[std::to_underlying(piece)].clearBit(source);
-    m_bitboardsPieces[std::to_underlying(piece)].setBit(target);
+    if (isEnPassant)
+    {
+        // Remove the captured pawn, which is behind the target square
+        const PieceWithColor pawn       = m_sideToMove == White ? BlackPawn : WhitePawn;
+        const Square capturedPawnSquare = m_sideToMove == White ? target + 8 : target - 8;
+        removePiece(pawn, capturedPawnSquare);
+        m_zobristHash ^= zobrist::getPieceKey(pawn, capturedPawnSquare);
+        state.capturedPiece = pawn;
+    }
+    else if (isCapture)
+    {
+        const PieceWithColor capturedPiece = m_mailbox[std::to_underlying(target)];
+        removePiece(capturedPiece, target);
+        m_zobristHash ^= zobrist::getPieceKey(capturedPiece, target);
+        state.capturedPiece = capturedPiece;
+    }
 
-    // Add the piece to the target square in the hash
+    // Move the piece, replacing it with the promoted piece if it's a promotion
+    m_zobristHash ^= zobrist::getPieceKey(piece, source);
     if (promotedPiece != InvalidPiece)
     {
-        // If it's a promotion, hash the promoted piece instead
+        removePiece(piece, source);
+        putPiece(promotedPiece, target);
         m_zobristHash ^= zobrist::getPieceKey(promotedPiece, target);
     }
     else
     {
+        movePiece(piece, source, target);
         m_zobristHash ^= zobrist::getPieceKey(piece, target);
     }
 
-    if (isCapture)
-    {
-        // Loop over the pieces of the opponent to find the captured piece
-        const PieceWithColor pawn = m_sideToMove == White ? BlackPawn : WhitePawn;
-        const PieceWithColor king = m_sideToMove == White ? BlackKing : WhiteKing;
-
-        for (PieceWithColor capturedPiece = pawn; capturedPiece <= king; ++capturedPiece)
-        {
-            // Remove the captured piece from the bitboard
-            if (m_bitboardsPieces[std::to_underlying(capturedPiece)].getBit(target) == 1)
-            {
-                // Remove the captured piece from the hash
-                m_zobristHash ^= zobrist::getPieceKey(capturedPiece, target);
-                m_bitboardsPieces[std::to_underlying(capturedPiece)].clearBit(target);
-                break;
-            }
-        }
-    }
-
-    if (promotedPiece != InvalidPiece)
+    if (isCastling)
     {
-        // Set the promoted piece and remove the pawn from the bitboard
-        const PieceWithColor pawn = m_sideToMove == White ? WhitePawn : BlackPawn;
-        m_bitboardsPieces[std::to_underlying(pawn)].clearBit(target);
-        m_bitboardsPieces[std::to_underlying(promotedPiece)].setBit(target);
-        // Remove the pawn from the hash (it was added when we added the piece to source)
-        m_zobristHash ^= zobrist::getPieceKey(pawn, target);
+        const PieceWithColor rook           = m_sideToMove == White ? WhiteRook : BlackRook;
+        const auto [rookSource, rookTarget] = getCastlingRookSquares(target);
+        movePiece(rook, rookSource, rookTarget);
+        m_zobristHash ^= zobrist::getPieceKey(rook, rookSource);
+        m_zobristHash ^= zobrist::getPieceKey(rook, rookTarget);
     }
 
-    if (isEnPassant)
+    // A king move changes all the inputs of its side of the network
+    if ((piece == WhiteKing || piece == BlackKing) && nnue::isLoaded())
     {
-        // Remove the captured pawn from the bitboard
-        const PieceWithColor pawn       = m_sideToMove == White ? BlackPawn : WhitePawn;
-        const Square capturedPawnSquare = m_sideToMove == White ? target + 8 : target - 8;
-        m_bitboardsPieces[std::to_underlying(pawn)].clearBit(capturedPawnSquare);
-        // Remove the captured pawn from the hash
-        m_zobristHash ^= zobrist::getPieceKey(pawn, capturedPawnSquare);
+        nnue::refresh(m_accumulator, m_sideToMove, m_bitboardsPieces);
     }
 
     // Remove the old en passant square from the hash if it exists
-    if (boardBeforeMove.m_enPassantSquare != Square::INVALID)
+    if (m_enPassantSquare != Square::INVALID)
     {
-        const int file = std::to_underlying(boardBeforeMove.m_enPassantSquare) % board_dimensions::N_FILES;
+        const int file = std::to_underlying(m_enPassantSquare) % board_dimensions::N_FILES;
         m_zobristHash ^= zobrist::getEnPassantKey(file);
     }
 
@@ -439,74 +800,19 @@ bool Board::makeMove(const Move& move)
         m_zobristHash ^= zobrist::getEnPassantKey(file);
     }
 
-    if (isCastling)
-    {
-        const PieceWithColor rook = m_sideToMove == White ? WhiteRook : BlackRook;
-        switch (target)
-        {
-            using enum Square;
-            case g1:
-                m_bitboardsPieces[std::to_underlying(rook)].setBit(f1);
-                m_bitboardsPieces[std::to_underlying(rook)].clearBit(h1);
-                m_zobristHash ^= zobrist::getPieceKey(rook, f1);
-                m_zobristHash ^= zobrist::getPieceKey(rook, h1);
-                break;
-            case c1:
-                m_bitboardsPieces[std::to_underlying(rook)].setBit(d1);
-                m_bitboardsPieces[std::to_underlying(rook)].clearBit(a1);
-                m_zobristHash ^= zobrist::getPieceKey(rook, d1);
-                m_zobristHash ^= zobrist::getPieceKey(rook, a1);
-                break;
-            case g8:
-                m_bitboardsPieces[std::to_underlying(rook)].setBit(f8);
-                m_bitboardsPieces[std::to_underlying(rook)].clearBit(h8);
-                m_zobristHash ^= zobrist::getPieceKey(rook, f8);
-                m_zobristHash ^= zobrist::getPieceKey(rook, h8);
-                break;
-            case c8:
-                m_bitboardsPieces[std::to_underlying(rook)].setBit(d8);
-                m_bitboardsPieces[std::to_underlying(rook)].clearBit(a8);
-                m_zobristHash ^= zobrist::getPieceKey(rook, d8);
-                m_zobristHash ^= zobrist::getPieceKey(rook, a8);
-                break;
-            default:
-                return false; // Invalid castling move
-        }
-    }
-
-    // Remove the old castling rights from the hash
-    m_zobristHash ^= zobrist::getCastlingKey(std::to_underlying(boardBeforeMove.m_castlingRights));
-
-    // Update castling rights
-    if (piece == WhiteKing)
-    {
-        m_castlingRights &= ~CastlingRights::WhiteShort;
-        m_castlingRights &= ~CastlingRights::WhiteLong;
-    }
-    else if (piece == BlackKing)
-    {
-        m_castlingRights &= ~CastlingRights::BlackShort;
-        m_castlingRights &= ~CastlingRights::BlackLong;
-    }
-    if (source == Square::a1 || target == Square::a1) m_castlingRights &= ~CastlingRights::WhiteLong;
-    else if (source == Square::h1 || target == Square::h1) m_castlingRights &= ~CastlingRights::WhiteShort;
-    else if (source == Square::a8 || target == Square::a8) m_castlingRights &= ~CastlingRights::BlackLong;
-    else if (source == Square::h8 || target == Square::h8) m_castlingRights &= ~CastlingRights::BlackShort;
-
-    // Add the new castling rights to the hash
+    // Update castling rights, replacing the old ones in the hash
+    m_zobristHash ^= zobrist::getCastlingKey(std::to_underlying(m_castlingRights));
+    m_castlingRights &= castlingRightsMasks[std::to_underlying(source)];
+    m_castlingRights &= castlingRightsMasks[std::to_underlying(target)];
     m_zobristHash ^= zobrist::getCastlingKey(std::to_underlying(m_castlingRights));
 
-    // Update occupancies
-    std::fill(m_occupancies.begin(), m_occupancies.end(), 0);
-    for (PieceWithColor p = WhitePawn; p <= WhiteKing; ++p)
-    {
-        m_occupancies[std::to_underlying(White)] |= m_bitboardsPieces[std::to_underlying(p)];
-    }
-    for (PieceWithColor p = BlackPawn; p <= BlackKing; ++p)
+    // Update the move counters
+    m_halfMoveClock = isPawnMove || isCapture ? 0 : m_halfMoveClock + 1;
+    m_pliesFromNull++;
+    if (m_sideToMove == Black)
     {
-        m_occupancies[std::to_underlying(Black)] |= m_bitboardsPieces[std::to_underlying(p)];
+        m_fullMoveNumber++;
     }
-    m_occupancies[std::to_underlying(WhiteAndBlack)] = m_occupancies[std::to_underlying(White)] | m_occupancies[std::to_underlying(Black)];
 
     // Update the side to move
     m_sideToMove = m_sideToMove == White ? Black : White;
@@ -514,21 +820,74 @@ bool Board::makeMove(const Move& move)
     m_zobristHash ^= zobrist::getSideKey(0);
     m_zobristHash ^= zobrist::getSideKey(1);
 
-    // Check if king is in check after the move
-    const PieceWithColor king = m_sideToMove == White ? BlackKing : WhiteKing;
-    const Square kingSquare   = m_bitboardsPieces[std::to_underlying(king)].getSquareOfLeastSignificantBitIndex();
-    if (isSquareAttacked(kingSquare, m_sideToMove))
+    // Only legal moves are generated, so the king of the side that moved cannot be in check
+    [[maybe_unused]] const PieceWithColor king = m_sideToMove == White ? BlackKing : WhiteKing;
+    assert(!isSquareAttacked(m_bitboardsPieces[std::to_underlying(king)].getSquareOfLeastSignificantBitIndex(), m_sideToMove));
+}
+
+void Board::unmakeMove(const Move& move)
+{
+    const Square source                = move.getSource();
+    const Square target                = move.getTarget();
+    const PieceWithColor piece         = move.getPiece();
+    const PieceWithColor promotedPiece = move.getPromotedPiece();
+
+    // Restore the side to move and the move counters
+    m_sideToMove = m_sideToMove == White ? Black : White;
+    if (m_sideToMove == Black)
+    {
+        m_fullMoveNumber--;
+    }
+
+    const StateInfo& state = m_stateHistory[--m_stateIndex & (s_stateHistorySize - 1)];
+
+    if (move.isCastling())
+    {
+        const PieceWithColor rook           = m_sideToMove == White ? WhiteRook : BlackRook;
+        const auto [rookSource, rookTarget] = getCastlingRookSquares(target);
+        movePiece(rook, rookTarget, rookSource);
+    }
+
+    // Move the piece back, replacing the promoted piece with the pawn if it's a promotion
+    if (promotedPiece != InvalidPiece)
+    {
+        removePiece(promotedPiece, target);
+        putPiece(piece, source);
+    }
+    else
+    {
+        movePiece(piece, target, source);
+    }
+
+    // Put the captured piece back
+    if (state.capturedPiece != InvalidPiece)
+    {
+        const Square capturedSquare = !move.isEnPassant() ? target : m_sideToMove == White ? target + 8 : target - 8;
+        putPiece(state.capturedPiece, capturedSquare);
+    }
+
+    if ((piece == WhiteKing || piece == BlackKing) && nnue::isLoaded())
     {
-        // If the king is in check, revert the move
-        *this = boardBeforeMove;
-        return false; // Invalid move, king is in check
+        nnue::refresh(m_accumulator, m_sideToMove, m_bitboardsPieces);
     }
 
-    return true; // Move was valid
+    m_zobristHash     = state.zobristHash;
+    m_castlingRights  = state.castlingRights;
+    m_enPassantSquare = state.enPassantSquare;
+    m_halfMoveClock   = state.halfMoveClock;
+    m_pliesFromNull   = state.pliesFromNull;
 }
 
 void Board::makeNullMove()
 {
+    StateInfo& state      = m_stateHistory[m_stateIndex++ & (s_stateHistorySize - 1)];
+    state.zobristHash     = m_zobristHash;
+    state.castlingRights  = m_castlingRights;
+    state.enPassantSquare = m_enPassantSquare;
+    state.halfMoveClock   = m_halfMoveClock;
+    state.pliesFromNull   = m_pliesFromNull;
+    state.capturedPiece   = InvalidPiece;
+
     // Remove the old en passant square from the hash if it exists
     if (m_enPassantSquare != Square::INVALID)
     {
@@ -539,6 +898,7 @@ void Board::makeNullMove()
     m_sideToMove      = m_sideToMove == White ? Black : White;
     m_enPassantSquare = Square::INVALID;
     m_halfMoveClock++;
+    m_pliesFromNull = 0; // The positions before a null move cannot be repeated by real moves
     m_fullMoveNumber++;
 
     // Update hash for side to move change
@@ -546,62 +906,184 @@ void Board::makeNullMove()
     m_zobristHash ^= zobrist::getSideKey(1);
 }
 
+void Board::unmakeNullMove()
+{
+    const StateInfo& state = m_stateHistory[--m_stateIndex & (s_stateHistorySize - 1)];
+
+    m_sideToMove      = m_sideToMove == White ? Black : White;
+    m_zobristHash     = state.zobristHash;
+    m_enPassantSquare = state.enPassantSquare;
+    m_halfMoveClock   = state.halfMoveClock;
+    m_pliesFromNull   = state.pliesFromNull;
+    m_fullMoveNumber--;
+}
+
+void Board::putPiece(const PieceWithColor piece, const Square square)
+{
+    const Side side = piece <= WhiteKing ? White : Black;
+    m_bitboardsPieces[std::to_underlying(piece)].setBit(square);
+    m_mailbox[std::to_underlying(square)] = piece;
+    m_occupancies[std::to_underlying(side)].setBit(square);
+    m_occupancies[std::to_underlying(WhiteAndBlack)].setBit(square);
+    m_pieceSquareScore += Evaluate::s_pieceSquareScores[std::to_underlying(piece)][std::to_underlying(square)];
+    m_gamePhase += Evaluate::s_gamePhaseWeights[std::to_underlying(piece)];
+    if (piece == WhitePawn || piece == BlackPawn)
+    {
+        m_pawnKey ^= zobrist::getPieceKey(piece, square);
+    }
+    updateAccumulators(piece, square, true);
+}
+
+void Board::removePiece(const PieceWithColor piece, const Square square)
+{
+    const Side side = piece <= WhiteKing ? White : Black;
+    m_bitboardsPieces[std::to_underlying(piece)].clearBit(square);
+    m_mailbox[std::to_underlying(square)] = InvalidPiece;
+    m_occupancies[std::to_underlying(side)].clearBit(square);
+    m_occupancies[std::to_underlying(WhiteAndBlack)].clearBit(square);
+    m_pieceSquareScore -= Evaluate::s_pieceSquareScores[std::to_underlying(piece)][std::to_underlying(square)];
+    m_gamePhase -= Evaluate::s_gamePhaseWeights[std::to_underlying(piece)];
+    if (piece == WhitePawn || piece == BlackPawn)
+    {
+        m_pawnKey ^= zobrist::getPieceKey(piece, square);
+    }
+    updateAccumulators(piece, square, false);
+}
+
+void Board::movePiece(const PieceWithColor piece, const Square source, const Square target)
+{
+    removePiece(piece, source);
+    putPiece(piece, target);
+}
 
-void Board::generatePawnMoves(const PieceWithColor piece, std::vector<Move>& moves)
+void Board::updateAccumulators(const PieceWithColor piece, const Square square, const bool isAdded)
+{
+    // The kings are not inputs of the network: a king move refreshes its perspective instead (see makeMove)
+    if (!nnue::isLoaded() || piece == WhiteKing || piece == BlackKing)
+    {
+        return;
+    }
+
+    for (const Side perspective: {White, Black})
+    {
+        const Square kingSquare = m_bitboardsPieces[std::to_underlying(perspective == White ? WhiteKing : BlackKing)].getSquareOfLeastSignificantBitIndex();
+        const int featureIndex  = nnue::getFeatureIndex(perspective, kingSquare, piece, square);
+        if (isAdded)
+        {
+            nnue::addFeature(m_accumulator, perspective, featureIndex);
+        }
+        else
+        {
+            nnue::removeFeature(m_accumulator, perspective, featureIndex);
+        }
+    }
+}
+
+void Board::refreshAccumulators()
+{
+    if (!nnue::isLoaded())
+    {
+        return;
+    }
+
+    for (const Side perspective: {White, Black})
+    {
+        if (m_bitboardsPieces[std::to_underlying(perspective == White ? WhiteKing : BlackKing)] != Bitboard())
+        {
+            nnue::refresh(m_accumulator, perspective, m_bitboardsPieces);
+        }
+    }
+}
+
+const nnue::Accumulator& Board::getAccumulator() const
+{
+    return m_accumulator;
+}
+
+std::pair<Square, Square> Board::getCastlingRookSquares(const Square kingTarget)
+{
+    switch (kingTarget)
+    {
+        using enum Square;
+        case g1: return {h1, f1};
+        case c1: return {a1, d1};
+        case g8: return {h8, f8};
+        case c8: return {a8, d8};
+        default: std::unreachable(); // Castling moves are only generated with these targets
+    }
+}
+
+
+void Board::generatePawnMoves(const PieceWithColor piece, MoveList& moves, const MoveGenType type, const Bitboard checkMask, const Bitboard pinned) const
 {
     constexpr Bitboard emptyBitboard;
-    Bitboard bitboardPiece = m_bitboardsPieces[std::to_underlying(piece)];
+    Bitboard bitboardPiece  = m_bitboardsPieces[std::to_underlying(piece)];
+    const Square kingSquare = m_bitboardsPieces[std::to_underlying(piece == WhitePawn ? WhiteKing : BlackKing)].getSquareOfLeastSignificantBitIndex();
 
     const int offset = piece == WhitePawn ? -8 : 8; // White pawns move up, black pawns move down
 
+    const bool generateCaptures = type != MoveGenType::Quiets;   // Captures and promotions
+    const bool generateQuiets   = type != MoveGenType::Captures; // Other pushes
+    // The squares that can be captured (none when only generating the quiet moves)
+    const Bitboard captureTargets = generateCaptures ? m_occupancies[std::to_underlying(piece == WhitePawn ? Black : White)] : emptyBitboard;
+
     while (bitboardPiece != emptyBitboard)
     {
-        const Square source = bitboardPiece.getSquareOfLeastSignificantBitIndex();
+        const Square source = bitboardPiece.popLsb();
         Square target       = source + offset; // Move one square forward
 
+        // A pinned pawn can only move along the line between its king and the pinner
+        const Bitboard targets = pinned.getBit(source) == 1 ? checkMask & pregenerated_moves::lineSquares[std::to_underlying(kingSquare)][std::to_underlying(source)]
+                                                            : checkMask;
+
         const bool isPromotion = (piece == WhitePawn && source >= Square::a7 && source <= Square::h7) ||
                                  (piece == BlackPawn && source >= Square::a2 && source <= Square::h2);
         const bool isDoublePush = (piece == WhitePawn && source >= Square::a2 && source <= Square::h2) ||
                                   (piece == BlackPawn && source >= Square::a7 && source <= Square::h7);
 
         Bitboard attacks = piece == WhitePawn
-                                   ? pregenerated_moves::whitePawnsAttacks[std::to_underlying(source)] & m_occupancies[std::to_underlying(Black)]
-                                   : pregenerated_moves::blackPawnsAttacks[std::to_underlying(source)] & m_occupancies[std::to_underlying(White)];
+                                   ? pregenerated_moves::whitePawnsAttacks[std::to_underlying(source)] & captureTargets & targets
+                                   : pregenerated_moves::blackPawnsAttacks[std::to_underlying(source)] & captureTargets & targets;
 
         // If the square ahead is empty
         if (m_occupancies[std::to_underlying(WhiteAndBlack)].getBit(target) == 0)
         {
+            const bool isTarget = targets.getBit(target) == 1;
+
             // Promotion
-            if (isPromotion)
+            if (isPromotion && generateCaptures && isTarget)
             {
                 if (piece == WhitePawn)
                 {
-                    moves.emplace_back(source, target, piece, WhiteKnight, false, false, false, false);
-                    moves.emplace_back(source, target, piece, WhiteBishop, false, false, false, false);
-                    moves.emplace_back(source, target, piece, WhiteRook, false, false, false, false);
-                    moves.emplace_back(source, target, piece, WhiteQueen, false, false, false, false);
+                    moves.add(source, target, piece, WhiteKnight, false, false, false, false);
+                    moves.add(source, target, piece, WhiteBishop, false, false, false, false);
+                    moves.add(source, target, piece, WhiteRook, false, false, false, false);
+                    moves.add(source, target, piece, WhiteQueen, false, false, false, false);
                 }
                 else
                 {
-                    moves.emplace_back(source, target, piece, BlackKnight, false, false, false, false);
-                    moves.emplace_back(source, target, piece, BlackBishop, false, false, false, false);
-                    moves.emplace_back(source, target, piece, BlackRook, false, false, false, false);
-                    moves.emplace_back(source, target, piece, BlackQueen, false, false, false, false);
+                    moves.add(source, target, piece, BlackKnight, false, false, false, false);
+                    moves.add(source, target, piece, BlackBishop, false, false, false, false);
+                    moves.add(source, target, piece, BlackRook, false, false, false, false);
+                    moves.add(source, target, piece, BlackQueen, false, false, false, false);
                 }
             }
             // Normal move
-            else
+            else if (!isPromotion && generateQuiets)
             {
                 // Move one square forward
-                moves.emplace_back(source, target, piece, InvalidPiece, false, false, false, false);
+                if (isTarget)
+                {
+                    moves.add(source, target, piece, InvalidPiece, false, false, false, false);
+                }
 
                 // Move two squares forward
                 if (isDoublePush)
                 {
                     target = target + offset; // Move two squares forward
-                    if (m_occupancies[std::to_underlying(WhiteAndBlack)].getBit(target) == 0)
+                    if (m_occupancies[std::to_underlying(WhiteAndBlack)].getBit(target) == 0 && targets.getBit(target) == 1)
                     {
-                        moves.emplace_back(source, target, piece, InvalidPiece, false, true, false, false);
+                        moves.add(source, target, piece, InvalidPiece, false, true, false, false);
                     }
                 }
             }
@@ -609,7 +1091,7 @@ void Board::generatePawnMoves(const PieceWithColor piece, std::vector<Move>& mov
 
         while (attacks != emptyBitboard)
         {
-            target              = attacks.getSquareOfLeastSignificantBitIndex();
+            target              = attacks.popLsb();
             Piece capturedPiece = getOpponentCapturedPiece(target);
 
             // Capture and promotion
@@ -617,30 +1099,29 @@ void Board::generatePawnMoves(const PieceWithColor piece, std::vector<Move>& mov
             {
                 if (piece == WhitePawn)
                 {
-                    moves.emplace_back(source, target, piece, WhiteKnight, capturedPiece, true, false, false, false);
-                    moves.emplace_back(source, target, piece, WhiteBishop, capturedPiece, true, false, false, false);
-                    moves.emplace_back(source, target, piece, WhiteRook, capturedPiece, true, false, false, false);
-                    moves.emplace_back(source, target, piece, WhiteQueen, capturedPiece, true, false, false, false);
+                    moves.add(source, target, piece, WhiteKnight, capturedPiece, true, false, false, false);
+                    moves.add(source, target, piece, WhiteBishop, capturedPiece, true, false, false, false);
+                    moves.add(source, target, piece, WhiteRook, capturedPiece, true, false, false, false);
+                    moves.add(source, target, piece, WhiteQueen, capturedPiece, true, false, false, false);
                 }
                 else
                 {
-                    moves.emplace_back(source, target, piece, BlackKnight, capturedPiece, true, false, false, false);
-                    moves.emplace_back(source, target, piece, BlackBishop, capturedPiece, true, false, false, false);
-                    moves.emplace_back(source, target, piece, BlackRook, capturedPiece, true, false, false, false);
-                    moves.emplace_back(source, target, piece, BlackQueen, capturedPiece, true, false, false, false);
+                    moves.add(source, target, piece, BlackKnight, capturedPiece, true, false, false, false);
+                    moves.add(source, target, piece, BlackBishop, capturedPiece, true, false, false, false);
+                    moves.add(source, target, piece, BlackRook, capturedPiece, true, false, false, false);
+                    moves.add(source, target, piece, BlackQueen, capturedPiece, true, false, false, false);
                 }
             }
             // Normal capture
             else
             {
-                moves.emplace_back(source, target, piece, InvalidPiece, capturedPiece, true, false, false, false);
+                moves.add(source, target, piece, InvalidPiece, capturedPiece, true, false, false, false);
             }
-
-            attacks.clearBit(target);
         }
 
         // En passant capture
-        if (m_enPassantSquare != Square::INVALID)
+        // Both pawns leave their squares and the captured pawn is not on the target square: the pins and the check mask do not apply
+        if (m_enPassantSquare != Square::INVALID && generateCaptures)
         {
             Bitboard enPassantBitboard;
             if (piece == WhitePawn && m_sideToMove == White)
@@ -652,19 +1133,16 @@ void Board::generatePawnMoves(const PieceWithColor piece, std::vector<Move>& mov
                 enPassantBitboard = pregenerated_moves::blackPawnsAttacks[std::to_underlying(source)] & Bitboard(m_enPassantSquare);
             }
 
-            if (enPassantBitboard != emptyBitboard)
+            if (enPassantBitboard != emptyBitboard && isEnPassantLegal(source))
             {
                 // If the target square is the en passant square, capture the pawn
-                moves.emplace_back(source, m_enPassantSquare, piece, InvalidPiece, Pawn, true, false, true, false);
+                moves.add(source, m_enPassantSquare, piece, InvalidPiece, Pawn, true, false, true, false);
             }
         }
-
-        // Remove the piece from the bitboard after processing
-        bitboardPiece.clearBit(source);
     }
 }
 
-void Board::generateKingCastlingMoves(PieceWithColor piece, std::vector<Move>& moves) const
+void Board::generateKingCastlingMoves(PieceWithColor piece, MoveList& moves) const
 {
     switch (piece)
     {
@@ -678,7 +1156,7 @@ void Board::generateKingCastlingMoves(PieceWithColor piece, std::vector<Move>& m
                     !isSquareAttacked(Square::f1, Black) &&
                     !isSquareAttacked(Square::g1, Black))
                 {
-                    moves.emplace_back(Square::e1, Square::g1, piece, InvalidPiece, false, false, false, true);
+                    moves.add(Square::e1, Square::g1, piece, InvalidPiece, false, false, false, true);
                 }
             }
             if (m_castlingRights & CastlingRights::WhiteLong)
@@ -691,7 +1169,7 @@ void Board::generateKingCastlingMoves(PieceWithColor piece, std::vector<Move>& m
                     !isSquareAttacked(Square::d1, Black) &&
                     !isSquareAttacked(Square::e1, Black))
                 {
-                    moves.emplace_back(Square::e1, Square::c1, piece, InvalidPiece, false, false, false, true);
+                    moves.add(Square::e1, Square::c1, piece, InvalidPiece, false, false, false, true);
                 }
             }
             break;
@@ -705,7 +1183,7 @@ void Board::generateKingCastlingMoves(PieceWithColor piece, std::vector<Move>& m
                     !isSquareAttacked(Square::f8, White) &&
                     !isSquareAttacked(Square::g8, White))
                 {
-                    moves.emplace_back(Square::e8, Square::g8, piece, InvalidPiece, false, false, false, true);
+                    moves.add(Square::e8, Square::g8, piece, InvalidPiece, false, false, false, true);
                 }
             }
 
@@ -719,7 +1197,7 @@ void Board::generateKingCastlingMoves(PieceWithColor piece, std::vector<Move>& m
                     !isSquareAttacked(Square::d8, White) &&
                     !isSquareAttacked(Square::e8, White))
                 {
-                    moves.emplace_back(Square::e8, Square::c8, piece, InvalidPiece, false, false, false, true);
+                    moves.add(Square::e8, Square::c8, piece, InvalidPiece, false, false, false, true);
                 }
             }
             break;
@@ -729,12 +1207,48 @@ void Board::generateKingCastlingMoves(PieceWithColor piece, std::vector<Move>& m
 }
 
 
-void Board::generatePieceMoves(const PieceWithColor piece, std::vector<Move>& moves) const
+void Board::generateKingMoves(const PieceWithColor piece, MoveList& moves, const Bitboard targets) const
+{
+    const Side opponentSide = piece == WhiteKing ? Black : White;
+    constexpr Bitboard emptyBitboard;
+    const Square source = m_bitboardsPieces[std::to_underlying(piece)].getSquareOfLeastSignificantBitIndex();
+
+    // Remove the king from the occupancy, so that it cannot step back along the ray of a slider checking it
+    Bitboard occupancy = m_occupancies[std::to_underlying(WhiteAndBlack)];
+    occupancy.clearBit(source);
+
+    const Bitboard opponentOccupancy = m_occupancies[std::to_underlying(opponentSide)];
+    Bitboard attacks                 = pregenerated_moves::kingAttacks[std::to_underlying(source)] & targets;
+
+    while (attacks != emptyBitboard)
+    {
+        const Square target = attacks.popLsb();
+        if (isSquareAttacked(target, opponentSide, occupancy))
+        {
+            continue;
+        }
+
+        // Quiet move
+        if (opponentOccupancy.getBit(target) == 0)
+        {
+            moves.add(source, target, piece, InvalidPiece, false, false, false, false);
+        }
+        // Capture move
+        else
+        {
+            Piece capturedPiece = getOpponentCapturedPiece(target);
+            moves.add(source, target, piece, InvalidPiece, capturedPiece, true, false, false, false);
+        }
+    }
+}
+
+void Board::generatePieceMoves(const PieceWithColor piece, MoveList& moves, const Bitboard targets, const Bitboard pinned) const
 {
     const Side side         = piece >= WhitePawn && piece <= WhiteKing ? White : Black;
     const Side opponentSide = side == White ? Black : White;
     constexpr Bitboard emptyBitboard;
-    Bitboard bitboardPiece = m_bitboardsPieces[std::to_underlying(piece)];
+    Bitboard bitboardPiece  = m_bitboardsPieces[std::to_underlying(piece)];
+    const Square kingSquare = m_bitboardsPieces[std::to_underlying(side == White ? WhiteKing : BlackKing)].getSquareOfLeastSignificantBitIndex();
 
     // Get the occupancy of the piece's side
     const Bitboard occupancy = m_occupancies[std::to_underlying(side)];
@@ -763,58 +1277,45 @@ void Board::generatePieceMoves(const PieceWithColor piece, std::vector<Move>& mo
         case BlackQueen:
             getAttacks = pregenerated_moves::getQueenAttacks;
             break;
-        case WhiteKing:
-        case BlackKing:
-            getAttacks = pregenerated_moves::getKingAttacks;
-            break;
         default:
             return; // Invalid piece
     }
 
     while (bitboardPiece != emptyBitboard)
     {
-        const Square source = bitboardPiece.getSquareOfLeastSignificantBitIndex();
+        const Square source = bitboardPiece.popLsb();
         // Get all possible attacks from the source square (all possible moves except the squares occupied by other pieces of the same side)
-        Bitboard attacks = getAttacks(source, allOccupancy) & ~occupancy.getBitboard();
+        Bitboard attacks = getAttacks(source, allOccupancy) & targets;
+
+        // A pinned piece can only move along the line between its king and the pinner
+        if (pinned.getBit(source) == 1)
+        {
+            attacks = attacks & pregenerated_moves::lineSquares[std::to_underlying(kingSquare)][std::to_underlying(source)];
+        }
 
         while (attacks != emptyBitboard)
         {
-            const Square target = attacks.getSquareOfLeastSignificantBitIndex();
+            const Square target = attacks.popLsb();
 
             // Quiet move
             if (opponentOccupancy.getBit(target) == 0)
             {
-                moves.emplace_back(source, target, piece, InvalidPiece, false, false, false, false);
+                moves.add(source, target, piece, InvalidPiece, false, false, false, false);
             }
             // Capture move
             else
             {
                 Piece capturedPiece = getOpponentCapturedPiece(target);
-                moves.emplace_back(source, target, piece, InvalidPiece, capturedPiece, true, false, false, false);
+                moves.add(source, target, piece, InvalidPiece, capturedPiece, true, false, false, false);
             }
-
-            attacks.clearBit(target);
         }
-
-        bitboardPiece.clearBit(source);
     }
 }
 
 Piece Board::getOpponentCapturedPiece(const Square target) const
 {
-    // Loop over the pieces of the opponent to find the captured piece
-    const PieceWithColor pawn = m_sideToMove == White ? BlackPawn : WhitePawn;
-    const PieceWithColor king = m_sideToMove == White ? BlackKing : WhiteKing;
-
-    for (PieceWithColor p = pawn; p <= king; ++p)
-    {
-        if (m_bitboardsPieces[std::to_underlying(p)].getBit(target) == 1)
-        {
-            return pieceFromPieceWithColor(p);
-        }
-    }
-
-    return Pawn;
+    const PieceWithColor piece = m_mailbox[std::to_underlying(target)];
+    return piece == InvalidPiece ? Pawn : pieceFromPieceWithColor(piece);
 }
 
 Bitboard Board::getBitboardForPiece(const PieceWithColor piece) const
@@ -822,11 +1323,31 @@ Bitboard Board::getBitboardForPiece(const PieceWithColor piece) const
     return m_bitboardsPieces[std::to_underlying(piece)];
 }
 
+PieceWithColor Board::getPieceOnSquare(const Square square) const
+{
+    return m_mailbox[std::to_underlying(square)];
+}
+
 Side Board::getSideToMove() const
 {
     return m_sideToMove;
 }
 
+CastlingRights Board::getCastlingRights() const
+{
+    return m_castlingRights;
+}
+
+Square Board::getEnPassantSquare() const
+{
+    return m_enPassantSquare;
+}
+
+int Board::getHalfMoveClock() const
+{
+    return m_halfMoveClock;
+}
+
 bool Board::isCheck() const
 {
     const PieceWithColor king = m_sideToMove == White ? WhiteKing : BlackKing;
@@ -834,6 +1355,131 @@ bool Board::isCheck() const
     return isSquareAttacked(kingSquare, m_sideToMove == White ? Black : White);
 }
 
+Bitboard Board::getCheckers() const
+{
+    const bool isWhite          = m_sideToMove == White;
+    const Square kingSquare     = getBitboardForPiece(isWhite ? WhiteKing : BlackKing).getSquareOfLeastSignificantBitIndex();
+    const Bitboard allOccupancy = m_occupancies[std::to_underlying(WhiteAndBlack)];
+
+    const Bitboard pawns   = getBitboardForPiece(isWhite ? BlackPawn : WhitePawn);
+    const Bitboard knights = getBitboardForPiece(isWhite ? BlackKnight : WhiteKnight);
+    const Bitboard bishops = getBitboardForPiece(isWhite ? BlackBishop : WhiteBishop);
+    const Bitboard rooks   = getBitboardForPiece(isWhite ? BlackRook : WhiteRook);
+    const Bitboard queens  = getBitboardForPiece(isWhite ? BlackQueen : WhiteQueen);
+
+    // The opponent pieces attacking the king are the ones the king would attack if it was the same piece
+    const Bitboard pawnAttacks = isWhite ? pregenerated_moves::whitePawnsAttacks[std::to_underlying(kingSquare)]
+                                         : pregenerated_moves::blackPawnsAttacks[std::to_underlying(kingSquare)];
+
+    return (pawnAttacks & pawns) |
+           (pregenerated_moves::knightAttacks[std::to_underlying(kingSquare)] & knights) |
+           (pregenerated_moves::getBishopAttacks(kingSquare, allOccupancy) & (bishops | queens)) |
+           (pregenerated_moves::getRookAttacks(kingSquare, allOccupancy) & (rooks | queens));
+}
+
+Bitboard Board::getPinnedPieces() const
+{
+    const bool isWhite          = m_sideToMove == White;
+    const Square kingSquare     = getBitboardForPiece(isWhite ? WhiteKing : BlackKing).getSquareOfLeastSignificantBitIndex();
+    const Bitboard occupancy    = m_occupancies[std::to_underlying(m_sideToMove)];
+    const Bitboard allOccupancy = m_occupancies[std::to_underlying(WhiteAndBlack)];
+
+    const Bitboard bishops = getBitboardForPiece(isWhite ? BlackBishop : WhiteBishop);
+    const Bitboard rooks   = getBitboardForPiece(isWhite ? BlackRook : WhiteRook);
+    const Bitboard queens  = getBitboardForPiece(isWhite ? BlackQueen : WhiteQueen);
+
+    // The opponent sliders that would attack the king if there were only opponent pieces on the board
+    const Bitboard opponentOccupancy = m_occupancies[std::to_underlying(isWhite ? Black : White)];
+    Bitboard snipers                 = (pregenerated_moves::getBishopAttacks(kingSquare, opponentOccupancy) & (bishops | queens)) |
+                                       (pregenerated_moves::getRookAttacks(kingSquare, opponentOccupancy) & (rooks | queens));
+
+    // A piece is pinned if it is the only piece between the king and a sniper
+    Bitboard pinned;
+    while (snipers != Bitboard())
+    {
+        const Square sniperSquare = snipers.popLsb();
+        const Bitboard blockers   = pregenerated_moves::betweenSquares[std::to_underlying(kingSquare)][std::to_underlying(sniperSquare)] & allOccupancy;
+        if (blockers.getNumberOfBitsSet() == 1)
+        {
+            pinned |= blockers & occupancy;
+        }
+    }
+
+    return pinned;
+}
+
+bool Board::isEnPassantLegal(const Square source) const
+{
+    const bool isWhite              = m_sideToMove == White;
+    const Square kingSquare         = getBitboardForPiece(isWhite ? WhiteKing : BlackKing).getSquareOfLeastSignificantBitIndex();
+    const Square capturedPawnSquare = m_enPassantSquare + (isWhite ? 8 : -8);
+
+    // A knight giving check cannot be captured en passant, and the captured pawn is the only pawn that can give check
+    const Bitboard checkers    = getCheckers();
+    const Bitboard nonSliders  = getBitboardForPiece(isWhite ? BlackKnight : WhiteKnight) | getBitboardForPiece(isWhite ? BlackPawn : WhitePawn);
+    Bitboard remainingCheckers = checkers & nonSliders;
+    remainingCheckers.clearBit(capturedPawnSquare);
+    if (remainingCheckers != Bitboard())
+    {
+        return false;
+    }
+
+    // Look for the sliders attacking the king once the pawns have moved
+    Bitboard occupancy = m_occupancies[std::to_underlying(WhiteAndBlack)];
+    occupancy.clearBit(source);
+    occupancy.clearBit(capturedPawnSquare);
+    occupancy.setBit(m_enPassantSquare);
+
+    const Bitboard bishops = getBitboardForPiece(isWhite ? BlackBishop : WhiteBishop);
+    const Bitboard rooks   = getBitboardForPiece(isWhite ? BlackRook : WhiteRook);
+    const Bitboard queens  = getBitboardForPiece(isWhite ? BlackQueen : WhiteQueen);
+
+    return (pregenerated_moves::getBishopAttacks(kingSquare, occupancy) & (bishops | queens)) == Bitboard() &&
+           (pregenerated_moves::getRookAttacks(kingSquare, occupancy) & (rooks | queens)) == Bitboard();
+}
+
+bool Board::isLegal(const Move& move) const
+{
+    const Square source        = move.getSource();
+    const Square target        = move.getTarget();
+    const PieceWithColor piece = move.getPiece();
+    const Side opponentSide    = m_sideToMove == White ? Black : White;
+
+    // The castling moves are only generated if the king does not go through an attacked square
+    if (move.isCastling())
+    {
+        return true;
+    }
+
+    // The king must not move to an attacked square, including along the ray of a slider checking it
+    if (pieceFromPieceWithColor(piece) == King)
+    {
+        Bitboard occupancy = m_occupancies[std::to_underlying(WhiteAndBlack)];
+        occupancy.clearBit(source);
+        return !isSquareAttacked(target, opponentSide, occupancy);
+    }
+
+    if (move.isEnPassant())
+    {
+        return isEnPassantLegal(source);
+    }
+
+    // The other pieces must capture the only checker or block its check, and the pinned pieces must stay on the line of the pin
+    const Square kingSquare = getBitboardForPiece(m_sideToMove == White ? WhiteKing : BlackKing).getSquareOfLeastSignificantBitIndex();
+    if (const Bitboard checkers = getCheckers(); checkers != Bitboard())
+    {
+        const Square checkerSquare = checkers.getSquareOfLeastSignificantBitIndex();
+        const Bitboard checkMask   = checkers | pregenerated_moves::betweenSquares[std::to_underlying(kingSquare)][std::to_underlying(checkerSquare)];
+        if (checkers.getNumberOfBitsSet() > 1 || checkMask.getBit(target) == 0)
+        {
+            return false;
+        }
+    }
+
+    return getPinnedPieces().getBit(source) == 0 ||
+           pregenerated_moves::lineSquares[std::to_underlying(kingSquare)][std::to_underlying(source)].getBit(target) == 1;
+}
+
 Bitboard Board::getOccupancyForSide(const Side side) const
 {
     return m_occupancies[std::to_underlying(side)];
@@ -854,9 +1500,49 @@ int Board::getTotalMaterial(const Side side) const
     return totalMaterial;
 }
 
+TaperedScore Board::getPieceSquareScore() const
+{
+    return m_pieceSquareScore;
+}
+
+int Board::getGamePhase() const
+{
+    return m_gamePhase;
+}
+
+uint64_t Board::getPawnKey() const
+{
+    return m_pawnKey;
+}
+
 uint64_t Board::getZobristHash() const
 {
     return m_zobristHash;
 }
 
+bool Board::isRepetition() const
+{
+    // The position i plies ago is the hash saved by the i-th last move. The same side is to move every other ply,
+    // and it takes at least 4 plies to come back to a position
+    const int end = std::min({m_halfMoveClock, m_pliesFromNull, static_cast<int>(std::min(m_stateIndex, s_stateHistorySize))});
+    for (int i = 4; i <= end; i += 2)
+    {
+        if (m_stateHistory[(m_stateIndex - static_cast<size_t>(i)) & (s_stateHistorySize - 1)].zobristHash == m_zobristHash)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Board::isDraw() const
+{
+    // Fifty-move rule, unless the last move was a checkmate
+    if (m_halfMoveClock >= 100 && (!isCheck() || !generateMoves().empty()))
+    {
+        return true;
+    }
+    return isRepetition();
+}
+
 } // namespace chess_engine
\ No newline at end of file
@@ -1,97 +1,78 @@
 #include "evaluate.h"
+
+#include <algorithm>
+
 #include "pregenerated_moves.h"
 
 namespace chess_engine
 {
 int Evaluate::evaluatePosition(const Board& board)
 {
-    int score        = 0;
-    int whiteBishops = 0, blackBishops = 0;
-
-    // Choose king table based on material (endgame vs middle game)
-    const bool isEndGame = board.getTotalMaterial(White) - s_piecesValues[std::to_underlying(WhiteKing)] <= s_endGameThreshold &&
-                           board.getTotalMaterial(Black) + s_piecesValues[std::to_underlying(BlackKing)] <= s_endGameThreshold;
-    const std::array<int, 64>& kingTable = isEndGame ? s_kingEndGameTable : s_kingMiddleGameTable;
+    return evaluatePosition(board, evaluatePawns(board));
+}
 
-    for (const PieceWithColor piece: PieceWithColor())
+int Evaluate::evaluatePosition(const Board& board, PawnHashTable& pawnHashTable)
+{
+    PawnEntry& pawnEntry = pawnHashTable.getEntry(board.getPawnKey());
+    if (pawnEntry.key != board.getPawnKey())
     {
-        Bitboard bitboardPiece = board.getBitboardForPiece(piece);
-
-        while (bitboardPiece != Bitboard())
-        {
-            score += s_piecesValues[std::to_underlying(piece)];
-            const Square square = bitboardPiece.getSquareOfLeastSignificantBitIndex();
-
-            switch (piece)
-            {
-                case WhitePawn:
-                    score += s_pawnTable[std::to_underlying(square)];
-                    break;
-                case BlackPawn:
-                    score -= s_pawnTable[63 - std::to_underlying(square)];
-                    break;
-                case WhiteKnight:
-                    score += s_knightTable[std::to_underlying(square)];
-                    break;
-                case BlackKnight:
-                    score -= s_knightTable[63 - std::to_underlying(square)];
-                    break;
-                case WhiteBishop:
-                    score += s_bishopTable[std::to_underlying(square)];
-                    whiteBishops++;
-                    break;
-                case BlackBishop:
-                    score -= s_bishopTable[63 - std::to_underlying(square)];
-                    blackBishops++;
-                    break;
-                case WhiteRook:
-                    score += s_rookTable[std::to_underlying(square)];
-                    break;
-                case BlackRook:
-                    score -= s_rookTable[63 - std::to_underlying(square)];
-                    break;
-                case WhiteQueen:
-                    score += s_queenTable[std::to_underlying(square)];
-                    break;
-                case BlackQueen:
-                    score -= s_queenTable[63 - std::to_underlying(square)];
-                    break;
-                case WhiteKing:
-                    score += kingTable[std::to_underlying(square)];
-                    break;
-                case BlackKing:
-                    score -= kingTable[63 - std::to_underlying(square)];
-                    break;
-                default:
-                    break;
-            }
-
-            bitboardPiece.clearBit(square);
-        }
+        pawnEntry = evaluatePawns(board);
     }
+    return evaluatePosition(board, pawnEntry);
+}
+
+int Evaluate::evaluatePosition(const Board& board, const PawnEntry& pawnEntry)
+{
+    // Interpolate the material and piece-square tables score between the middle game and the end game.
+    // The phase can exceed the middle game phase after early promotions
+    const TaperedScore pieceSquareScore = board.getPieceSquareScore();
+    const int phase                     = std::min(board.getGamePhase(), s_middleGamePhase);
+    int score                           = (pieceSquareScore.middleGame * phase + pieceSquareScore.endGame * (s_middleGamePhase - phase)) / s_middleGamePhase;
 
-    if (whiteBishops >= 2)
+    if (board.getBitboardForPiece(WhiteBishop).getNumberOfBitsSet() >= 2)
     {
         score += s_bishopPairBonus;
     }
-    if (blackBishops >= 2)
+    if (board.getBitboardForPiece(BlackBishop).getNumberOfBitsSet() >= 2)
     {
         score -= s_bishopPairBonus;
     }
 
-    score += evaluatePawnStructure(board, White);
-    score -= evaluatePawnStructure(board, Black);
+    score += pawnEntry.score;
 
-    score += evaluateRooksOnOpenFile(board, White);
-    score -= evaluateRooksOnOpenFile(board, Black);
+    score += evaluateRooksOnOpenFile(board, White, pawnEntry);
+    score -= evaluateRooksOnOpenFile(board, Black, pawnEntry);
 
-    score += evaluateMobility(board, White);
-    score -= evaluateMobility(board, Black);
+    const AttackInfo attackInfo = computeAttackInfo(board, pawnEntry);
+    score += attackInfo.mobility[std::to_underlying(White)] - attackInfo.mobility[std::to_underlying(Black)];
 
     return board.getSideToMove() == White ? score : -score;
 }
 
-int Evaluate::evaluatePawnStructure(const Board& board, Side side)
+PawnEntry Evaluate::evaluatePawns(const Board& board)
+{
+    PawnEntry pawnEntry;
+    pawnEntry.key = board.getPawnKey();
+
+    for (const Side side: {White, Black})
+    {
+        const int index        = std::to_underlying(side);
+        Bitboard pawnsBitboard = board.getBitboardForPiece(side == White ? WhitePawn : BlackPawn);
+        while (pawnsBitboard != Bitboard())
+        {
+            const Square square = pawnsBitboard.popLsb();
+            pawnEntry.pawnAttacks[index] |= side == White ? pregenerated_moves::whitePawnsAttacks[std::to_underlying(square)]
+                                                          : pregenerated_moves::blackPawnsAttacks[std::to_underlying(square)];
+            pawnEntry.semiOpenFiles[index] &= ~(1 << (std::to_underlying(square) % board_dimensions::N_FILES));
+        }
+    }
+
+    pawnEntry.score = evaluatePawnStructure(board, White, pawnEntry.passedPawns[std::to_underlying(White)]) -
+                      evaluatePawnStructure(board, Black, pawnEntry.passedPawns[std::to_underlying(Black)]);
+    return pawnEntry;
+}
+
+int Evaluate::evaluatePawnStructure(const Board& board, Side side, Bitboard& passedPawns)
 {
     int score                                                = 0;
     std::array<int, board_dimensions::N_FILES> pawnCountFile = {};
@@ -100,10 +81,9 @@ int Evaluate::evaluatePawnStructure(const Board& board, Side side)
     // Count pawns per file
     while (pawnsBitboard != Bitboard())
     {
-        const Square square = pawnsBitboard.getSquareOfLeastSignificantBitIndex();
+        const Square square = pawnsBitboard.popLsb();
         const int file      = std::to_underlying(square) % board_dimensions::N_FILES;
         pawnCountFile[file]++;
-        pawnsBitboard.clearBit(square);
     }
 
     // Double pawns penalty
@@ -133,7 +113,7 @@ int Evaluate::evaluatePawnStructure(const Board& board, Side side)
     pawnsBitboard = board.getBitboardForPiece(side == White ? WhitePawn : BlackPawn);
     while (pawnsBitboard != Bitboard())
     {
-        const Square square = pawnsBitboard.getSquareOfLeastSignificantBitIndex();
+        const Square square = pawnsBitboard.popLsb();
         const int file      = std::to_underlying(square) % board_dimensions::N_FILES;
         const int rank      = std::to_underlying(square) / board_dimensions::N_RANKS;
         bool isPassed       = true;
@@ -158,144 +138,84 @@ int Evaluate::evaluatePawnStructure(const Board& board, Side side)
         {
             debug::debug_log("{} is a passed pawn", Board::s_squares[std::to_underlying(square)]);
             score += s_passedPawnBonus;
+            passedPawns.setBit(square);
         }
-        pawnsBitboard.clearBit(square);
     }
 
     return score;
 }
 
-int Evaluate::evaluateRooksOnOpenFile(const Board& board, Side side)
+int Evaluate::evaluateRooksOnOpenFile(const Board& board, Side side, const PawnEntry& pawnEntry)
 {
-    int score                         = 0;
-    Bitboard rooksBitboard            = board.getBitboardForPiece(side == White ? WhiteRook : BlackRook);
-    const Bitboard whitePawnsBitboard = board.getBitboardForPiece(WhitePawn);
-    const Bitboard blackPawnsBitboard = board.getBitboardForPiece(BlackPawn);
-    Bitboard allPawnsBitboard         = whitePawnsBitboard | blackPawnsBitboard;
+    int score              = 0;
+    Bitboard rooksBitboard = board.getBitboardForPiece(side == White ? WhiteRook : BlackRook);
+
+    // Open files have no pawns at all, semi-open files only have pawns of the opponent
+    const uint8_t semiOpenFiles = pawnEntry.semiOpenFiles[std::to_underlying(side)];
+    const uint8_t openFiles     = semiOpenFiles & pawnEntry.semiOpenFiles[std::to_underlying(side == White ? Black : White)];
 
     while (rooksBitboard != Bitboard())
     {
-        const auto rookSquare = rooksBitboard.getSquareOfLeastSignificantBitIndex();
+        const auto rookSquare = rooksBitboard.popLsb();
         const int file        = std::to_underlying(rookSquare) % board_dimensions::N_FILES;
-        bool isOpenFile       = true;
-        bool isSemiOpenFile   = true;
-
-        while (allPawnsBitboard != Bitboard())
-        {
-            const auto pawnSquare = allPawnsBitboard.getSquareOfLeastSignificantBitIndex();
-            const int pawnFile    = std::to_underlying(pawnSquare) % board_dimensions::N_FILES;
-
-            if (pawnFile == file)
-            {
-                isOpenFile = false;
-
-                if ((side == White && whitePawnsBitboard.getBit(pawnSquare) == 1) ||
-                    (side == Black && blackPawnsBitboard.getBit(pawnSquare) == 1))
-                {
-                    isSemiOpenFile = false;
-                }
-                break;
-            }
-
-            allPawnsBitboard.clearBit(pawnSquare);
-        }
 
-        if (isOpenFile)
+        if ((openFiles >> file) & 1)
         {
             score += s_rookOnOpenFileBonus;
         }
-        else if (isSemiOpenFile)
+        else if ((semiOpenFiles >> file) & 1)
         {
             score += s_rookOnSemiOpenFileBonus;
         }
-
-        rooksBitboard.clearBit(rookSquare);
     }
 
     return score;
 }
 
-// TODO: Code is repeated for each piece, refactor
-// Note: Maybe can reuse the code from move generation (Board::generatePieceMoves)?
-int Evaluate::evaluateMobility(const Board& board, Side side)
+AttackInfo Evaluate::computeAttackInfo(const Board& board, const PawnEntry& pawnEntry)
 {
-    int score            = 0;
-    const Side otherSide = side == White ? Black : White;
-    constexpr Bitboard emptyBitboard;
-
-    const Bitboard occupancy         = board.getOccupancyForSide(side);
-    const Bitboard opponentOccupancy = board.getOccupancyForSide(otherSide);
-    const Bitboard allOccupancy      = occupancy | opponentOccupancy;
-
-    PieceWithColor piece   = side == White ? WhiteKnight : BlackKnight;
-    Bitboard bitboardPiece = board.getBitboardForPiece(piece);
-    while (bitboardPiece != emptyBitboard)
-    {
-        const Square source = bitboardPiece.getSquareOfLeastSignificantBitIndex();
-        Bitboard attacks    = pregenerated_moves::getKnightAttacks(source, allOccupancy) & ~occupancy.getBitboard();
-
-        while (attacks != emptyBitboard)
-        {
-            score += s_knightMobilityBonus;
-            const Square target = attacks.getSquareOfLeastSignificantBitIndex();
-            attacks.clearBit(target);
-        }
-
-        bitboardPiece.clearBit(source);
-    }
-
-    piece         = side == White ? WhiteBishop : BlackBishop;
-    bitboardPiece = board.getBitboardForPiece(piece);
-    while (bitboardPiece != emptyBitboard)
+    // Attacks of the knight to the queen, indexed by Piece
+    constexpr std::array<Bitboard (*)(Square, Bitboard), 5> getAttacks = {
+            nullptr,
+            pregenerated_moves::getKnightAttacks,
+            pregenerated_moves::getBishopAttacks,
+            pregenerated_moves::getRookAttacks,
+            pregenerated_moves::getQueenAttacks};
+
+    AttackInfo attackInfo;
+    const Bitboard allOccupancy = board.getOccupancyForSide(WhiteAndBlack);
+
+    for (const Side side: {White, Black})
     {
-        const Square source = bitboardPiece.getSquareOfLeastSignificantBitIndex();
-        Bitboard attacks    = pregenerated_moves::getKnightAttacks(source, allOccupancy) & ~occupancy.getBitboard();
-
-        while (attacks != emptyBitboard)
-        {
-            score += s_bishopMobilityBonus;
-            const Square target = attacks.getSquareOfLeastSignificantBitIndex();
-            attacks.clearBit(target);
-        }
-
-        bitboardPiece.clearBit(source);
-    }
+        const int sideIndex       = std::to_underlying(side);
+        const PieceWithColor pawn = side == White ? WhitePawn : BlackPawn;
+        const PieceWithColor king = side == White ? WhiteKing : BlackKing;
+        const Bitboard targets    = ~board.getOccupancyForSide(side).getBitboard(); // The squares a piece can move to
 
-    piece         = side == White ? WhiteRook : BlackRook;
-    bitboardPiece = board.getBitboardForPiece(piece);
-    while (bitboardPiece != emptyBitboard)
-    {
-        const Square source = bitboardPiece.getSquareOfLeastSignificantBitIndex();
-        Bitboard attacks    = pregenerated_moves::getKnightAttacks(source, allOccupancy) & ~occupancy.getBitboard();
+        // The pawn attacks are stored in the pawn hash table
+        attackInfo.pieceAttacks[std::to_underlying(pawn)] = pawnEntry.pawnAttacks[sideIndex];
+        attackInfo.pieceAttacks[std::to_underlying(king)] =
+                pregenerated_moves::kingAttacks[std::to_underlying(board.getBitboardForPiece(king).getSquareOfLeastSignificantBitIndex())];
 
-        while (attacks != emptyBitboard)
+        for (PieceWithColor piece = pawn; ++piece < king;)
         {
-            score += s_rookMobilityBonus;
-            const Square target = attacks.getSquareOfLeastSignificantBitIndex();
-            attacks.clearBit(target);
+            const int pieceIndex   = std::to_underlying(pieceFromPieceWithColor(piece));
+            Bitboard bitboardPiece = board.getBitboardForPiece(piece);
+            while (bitboardPiece != Bitboard())
+            {
+                const Bitboard attacks = getAttacks[pieceIndex](bitboardPiece.popLsb(), allOccupancy);
+                attackInfo.pieceAttacks[std::to_underlying(piece)] |= attacks;
+                attackInfo.mobility[sideIndex] += (attacks & targets).getNumberOfBitsSet() * s_mobilityBonus[pieceIndex];
+            }
         }
 
-        bitboardPiece.clearBit(source);
-    }
-
-    piece         = side == White ? WhiteQueen : BlackQueen;
-    bitboardPiece = board.getBitboardForPiece(piece);
-    while (bitboardPiece != emptyBitboard)
-    {
-        const Square source = bitboardPiece.getSquareOfLeastSignificantBitIndex();
-        Bitboard attacks    = pregenerated_moves::getKnightAttacks(source, allOccupancy) & ~occupancy.getBitboard();
-
-        while (attacks != emptyBitboard)
+        for (PieceWithColor piece = pawn; piece <= king; ++piece)
         {
-            score += s_queenMobilityBonus;
-            const Square target = attacks.getSquareOfLeastSignificantBitIndex();
-            attacks.clearBit(target);
+            attackInfo.sideAttacks[sideIndex] |= attackInfo.pieceAttacks[std::to_underlying(piece)];
         }
-
-        bitboardPiece.clearBit(source);
     }
 
-    return score;
+    return attackInfo;
 }
 
-} // namespace chess_engine
\ No newline at end of file
+} // namespace chess_engine
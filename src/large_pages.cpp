@@ -0,0 +1,231 @@
+#include "large_pages.h"
+
+#include <charconv>
+#include <cstdint>
+#include <cstdlib>
+#include <format>
+#include <fstream>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <malloc.h>
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+namespace chess_engine::large_pages
+{
+namespace
+{
+constexpr size_t s_cacheLineSize = 64; //< Alignment of the allocations on normal pages
+
+/**
+ * @brief Round a size up to a multiple of an alignment.
+ *
+ * @param size The size to round.
+ * @param alignment The alignment (a power of two).
+ * @return The rounded size.
+ */
+[[nodiscard]] constexpr size_t roundUp(const size_t size, const size_t alignment)
+{
+    return (size + alignment - 1) & ~(alignment - 1);
+}
+
+/**
+ * @brief Parse the start and the end of a mapping from a line of /proc/self/smaps (e.g. "7f1234560000-7f1234570000 rw-p ...").
+ *
+ * @param line The line.
+ * @param start Set to the start of the mapping.
+ * @param end Set to the end of the mapping.
+ * @return True if the line is the first line of a mapping, false otherwise.
+ */
+[[nodiscard]] bool parseMappingRange(const std::string_view line, uintptr_t& start, uintptr_t& end)
+{
+    const char* const last = line.data() + line.size();
+    const auto [dash, startError] = std::from_chars(line.data(), last, start, 16);
+    if (startError != std::errc() || dash == last || *dash != '-')
+    {
+        return false;
+    }
+
+    const auto [space, endError] = std::from_chars(dash + 1, last, end, 16);
+    return endError == std::errc() && space != last && *space == ' ';
+}
+} // namespace
+
+void* allocate(const size_t size, PageKind& pageKind)
+{
+    if (size >= HUGE_PAGE_SIZE)
+    {
+#if defined(_WIN32)
+        // Only possible if the process has the privilege to lock pages in memory
+        if (const size_t largePageSize = GetLargePageMinimum(); largePageSize != 0)
+        {
+            void* pointer = VirtualAlloc(nullptr, roundUp(size, largePageSize), MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+            if (pointer != nullptr)
+            {
+                pageKind = PageKind::Explicit;
+                return pointer;
+            }
+        }
+#elif defined(__linux__)
+        // Explicit huge pages, only available if the administrator reserved some
+        void* pointer = mmap(nullptr, roundUp(size, HUGE_PAGE_SIZE), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (pointer != MAP_FAILED)
+        {
+            pageKind = PageKind::Explicit;
+            return pointer;
+        }
+
+        // Transparent huge pages, only if the memory is aligned to a huge page
+        pointer = std::aligned_alloc(HUGE_PAGE_SIZE, roundUp(size, HUGE_PAGE_SIZE));
+        if (pointer != nullptr)
+        {
+            pageKind = madvise(pointer, roundUp(size, HUGE_PAGE_SIZE), MADV_HUGEPAGE) == 0 ? PageKind::Transparent : PageKind::Normal;
+            return pointer;
+        }
+#endif
+    }
+
+    pageKind = PageKind::Normal;
+#if defined(_WIN32)
+    return _aligned_malloc(roundUp(size, s_cacheLineSize), s_cacheLineSize);
+#else
+    return std::aligned_alloc(s_cacheLineSize, roundUp(size, s_cacheLineSize));
+#endif
+}
+
+void deallocate(void* pointer, [[maybe_unused]] const size_t size, const PageKind pageKind)
+{
+    if (pointer == nullptr)
+    {
+        return;
+    }
+
+#if defined(_WIN32)
+    if (pageKind == PageKind::Explicit)
+    {
+        VirtualFree(pointer, 0, MEM_RELEASE);
+    }
+    else
+    {
+        _aligned_free(pointer);
+    }
+#else
+    if (pageKind == PageKind::Explicit)
+    {
+        munmap(pointer, roundUp(size, HUGE_PAGE_SIZE));
+    }
+    else
+    {
+        std::free(pointer);
+    }
+#endif
+}
+
+std::string describePlacement([[maybe_unused]] const void* address)
+{
+#if defined(__linux__)
+    const auto target = reinterpret_cast<uintptr_t>(address);
+
+    // Find the mapping of the address, and its resident size and the part of it on huge pages
+    std::ifstream smaps("/proc/self/smaps");
+    std::string line;
+    uintptr_t mappingStart = 0;
+    bool isFound           = false;
+    uint64_t residentKB    = 0;
+    uint64_t hugePagesKB   = 0;
+
+    while (std::getline(smaps, line))
+    {
+        uintptr_t start = 0;
+        uintptr_t end   = 0;
+        if (parseMappingRange(line, start, end))
+        {
+            if (isFound)
+            {
+                break;
+            }
+            isFound      = start <= target && target < end;
+            mappingStart = start;
+            continue;
+        }
+
+        if (!isFound)
+        {
+            continue;
+        }
+
+        const auto parseField = [&line](const std::string_view name, uint64_t& value)
+        {
+            if (line.starts_with(name))
+            {
+                const size_t first = line.find_first_not_of(' ', name.size());
+                uint64_t fieldValue = 0;
+                if (first != std::string::npos)
+                {
+                    std::from_chars(line.data() + first, line.data() + line.size(), fieldValue);
+                }
+                value += fieldValue;
+            }
+        };
+        parseField("Rss:", residentKB);
+        parseField("AnonHugePages:", hugePagesKB);
+        parseField("FilePmdMapped:", hugePagesKB);
+        parseField("Private_Hugetlb:", hugePagesKB);
+    }
+
+    if (!isFound)
+    {
+        return {};
+    }
+
+    std::string description = std::format("{} kB resident, {} kB on huge pages", residentKB, hugePagesKB);
+
+    // The pages of each NUMA node ("N<node>=<pages>")
+    std::ifstream numaMaps("/proc/self/numa_maps");
+    const std::string prefix = std::format("{:x} ", mappingStart);
+    while (std::getline(numaMaps, line))
+    {
+        if (!line.starts_with(prefix))
+        {
+            continue;
+        }
+
+        std::string nodes;
+        for (size_t index = line.find(" N"); index != std::string::npos; index = line.find(" N", index + 1))
+        {
+            const size_t end = line.find(' ', index + 1);
+            nodes += ' ';
+            nodes += line.substr(index + 1, end == std::string::npos ? std::string::npos : end - index - 1);
+        }
+        if (!nodes.empty())
+        {
+            description += ", NUMA pages" + nodes;
+        }
+        break;
+    }
+
+    return description;
+#else
+    return {};
+#endif
+}
+
+std::string_view toString(const PageKind pageKind)
+{
+    switch (pageKind)
+    {
+        case PageKind::Explicit:
+            return "huge pages";
+        case PageKind::Transparent:
+            return "transparent huge pages";
+        case PageKind::Normal:
+        default:
+            return "normal pages";
+    }
+}
+} // namespace chess_engine::large_pages
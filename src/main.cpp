@@ -1,10 +1,39 @@
+#include <optional>
+#include <print>
+#include <string>
+#include <string_view>
+
+#include "analysis.h"
+#include "benchmark.h"
 #include "bitboard.h"
-#include "pregenerated_moves.h"
 #include "uci_connection.h"
 
-int main()
+int main(const int argc, const char* argv[])
 {
-    chess_engine::pregenerated_moves::initAllPieces();
+    // "chess_engine bench [depth] [threads] [hash]" runs the benchmark and exits
+    if (argc > 1 && std::string_view(argv[1]) == "bench")
+    {
+        std::string command;
+        for (int i = 1; i < argc; i++)
+        {
+            command += std::string(argv[i]) + ' ';
+        }
+        chess_engine::benchmark::run(command);
+        return 0;
+    }
+
+    // "chess_engine analyze [options]" analyzes a stream of positions and exits (see analysis.h)
+    if (argc > 1 && std::string_view(argv[1]) == "analyze")
+    {
+        const std::optional<chess_engine::analysis::AnalysisOptions> options = chess_engine::analysis::parseArguments(argc - 2, argv + 2);
+        if (!options)
+        {
+            std::println(stderr, "Usage: {} analyze [--input file.epd] [--output file] [--depth N] [--threads T] [--hash MB] [--format jsonl|csv]", argv[0]);
+            return 2;
+        }
+        return chess_engine::analysis::run(*options);
+    }
+
     chess_engine::Board board;
     board.print();
     chess_engine::UCIConnection::loop(board);
@@ -0,0 +1,211 @@
+#include "move_picker.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace chess_engine
+{
+MovePicker::MovePicker(const Board& board, const uint16_t ttMove, const KillerMoves& killerMoves, const HistoryTable& history)
+    : m_board(board),
+      m_history(&history),
+      m_stage(Stage::TTMove),
+      m_isQuiescence(false),
+      m_ttMove(board.unpackMove(ttMove)),
+      m_killerMoves(killerMoves)
+{
+}
+
+MovePicker::MovePicker(const Board& board)
+    : m_board(board),
+      m_history(nullptr),
+      m_stage(Stage::GenerateCaptures),
+      m_isQuiescence(true)
+{
+}
+
+Move MovePicker::next()
+{
+    switch (m_stage)
+    {
+        case Stage::TTMove:
+            // In check, only the moves that can get out of check are generated
+            m_stage = m_board.isCheck() ? Stage::GenerateEvasions : Stage::GenerateCaptures;
+            if (!m_ttMove.isNull())
+            {
+                return m_ttMove;
+            }
+            [[fallthrough]];
+
+        case Stage::GenerateCaptures:
+            m_board.generateMoves(m_moves, MoveGenType::Captures);
+            scoreCaptures();
+            m_stage = Stage::GoodCaptures;
+            [[fallthrough]];
+
+        case Stage::GoodCaptures:
+            while (m_current < m_moves.size())
+            {
+                const Move move = pickBest(m_moves.size());
+                if (m_moves[m_current - 1].score < 0)
+                {
+                    // Only the losing captures are left, they are searched after the quiet moves
+                    m_current--;
+                    break;
+                }
+                if (move != m_ttMove)
+                {
+                    return move;
+                }
+            }
+            if (m_isQuiescence)
+            {
+                // The losing captures are not searched in the quiescence search
+                m_stage = Stage::Done;
+                return Move();
+            }
+            m_badCapturesBegin = m_current;
+            m_badCapturesEnd   = m_moves.size();
+            m_stage            = Stage::Killers;
+            [[fallthrough]];
+
+        case Stage::Killers:
+            while (m_killerIndex < m_killerMoves.size())
+            {
+                if (const size_t index = m_killerIndex++; isValidKiller(index))
+                {
+                    return m_killerMoves[index];
+                }
+            }
+            m_stage = Stage::GenerateQuiets;
+            [[fallthrough]];
+
+        case Stage::GenerateQuiets:
+            // Only reached if no earlier move caused a cutoff: the quiet moves are appended after the losing captures
+            m_current = m_badCapturesEnd;
+            m_board.generateMoves(m_moves, MoveGenType::Quiets);
+            scoreQuiets();
+            m_stage = Stage::Quiets;
+            [[fallthrough]];
+
+        case Stage::Quiets:
+            while (m_current < m_moves.size())
+            {
+                if (const Move move = pickBest(m_moves.size()); move != m_ttMove && move != m_killerMoves[0] && move != m_killerMoves[1])
+                {
+                    return move;
+                }
+            }
+            m_current = m_badCapturesBegin;
+            m_stage   = Stage::BadCaptures;
+            [[fallthrough]];
+
+        case Stage::BadCaptures:
+            while (m_current < m_badCapturesEnd)
+            {
+                if (const Move move = pickBest(m_badCapturesEnd); move != m_ttMove)
+                {
+                    return move;
+                }
+            }
+            m_stage = Stage::Done;
+            return Move();
+
+        case Stage::GenerateEvasions:
+            m_board.generateMoves(m_moves, MoveGenType::Evasions);
+            scoreEvasions();
+            m_stage = Stage::Evasions;
+            [[fallthrough]];
+
+        case Stage::Evasions:
+            while (m_current < m_moves.size())
+            {
+                if (const Move move = pickBest(m_moves.size()); move != m_ttMove)
+                {
+                    return move;
+                }
+            }
+            m_stage = Stage::Done;
+            [[fallthrough]];
+
+        case Stage::Done:
+            return Move();
+    }
+
+    std::unreachable();
+}
+
+void MovePicker::scoreCaptures()
+{
+    for (size_t i = m_current; i < m_moves.size(); i++)
+    {
+        // The losing captures are ordered by their SEE value, below the others
+        const int seeValue = m_board.getStaticExchangeEvaluation(m_moves[i]);
+        m_moves[i].score   = seeValue >= 0 ? getCaptureScore(m_moves[i]) : seeValue;
+    }
+}
+
+void MovePicker::scoreQuiets()
+{
+    for (size_t i = m_current; i < m_moves.size(); i++)
+    {
+        m_moves[i].score = getQuietScore(m_moves[i]);
+    }
+}
+
+void MovePicker::scoreEvasions()
+{
+    for (size_t i = m_current; i < m_moves.size(); i++)
+    {
+        ScoredMove& move = m_moves[i];
+        move.score       = move.isCapture() || move.isPromotion() ? s_evasionCaptureBonus + getCaptureScore(move) : getQuietScore(move);
+    }
+}
+
+int MovePicker::getCaptureScore(const Move& move)
+{
+    int score = 0;
+
+    // MVV-LVA (Most Valuable Victim - Least Valuable Attacker)
+    if (move.isCapture())
+    {
+        score += 1000 + 10 * std::to_underlying(move.getCapturedPiece()) - (std::to_underlying(move.getPiece()) % 6);
+    }
+    if (move.isPromotion())
+    {
+        score += 300 + std::to_underlying(move.getPromotedPiece());
+    }
+
+    return score;
+}
+
+int MovePicker::getQuietScore(const Move& move) const
+{
+    return (*m_history)[std::to_underlying(move.getPiece())][std::to_underlying(move.getTarget())];
+}
+
+Move MovePicker::pickBest(const size_t end)
+{
+    ScoredMove* const current = m_moves.begin() + m_current++;
+    ScoredMove* const best    = std::max_element(current, m_moves.begin() + end, [](const ScoredMove& a, const ScoredMove& b)
+    {
+        return a.score < b.score;
+    });
+
+    std::swap(*current, *best);
+    return *current;
+}
+
+bool MovePicker::isValidKiller(const size_t index) const
+{
+    const Move killer = m_killerMoves[index];
+
+    // Promotions are returned with the captures, and both killer moves can be the same move
+    if (killer.isNull() || killer == m_ttMove || killer.isPromotion() || (index > 0 && killer == m_killerMoves[0]))
+    {
+        return false;
+    }
+
+    // The killer moves come from other positions at the same ply, they may not be legal here
+    return m_board.unpackMove(killer.getShortData()) == killer;
+}
+} // namespace chess_engine
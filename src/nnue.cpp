@@ -0,0 +1,338 @@
+#include "nnue.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__AVX512BW__) || defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace chess_engine::nnue
+{
+namespace
+{
+constexpr char s_magic[]          = "CENNUE01"; //< Magic of the network files
+constexpr size_t s_headerSize     = 64;         //< Size of the header, in bytes
+constexpr size_t s_outputBiasSize = 64;         //< Size of the output bias section, in bytes
+
+constexpr size_t s_fileSize = s_headerSize +
+                              N_HIDDEN * sizeof(int16_t) +
+                              static_cast<size_t>(N_INPUTS) * N_HIDDEN * sizeof(int16_t) +
+                              2 * N_HIDDEN * sizeof(int16_t) +
+                              s_outputBiasSize;
+
+/**
+ * @brief The weights of the loaded network, pointing into the mapped file.
+ */
+struct Network
+{
+    const int16_t* featureBiases  = nullptr; //< First layer biases
+    const int16_t* featureWeights = nullptr; //< First layer weights, N_HIDDEN for each input
+    const int16_t* outputWeights  = nullptr; //< Output weights, the side to move first
+    int32_t outputBias            = 0;       //< Output bias
+};
+
+Network s_network;               //< The loaded network
+const void* s_mapping = nullptr; //< The mapped network file (nullptr if no network is loaded)
+size_t s_mappingSize  = 0;       //< Size of the mapping, in bytes
+#if defined(_WIN32)
+HANDLE s_mappingHandle = nullptr; //< Handle of the file mapping
+#endif
+
+/**
+ * @brief Map a file in memory, read-only.
+ *
+ * @param path The path of the file.
+ * @param size Set to the size of the file.
+ * @return The mapped file, or nullptr on error.
+ */
+const void* mapFile(const std::string& path, size_t& size)
+{
+#if defined(_WIN32)
+    const HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return nullptr;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+    {
+        CloseHandle(file);
+        return nullptr;
+    }
+    size = static_cast<size_t>(fileSize.QuadPart);
+
+    // The mapping keeps the file open
+    s_mappingHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (s_mappingHandle == nullptr)
+    {
+        return nullptr;
+    }
+
+    const void* mapping = MapViewOfFile(s_mappingHandle, FILE_MAP_READ, 0, 0, 0);
+    if (mapping == nullptr)
+    {
+        CloseHandle(s_mappingHandle);
+        s_mappingHandle = nullptr;
+    }
+    return mapping;
+#else
+    const int file = open(path.c_str(), O_RDONLY);
+    if (file == -1)
+    {
+        return nullptr;
+    }
+
+    struct stat fileStat;
+    if (fstat(file, &fileStat) == -1 || fileStat.st_size == 0)
+    {
+        close(file);
+        return nullptr;
+    }
+    size = static_cast<size_t>(fileStat.st_size);
+
+    // Shared mapping: the pages are shared by all the processes mapping the same file, the mapping keeps the file open
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, file, 0);
+    close(file);
+    return mapping == MAP_FAILED ? nullptr : mapping;
+#endif
+}
+
+/**
+ * @brief Unmap a file mapped with mapFile.
+ *
+ * @param mapping The mapped file.
+ * @param size The size of the file.
+ */
+void unmapFile(const void* mapping, [[maybe_unused]] const size_t size)
+{
+#if defined(_WIN32)
+    UnmapViewOfFile(mapping);
+    CloseHandle(s_mappingHandle);
+    s_mappingHandle = nullptr;
+#else
+    munmap(const_cast<void*>(mapping), size);
+#endif
+}
+
+/**
+ * @brief Add or subtract a row of weights to an accumulator.
+ *
+ * @tparam isAdd True to add the weights, false to subtract them.
+ * @param values The accumulator of a perspective (aligned to 64 bytes).
+ * @param weights The weights of an input (aligned to 64 bytes).
+ */
+template<bool isAdd>
+void updateAccumulator(int16_t* values, const int16_t* weights)
+{
+#if defined(__AVX512BW__)
+    for (int i = 0; i < N_HIDDEN; i += 32)
+    {
+        const __m512i value  = _mm512_load_si512(values + i);
+        const __m512i weight = _mm512_load_si512(weights + i);
+        _mm512_store_si512(values + i, isAdd ? _mm512_add_epi16(value, weight) : _mm512_sub_epi16(value, weight));
+    }
+#elif defined(__AVX2__)
+    for (int i = 0; i < N_HIDDEN; i += 16)
+    {
+        const __m256i value  = _mm256_load_si256(reinterpret_cast<const __m256i*>(values + i));
+        const __m256i weight = _mm256_load_si256(reinterpret_cast<const __m256i*>(weights + i));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(values + i), isAdd ? _mm256_add_epi16(value, weight) : _mm256_sub_epi16(value, weight));
+    }
+#elif defined(__ARM_NEON)
+    for (int i = 0; i < N_HIDDEN; i += 8)
+    {
+        const int16x8_t value  = vld1q_s16(values + i);
+        const int16x8_t weight = vld1q_s16(weights + i);
+        vst1q_s16(values + i, isAdd ? vaddq_s16(value, weight) : vsubq_s16(value, weight));
+    }
+#else
+    for (int i = 0; i < N_HIDDEN; i++)
+    {
+        values[i] = static_cast<int16_t>(isAdd ? values[i] + weights[i] : values[i] - weights[i]);
+    }
+#endif
+}
+
+/**
+ * @brief Compute the dot product of the clipped ReLU of an accumulator with the output weights.
+ *
+ * @param values The accumulator of a perspective (aligned to 64 bytes).
+ * @param weights The output weights of the perspective (aligned to 64 bytes).
+ * @return The dot product.
+ */
+int32_t clippedReLUDotProduct(const int16_t* values, const int16_t* weights)
+{
+#if defined(__AVX512BW__)
+    const __m512i zero = _mm512_setzero_si512();
+    const __m512i qa   = _mm512_set1_epi16(QA);
+    __m512i sum        = _mm512_setzero_si512();
+    for (int i = 0; i < N_HIDDEN; i += 32)
+    {
+        const __m512i value = _mm512_min_epi16(_mm512_max_epi16(_mm512_load_si512(values + i), zero), qa);
+        sum                 = _mm512_add_epi32(sum, _mm512_madd_epi16(value, _mm512_load_si512(weights + i)));
+    }
+    return _mm512_reduce_add_epi32(sum);
+#elif defined(__AVX2__)
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i qa   = _mm256_set1_epi16(QA);
+    __m256i sum        = _mm256_setzero_si256();
+    for (int i = 0; i < N_HIDDEN; i += 16)
+    {
+        const __m256i value  = _mm256_load_si256(reinterpret_cast<const __m256i*>(values + i));
+        const __m256i weight = _mm256_load_si256(reinterpret_cast<const __m256i*>(weights + i));
+        sum                  = _mm256_add_epi32(sum, _mm256_madd_epi16(_mm256_min_epi16(_mm256_max_epi16(value, zero), qa), weight));
+    }
+
+    // Horizontal sum of the 8 32-bit lanes
+    __m128i sum128 = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    sum128         = _mm_add_epi32(sum128, _mm_shuffle_epi32(sum128, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum128         = _mm_add_epi32(sum128, _mm_shuffle_epi32(sum128, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(sum128);
+#elif defined(__ARM_NEON)
+    const int16x8_t zero = vdupq_n_s16(0);
+    const int16x8_t qa   = vdupq_n_s16(QA);
+    int32x4_t sum        = vdupq_n_s32(0);
+    for (int i = 0; i < N_HIDDEN; i += 8)
+    {
+        const int16x8_t value  = vminq_s16(vmaxq_s16(vld1q_s16(values + i), zero), qa);
+        const int16x8_t weight = vld1q_s16(weights + i);
+        sum                    = vmlal_s16(sum, vget_low_s16(value), vget_low_s16(weight));
+        sum                    = vmlal_s16(sum, vget_high_s16(value), vget_high_s16(weight));
+    }
+    return vaddvq_s32(sum);
+#else
+    int32_t sum = 0;
+    for (int i = 0; i < N_HIDDEN; i++)
+    {
+        const int32_t value = std::min<int32_t>(std::max<int32_t>(values[i], 0), QA);
+        sum += value * weights[i];
+    }
+    return sum;
+#endif
+}
+} // namespace
+
+bool load(const std::string& path)
+{
+    unload();
+
+    size_t size         = 0;
+    const void* mapping = mapFile(path, size);
+    if (mapping == nullptr)
+    {
+        return false;
+    }
+
+    // Check the header and the size of the file before using the weights
+    const auto* bytes = static_cast<const char*>(mapping);
+    uint32_t inputs = 0, hidden = 0;
+    if (size == s_fileSize)
+    {
+        std::memcpy(&inputs, bytes + 8, sizeof(inputs));
+        std::memcpy(&hidden, bytes + 12, sizeof(hidden));
+    }
+    if (size != s_fileSize || std::memcmp(bytes, s_magic, 8) != 0 || inputs != N_INPUTS || hidden != N_HIDDEN)
+    {
+        unmapFile(mapping, size);
+        return false;
+    }
+
+    s_network.featureBiases  = reinterpret_cast<const int16_t*>(bytes + s_headerSize);
+    s_network.featureWeights = s_network.featureBiases + N_HIDDEN;
+    s_network.outputWeights  = s_network.featureWeights + static_cast<size_t>(N_INPUTS) * N_HIDDEN;
+    std::memcpy(&s_network.outputBias, s_network.outputWeights + 2 * N_HIDDEN, sizeof(s_network.outputBias));
+
+    s_mapping     = mapping;
+    s_mappingSize = size;
+    return true;
+}
+
+void unload()
+{
+    if (s_mapping != nullptr)
+    {
+        unmapFile(s_mapping, s_mappingSize);
+    }
+    s_mapping     = nullptr;
+    s_mappingSize = 0;
+    s_network     = Network();
+}
+
+bool isLoaded()
+{
+    return s_mapping != nullptr;
+}
+
+int getFeatureIndex(const Side perspective, const Square kingSquare, const PieceWithColor piece, const Square square)
+{
+    // Black sees the board flipped vertically, and the pieces of the perspective come first
+    const int flip          = perspective == White ? 0 : 56;
+    const bool isOwnPiece   = (piece <= WhiteKing) == (perspective == White);
+    const int pieceIndex    = std::to_underlying(pieceFromPieceWithColor(piece)) + (isOwnPiece ? 0 : N_FEATURE_PIECES / 2);
+    const int orientedKing  = std::to_underlying(kingSquare) ^ flip;
+    const int orientedPiece = std::to_underlying(square) ^ flip;
+
+    return (orientedKing * N_FEATURE_PIECES + pieceIndex) * board_dimensions::N_SQUARES + orientedPiece;
+}
+
+void addFeature(Accumulator& accumulator, const Side perspective, const int featureIndex)
+{
+    updateAccumulator<true>(accumulator.values[std::to_underlying(perspective)].data(),
+                            s_network.featureWeights + static_cast<size_t>(featureIndex) * N_HIDDEN);
+}
+
+void removeFeature(Accumulator& accumulator, const Side perspective, const int featureIndex)
+{
+    updateAccumulator<false>(accumulator.values[std::to_underlying(perspective)].data(),
+                             s_network.featureWeights + static_cast<size_t>(featureIndex) * N_HIDDEN);
+}
+
+void refresh(Accumulator& accumulator, const Side perspective, const std::array<Bitboard, 12>& pieces)
+{
+    const PieceWithColor king = perspective == White ? WhiteKing : BlackKing;
+    const Square kingSquare   = pieces[std::to_underlying(king)].getSquareOfLeastSignificantBitIndex();
+
+    std::memcpy(accumulator.values[std::to_underlying(perspective)].data(), s_network.featureBiases, N_HIDDEN * sizeof(int16_t));
+    for (const PieceWithColor piece: PieceWithColor())
+    {
+        if (pieceFromPieceWithColor(piece) == King)
+        {
+            continue;
+        }
+
+        Bitboard bitboard = pieces[std::to_underlying(piece)];
+        while (bitboard != Bitboard())
+        {
+            addFeature(accumulator, perspective, getFeatureIndex(perspective, kingSquare, piece, bitboard.popLsb()));
+        }
+    }
+}
+
+int evaluate(const Accumulator& accumulator, const Side sideToMove)
+{
+    const Side opponentSide = sideToMove == White ? Black : White;
+    const int32_t output    = clippedReLUDotProduct(accumulator.values[std::to_underlying(sideToMove)].data(), s_network.outputWeights) +
+                              clippedReLUDotProduct(accumulator.values[std::to_underlying(opponentSide)].data(), s_network.outputWeights + N_HIDDEN) +
+                              s_network.outputBias;
+
+    return static_cast<int>(static_cast<int64_t>(output) * SCALE / (QA * QB));
+}
+} // namespace chess_engine::nnue
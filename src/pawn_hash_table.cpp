@@ -0,0 +1,14 @@
+#include "pawn_hash_table.h"
+
+namespace chess_engine
+{
+PawnHashTable::PawnHashTable()
+    : m_entries(large_pages::makeUniqueArray<PawnEntry>(s_numberOfEntries))
+{
+}
+
+PawnEntry& PawnHashTable::getEntry(const uint64_t key)
+{
+    return m_entries[key & (s_numberOfEntries - 1)];
+}
+} // namespace chess_engine
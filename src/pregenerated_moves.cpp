@@ -0,0 +1,12 @@
+#include "pregenerated_moves.h"
+
+namespace chess_engine::pregenerated_moves
+{
+// constinit: generated by the compiler, so the tables are placed in .rodata and shared by all the engine processes
+constinit const std::array<Bitboard, BISHOP_ATTACK_TABLE_SIZE> bishopAttacks =
+        generateSliderAttacks<BISHOP_ATTACK_TABLE_SIZE>(bishopMagics, slider_utils::generateBishopAttacksOnTheFly);
+constinit const std::array<Bitboard, ROOK_ATTACK_TABLE_SIZE> rookAttacks =
+        generateSliderAttacks<ROOK_ATTACK_TABLE_SIZE>(rookMagics, slider_utils::generateRookAttacksOnTheFly);
+constinit const std::array<std::array<Bitboard, 64>, 64> betweenSquares = generateBetweenSquares();
+constinit const std::array<std::array<Bitboard, 64>, 64> lineSquares    = generateLineSquares();
+} // namespace chess_engine::pregenerated_moves
@@ -1,18 +1,36 @@
 #include "search.h"
 
+#include "nnue.h"
+#include "syzygy.h"
+#include "thread_pool.h"
+
 namespace chess_engine
 {
-Move Search::s_bestMove;
+Search::Search(ThreadPool& threadPool, const int threadId)
+    : m_threadPool(threadPool),
+      m_transpositionTable(threadPool.getTranspositionTable()),
+      m_threadId(threadId)
+{
+}
 
-int Search::search(Board& board, const int depth)
+int Search::search(Board& board)
 {
     resetSearchData();
 
+    // The network may have been loaded after the position was set up
+    board.refreshAccumulators();
+
     int score = 0, prevScore = 0;
-    PVLine line;
+
+    // Helper threads start from a different depth, so that the threads do not all search the same
+    // positions at the same time, and keep going until the main thread is done
+    const SearchLimits& limits = m_threadPool.getLimits();
+    const bool isMainThread    = m_threadId == 0;
+    const int startDepth       = isMainThread ? 1 : 1 + m_threadId % 2;
+    const int maxDepth         = isMainThread && limits.depth > 0 ? std::min(limits.depth, maxPly - 1) : maxPly - 1;
 
     // Iterative deepening
-    for (int currentDepth = 1; currentDepth <= depth; ++currentDepth)
+    for (int currentDepth = startDepth; currentDepth <= maxDepth && !isStopped(); ++currentDepth)
     {
         int alpha      = std::max(negativeInfinity, prevScore - aspirationWindowSize);
         int beta       = std::min(positiveInfinity, prevScore + aspirationWindowSize);
@@ -20,14 +38,20 @@ int Search::search(Board& board, const int depth)
 
         while (true)
         {
-            score = negamax(alpha, beta, board, line, currentDepth);
+            score = negamax(alpha, beta, board, currentDepth);
+
+            if (isStopped())
+            {
+                break;
+            }
 
-            if (score <= alpha)
+            // A bound of the full window is exact (e.g. when mated at the root): widening it would loop forever
+            if (score <= alpha && alpha > negativeInfinity)
             {
                 // Fail-low: widen the window and re-search
                 alpha = std::max(negativeInfinity, alpha - aspirationWindowSize * multiplier);
             }
-            else if (score >= beta)
+            else if (score >= beta && beta < positiveInfinity)
             {
                 // Fail-high: widen the window and re-search
                 beta = std::min(positiveInfinity, beta + aspirationWindowSize * multiplier);
@@ -39,81 +63,229 @@ int Search::search(Board& board, const int depth)
 
             multiplier *= 2; // Exponentially increase the window size
         }
-        prevScore = score;
+        // The result of an interrupted iteration is not reliable
+        if (isStopped())
+        {
+            break;
+        }
+
+        prevScore    = score;
+        // The root principal variation is the first row of the PV table (empty if mated or stalemated)
+        const int pvLength = m_pvLength[0];
+        m_bestMove         = pvLength > 0 ? m_pvTable[0][0] : Move();
+        m_ponderMove       = pvLength > 1 ? m_pvTable[0][1] : Move();
+        m_rootPV.assign(m_pvTable[0].begin(), m_pvTable[0].begin() + pvLength);
+        m_completedDepth   = currentDepth;
+
+        if (!isMainThread)
+        {
+            continue;
+        }
+
+        if constexpr (SearchStats::s_enabled)
+        {
+            m_stats.depthTimes.push_back(m_threadPool.getTimeManager().getElapsedTime());
+        }
+
+        if (m_threadPool.isSilent())
+        {
+            continue;
+        }
 
         // Build the principal variation string
         std::string pvString;
-        for (int i = 0; i < line.length && i < currentDepth; ++i)
+        for (const Move& move: m_rootPV)
         {
-            pvString += line.moves[i].toString() + " ";
+            pvString += move.toString() + " ";
         }
-        std::println("info depth {} score cp {} nodes {} pv {}",
+        const uint64_t nodes = m_threadPool.getTotalNodes();
+        const int64_t time   = m_threadPool.getTimeManager().getElapsedTime();
+        std::println("info depth {} score cp {} nodes {} nps {} time {} hashfull {} tbhits {} pv {}",
                      currentDepth,
                      score,
-                     s_nodes,
+                     nodes,
+                     nodes * 1000 / static_cast<uint64_t>(std::max<int64_t>(time, 1)),
+                     time,
+                     m_transpositionTable.hashfull(),
+                     m_threadPool.getTotalTBHits(),
                      pvString);
+
+        // Do not start an iteration that is unlikely to finish before the hard limit
+        if (m_threadPool.getTimeManager().isSoftLimitReached())
+        {
+            break;
+        }
     }
 
-    s_bestMove = line.moves[0];
-    return score;
+    return prevScore;
+}
+
+Move Search::getBestMove() const
+{
+    return m_bestMove;
+}
+
+Move Search::getPonderMove() const
+{
+    return m_ponderMove;
 }
 
-int Search::negamax(int alpha, const int beta, Board& board, PVLine& pvLine, const int depth, const int ply)
+const std::vector<Move>& Search::getPrincipalVariation() const
+{
+    return m_rootPV;
+}
+
+int Search::getCompletedDepth() const
+{
+    return m_completedDepth;
+}
+
+uint64_t Search::getNodes() const
+{
+    return m_nodes.load(std::memory_order_relaxed);
+}
+
+uint64_t Search::getTBHits() const
+{
+    return m_tbHits.load(std::memory_order_relaxed);
+}
+
+const SearchStats& Search::getStats() const
+{
+    return m_stats;
+}
+
+int Search::negamax(int alpha, const int beta, Board& board, const int depth, const int ply)
 {
     int score;
-    PVLine line;
+
+    // Empty principal variation until a move raises alpha
+    m_pvLength[ply] = ply;
 
     // Base case: perform quiescence search
     if (depth == 0)
     {
-        pvLine.length = 0;
         return quiescence(alpha, beta, board, ply);
     }
 
     // Maximum ply reached
     if (ply >= maxPly)
     {
-        return Evaluate::evaluatePosition(board);
+        return evaluate(board);
+    }
+
+    if (isStopped())
+    {
+        return 0;
+    }
+
+    // Draw by repetition or by the fifty-move rule, checked before the transposition table whose scores do not
+    // depend on the path to the position (the root is searched anyway, to have a move to play)
+    if (ply > 0 && board.isDraw())
+    {
+        return 0;
+    }
+
+    // Transposition table lookup, done before generating the moves so that we can cut off early
+    const uint64_t hash   = board.getZobristHash();
+    const bool isPVNode   = beta - alpha > 1;
+    const int alphaOrigin = alpha;
+    uint16_t ttMove       = 0;
+    TTEntry ttEntry;
+
+    m_stats.add(&SearchStats::ttProbes);
+    if (m_transpositionTable.probe(hash, ttEntry))
+    {
+        m_stats.add(&SearchStats::ttHits);
+        ttMove = ttEntry.move;
+
+        // Only cut off in non-PV nodes, so that the principal variation is not truncated
+        if (ply > 0 && !isPVNode && ttEntry.depth >= depth)
+        {
+            const int ttScore = scoreFromTT(ttEntry.score, ply);
+
+            if ((ttEntry.bound == TTBound::Exact || ttEntry.bound == TTBound::LowerBound) && ttScore >= beta)
+            {
+                return beta;
+            }
+            if ((ttEntry.bound == TTBound::Exact || ttEntry.bound == TTBound::UpperBound) && ttScore <= alpha)
+            {
+                return alpha;
+            }
+            if (ttEntry.bound == TTBound::Exact)
+            {
+                return ttScore;
+            }
+        }
+    }
+
+    // Endgame tablebases: the result is known, cut off unless it is only a bound on the wrong side of the window
+    if (ply > 0 && syzygy::canProbe(board))
+    {
+        m_stats.add(&SearchStats::tbProbes);
+        if (const std::optional<syzygy::WDL> wdl = syzygy::probeWDL(board))
+        {
+            m_stats.add(&SearchStats::tbHits);
+            m_tbHits.store(m_tbHits.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+            // The cursed wins and blessed losses are draws with the fifty-move rule
+            const int tbScore   = *wdl == syzygy::WDL::Win ? tbWinScore - ply : *wdl == syzygy::WDL::Loss ? -tbWinScore + ply : 0;
+            const TTBound bound = *wdl == syzygy::WDL::Win ? TTBound::LowerBound : *wdl == syzygy::WDL::Loss ? TTBound::UpperBound : TTBound::Exact;
+            if (bound == TTBound::Exact || (bound == TTBound::LowerBound && tbScore >= beta) || (bound == TTBound::UpperBound && tbScore <= alpha))
+            {
+                m_transpositionTable.store(hash, std::min(depth + tbDepthBonus, maxPly - 1), scoreToTT(tbScore, ply), bound, Move());
+                return bound == TTBound::LowerBound ? beta : bound == TTBound::UpperBound ? alpha : tbScore;
+            }
+        }
     }
 
     bool hasLegalMoves  = false;
     const bool isCheck  = board.isCheck();
     const int extension = isCheck ? 1 : 0;
-    auto moves          = board.generateMoves();
     int movesSearched   = 0;
+    Move bestMove;
 
-    s_nodes++;
+    countNode();
+    m_stats.add(&SearchStats::nodes);
 
     // Null Move Pruning
-    if (canPrune(isCheck, depth, ply, pvLine.length))
+    if (canPrune(isCheck, depth, ply, isPVNode))
     {
-        Board nullMoveBoard = board;
-        nullMoveBoard.makeNullMove();
-        const int nullMoveScore = -negamax(-beta, -beta + 1, nullMoveBoard, line, depth - 1 - NullMovePruningReduction, ply + 1);
+        m_stats.add(&SearchStats::nullMoveSearches);
+        board.makeNullMove();
+        const int nullMoveScore = -negamax(-beta, -beta + 1, board, depth - 1 - NullMovePruningReduction, ply + 1);
+        board.unmakeNullMove();
+        if (isStopped())
+        {
+            return 0;
+        }
         if (nullMoveScore >= beta)
         {
+            m_stats.add(&SearchStats::nullMoveCutoffs);
             return beta; // Fail-hard beta cutoff
         }
     }
 
-    sortMoves(moves, ply, pvLine);
-    for (size_t moveIndex = 0; moveIndex < moves.size(); moveIndex++)
+    // The moves are generated lazily, so that a cutoff on the first moves saves generating the others
+    MovePicker movePicker(board, ttMove, m_killerMoves[ply], m_historyHeuristic);
+    const std::vector<Move>& rootMoves = m_threadPool.getRootMoves();
+    int moveIndex                      = 0;
+    for (Move move = movePicker.next(); !move.isNull(); move = movePicker.next(), moveIndex++)
     {
-        Move move      = moves[moveIndex];
-        Board newBoard = board;
-
-        if (const bool isValidMove = newBoard.makeMove(move); !isValidMove)
+        // At the root, only the moves keeping the tablebase result are searched, if the position is in the tablebases
+        if (ply == 0 && !rootMoves.empty() && std::ranges::find(rootMoves, move) == rootMoves.end())
         {
             continue;
         }
 
+        board.makeMove(move);
         hasLegalMoves = true;
 
         // First move is searched at full depth
         if (movesSearched == 0)
         {
             // Full window search for the first move
-            score = -negamax(-beta, -alpha, newBoard, line, depth - 1 + extension, ply + 1);
+            score = -negamax(-beta, -alpha, board, depth - 1 + extension, ply + 1);
         }
         // Apply Late Move Reduction (LMR) for subsequent moves
         else
@@ -121,7 +293,12 @@ int Search::negamax(int alpha, const int beta, Board& board, PVLine& pvLine, con
             if (canReduce(moveIndex, move, isCheck, depth, extension))
             {
                 // Reduced depth search for other moves (Late Move Reduction)
-                score = -negamax(-alpha - 1, -alpha, newBoard, line, depth - LMRReduction + extension, ply + 1);
+                m_stats.add(&SearchStats::lmrSearches);
+                score = -negamax(-alpha - 1, -alpha, board, depth - LMRReduction + extension, ply + 1);
+                if (score > alpha)
+                {
+                    m_stats.add(&SearchStats::lmrResearches);
+                }
             }
             else
             {
@@ -131,51 +308,59 @@ int Search::negamax(int alpha, const int beta, Board& board, PVLine& pvLine, con
             if (score > alpha)
             {
                 // Null window search for other moves
-                score = -negamax(-alpha - 1, -alpha, newBoard, line, depth - 1 + extension, ply + 1);
+                score = -negamax(-alpha - 1, -alpha, board, depth - 1 + extension, ply + 1);
 
                 if ((score > alpha) && (score < beta)) // Check for failure.
                 {
                     // Re-search with full window if null window search fails high
-                    score = -negamax(-beta, -alpha, newBoard, line, depth - 1 + extension, ply + 1);
+                    score = -negamax(-beta, -alpha, board, depth - 1 + extension, ply + 1);
                 }
             }
         }
 
-        newBoard = board;
+        board.unmakeMove(move);
         movesSearched++;
 
+        // The score of an interrupted search is not reliable, do not use it
+        if (isStopped())
+        {
+            return 0;
+        }
+
         // Beta-cutoff
         // If the opponent has found a move that is too good for us, prune the branch
         // No better move possible
         if (score >= beta)
         {
+            m_stats.add(&SearchStats::betaCutoffs);
+            if (movesSearched == 1)
+            {
+                m_stats.add(&SearchStats::firstMoveCutoffs);
+            }
+
             if (!move.isCapture())
             {
-                s_killerMoves[1][ply] = s_killerMoves[0][ply]; // Shift the previous killer move down
-                s_killerMoves[0][ply] = move;                  // Store the move as a killer move
+                m_killerMoves[ply][1] = m_killerMoves[ply][0]; // Shift the previous killer move down
+                m_killerMoves[ply][0] = move;                  // Store the move as a killer move
             }
+            m_transpositionTable.store(hash, depth, scoreToTT(beta, ply), TTBound::LowerBound, move);
             return beta;
         }
 
         // Found a better move, update alpha
         if (score > alpha)
         {
-            alpha = score;
+            alpha    = score;
+            bestMove = move;
 
             if (!move.isCapture())
             {
                 const int pieceIndex  = std::to_underlying(move.getPiece());
                 const int targetIndex = std::to_underlying(move.getTarget());
-                s_historyHeuristic[pieceIndex][targetIndex] += depth * depth;
+                m_historyHeuristic[pieceIndex][targetIndex] += depth * depth;
             }
 
-            // Update the principal variation line
-            pvLine.moves[0] = move;
-            for (int i = 0; i < line.length; ++i)
-            {
-                pvLine.moves[i + 1] = line.moves[i];
-            }
-            pvLine.length = line.length + 1;
+            updatePV(move, ply);
         }
     }
 
@@ -189,14 +374,22 @@ int Search::negamax(int alpha, const int beta, Board& board, PVLine& pvLine, con
         return 0; // Stalemate, return a neutral score
     }
 
+    // All the moves were searched: their number is the length of the move list
+    m_stats.add(&SearchStats::allNodes);
+    m_stats.add(&SearchStats::allNodesMoves, static_cast<uint64_t>(movesSearched));
+
+    const TTBound bound = alpha > alphaOrigin ? TTBound::Exact : TTBound::UpperBound;
+    m_transpositionTable.store(hash, depth, scoreToTT(alpha, ply), bound, bestMove);
+
     return alpha;
 }
 
 int Search::quiescence(int alpha, const int beta, Board& board, const int ply)
 {
-    s_nodes++;
+    countNode();
+    m_stats.add(&SearchStats::quiescenceNodes);
 
-    const int evaluation = Evaluate::evaluatePosition(board);
+    const int evaluation = evaluate(board);
 
     if (ply >= maxPly)
     {
@@ -213,26 +406,25 @@ int Search::quiescence(int alpha, const int beta, Board& board, const int ply)
         alpha = evaluation;
     }
 
-    auto moves = board.generateMoves();
-    sortMoves(moves, ply);
-
-    for (const Move move: moves)
+    // Only consider captures and promotions in quiescence search, without the ones losing material (see MovePicker)
+    MovePicker movePicker(board);
+    for (Move move = movePicker.next(); !move.isNull(); move = movePicker.next())
     {
-        // Only consider capture moves in quiescence search
-        if (!move.isCapture())
+        // Delta pruning: skip the captures that cannot raise alpha, even winning the captured piece with a margin
+        if (!move.isPromotion() && evaluation + Evaluate::s_piecesValues[std::to_underlying(move.getCapturedPiece())] + deltaPruningMargin <= alpha)
         {
             continue;
         }
 
-        Board newBoard = board;
+        board.makeMove(move);
+        const int score = -quiescence(-beta, -alpha, board, ply + 1);
+        board.unmakeMove(move);
 
-        if (const bool isValidMove = newBoard.makeMove(move); !isValidMove)
+        if (isStopped())
         {
-            continue;
+            return 0;
         }
 
-        const int score = -quiescence(-beta, -alpha, newBoard, ply + 1);
-
         if (score >= beta)
         {
             return beta;
@@ -247,29 +439,76 @@ int Search::quiescence(int alpha, const int beta, Board& board, const int ply)
     return alpha;
 }
 
-void Search::sortMoves(std::vector<Move>& moves, const int ply, const PVLine& pvLine)
+int Search::evaluate(const Board& board)
 {
-    // Sort the moves based on their score
-    std::sort(moves.begin(), moves.end(), [ply, &pvLine](const Move& a, const Move& b)
+    m_stats.add(&SearchStats::evalCalls);
+    if (nnue::isLoaded())
     {
-        const bool aIsPV = pvLine.length > 0 && ply < pvLine.length && pvLine.moves[ply] == a;
-        const bool bIsPV = pvLine.length > 0 && ply < pvLine.length && pvLine.moves[ply] == b;
-        return a.calculateScore(ply, aIsPV) > b.calculateScore(ply, bIsPV);
-    });
+        return nnue::evaluate(board.getAccumulator(), board.getSideToMove());
+    }
+    return Evaluate::evaluatePosition(board, m_pawnHashTable);
+}
+
+int Search::scoreToTT(const int score, const int ply)
+{
+    if (score >= tbThreshold)
+    {
+        return score + ply;
+    }
+    if (score <= -tbThreshold)
+    {
+        return score - ply;
+    }
+    return score;
+}
+
+int Search::scoreFromTT(const int score, const int ply)
+{
+    if (score >= tbThreshold)
+    {
+        return score - ply;
+    }
+    if (score <= -tbThreshold)
+    {
+        return score + ply;
+    }
+    return score;
 }
 
 void Search::resetSearchData()
 {
-    s_nodes = 0;
+    m_nodes  = 0;
+    m_tbHits = 0;
+    m_stats  = SearchStats();
 
-    s_bestMove = Move();
+    m_bestMove   = Move();
+    m_ponderMove = Move();
+    m_rootPV.clear();
+    m_completedDepth = 0;
 
-    for (auto& km: s_killerMoves)
+    for (auto& km: m_killerMoves)
         std::ranges::fill(km, Move());
-    for (auto& hh: s_historyHeuristic)
+    for (auto& hh: m_historyHeuristic)
         std::ranges::fill(hh, 0);
 }
 
+void Search::countNode()
+{
+    // Only this thread writes its counter, other threads just read it
+    const uint64_t nodes = m_nodes.load(std::memory_order_relaxed) + 1;
+    m_nodes.store(nodes, std::memory_order_relaxed);
+
+    if (m_threadId == 0 && nodes % limitsCheckInterval == 0)
+    {
+        m_threadPool.checkLimits();
+    }
+}
+
+bool Search::isStopped() const
+{
+    return m_threadPool.isStopped();
+}
+
 bool Search::canReduce(const int moveIndex, const Move& move, const bool isCheck, const int depth, const int extension)
 {
     return moveIndex > lateMoveReductionThreshold &&
@@ -280,12 +519,23 @@ bool Search::canReduce(const int moveIndex, const Move& move, const bool isCheck
            extension == 0;
 }
 
-bool Search::canPrune(const bool isCheck, const int depth, const int ply, const int pvLineLength)
+bool Search::canPrune(const bool isCheck, const int depth, const int ply, const bool isPVNode)
 {
     // TODO: Need to check for zugzwang positions; could also avoid pruning in endgames in general
     return !isCheck &&
            depth >= NullMovePruningReduction + 1 &&
            ply != 0 &&
-           pvLineLength == 0;
+           !isPVNode;
+}
+
+void Search::updatePV(const Move& move, const int ply)
+{
+    // The row of the node is the move, followed by the row of the child (which starts at ply + 1)
+    m_pvTable[ply][ply] = move;
+    for (int i = ply + 1; i < m_pvLength[ply + 1]; ++i)
+    {
+        m_pvTable[ply][i] = m_pvTable[ply + 1][i];
+    }
+    m_pvLength[ply] = m_pvLength[ply + 1];
 }
 } // namespace chess_engine
\ No newline at end of file
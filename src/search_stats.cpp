@@ -0,0 +1,65 @@
+#include "search_stats.h"
+
+#include <format>
+
+namespace chess_engine
+{
+namespace
+{
+/**
+ * @brief Get a ratio as a percentage, 0 if the total is 0.
+ */
+double percentage(const uint64_t part, const uint64_t total)
+{
+    return total == 0 ? 0.0 : 100.0 * static_cast<double>(part) / static_cast<double>(total);
+}
+} // namespace
+
+SearchStats& SearchStats::operator+=(const SearchStats& other)
+{
+    nodes += other.nodes;
+    quiescenceNodes += other.quiescenceNodes;
+    evalCalls += other.evalCalls;
+    ttProbes += other.ttProbes;
+    ttHits += other.ttHits;
+    tbProbes += other.tbProbes;
+    tbHits += other.tbHits;
+    betaCutoffs += other.betaCutoffs;
+    firstMoveCutoffs += other.firstMoveCutoffs;
+    nullMoveSearches += other.nullMoveSearches;
+    nullMoveCutoffs += other.nullMoveCutoffs;
+    lmrSearches += other.lmrSearches;
+    lmrResearches += other.lmrResearches;
+    allNodes += other.allNodes;
+    allNodesMoves += other.allNodesMoves;
+    if (depthTimes.empty())
+    {
+        depthTimes = other.depthTimes;
+    }
+    return *this;
+}
+
+std::string SearchStats::toString() const
+{
+    std::string result;
+    result += std::format("info string stats nodes {} qnodes {} ({:.1f}%) evals {}\n",
+                          nodes, quiescenceNodes, percentage(quiescenceNodes, nodes + quiescenceNodes), evalCalls);
+    result += std::format("info string stats tthits {}/{} ({:.1f}%) tbhits {}/{} cutoffs {} firstmove {} ({:.1f}%)\n",
+                          ttHits, ttProbes, percentage(ttHits, ttProbes), tbHits, tbProbes,
+                          betaCutoffs, firstMoveCutoffs, percentage(firstMoveCutoffs, betaCutoffs));
+    result += std::format("info string stats nullmove {}/{} ({:.1f}%) lmr researches {}/{} ({:.1f}%) movelist {:.1f}\n",
+                          nullMoveCutoffs, nullMoveSearches, percentage(nullMoveCutoffs, nullMoveSearches),
+                          lmrResearches, lmrSearches, percentage(lmrResearches, lmrSearches),
+                          allNodes == 0 ? 0.0 : static_cast<double>(allNodesMoves) / static_cast<double>(allNodes));
+
+    // Time spent on each depth, not since the start of the search
+    result += "info string stats depth times (ms)";
+    for (size_t depth = 0; depth < depthTimes.size(); depth++)
+    {
+        result += std::format(" {}:{}", depth + 1, depthTimes[depth] - (depth == 0 ? 0 : depthTimes[depth - 1]));
+    }
+    result += '\n';
+
+    return result;
+}
+} // namespace chess_engine
@@ -0,0 +1,187 @@
+#include "syzygy.h"
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <utility>
+
+#ifdef USE_SYZYGY
+#include "tbprobe.h"
+#endif
+
+namespace chess_engine::syzygy
+{
+#ifdef USE_SYZYGY
+namespace
+{
+static_assert(TB_LOSS == std::to_underlying(WDL::Loss) && TB_BLESSED_LOSS == std::to_underlying(WDL::BlessedLoss) &&
+                      TB_DRAW == std::to_underlying(WDL::Draw) && TB_CURSED_WIN == std::to_underlying(WDL::CursedWin) &&
+                      TB_WIN == std::to_underlying(WDL::Win),
+              "The results of Fathom are the values of WDL");
+
+/**
+ * @brief The pieces of a position, in the format of Fathom.
+ */
+struct FathomPosition
+{
+    uint64_t white;   //< White pieces
+    uint64_t black;   //< Black pieces
+    uint64_t kings;   //< Kings of both sides
+    uint64_t queens;  //< Queens of both sides
+    uint64_t rooks;   //< Rooks of both sides
+    uint64_t bishops; //< Bishops of both sides
+    uint64_t knights; //< Knights of both sides
+    uint64_t pawns;   //< Pawns of both sides
+    unsigned ep;      //< En passant square (0 if none)
+    bool turn;        //< True if White is to move
+};
+
+/**
+ * @brief Convert a square to the numbering of Fathom, from a1 (the board numbers the squares from a8).
+ */
+[[nodiscard]] constexpr unsigned toFathom(const Square square)
+{
+    return static_cast<unsigned>(std::to_underlying(square) ^ 56);
+}
+
+/**
+ * @brief Convert a bitboard to the numbering of Fathom, by flipping its ranks.
+ */
+[[nodiscard]] uint64_t toFathom(const Bitboard bitboard)
+{
+    return std::byteswap(bitboard.getBitboard());
+}
+
+/**
+ * @brief Get the pieces of a position in the format of Fathom.
+ */
+[[nodiscard]] FathomPosition toFathom(const Board& board)
+{
+    const auto getPieces = [&board](const PieceWithColor white, const PieceWithColor black)
+    {
+        return toFathom(board.getBitboardForPiece(white) | board.getBitboardForPiece(black));
+    };
+
+    const Square enPassantSquare = board.getEnPassantSquare();
+    return {
+            .white   = toFathom(board.getOccupancyForSide(White)),
+            .black   = toFathom(board.getOccupancyForSide(Black)),
+            .kings   = getPieces(WhiteKing, BlackKing),
+            .queens  = getPieces(WhiteQueen, BlackQueen),
+            .rooks   = getPieces(WhiteRook, BlackRook),
+            .bishops = getPieces(WhiteBishop, BlackBishop),
+            .knights = getPieces(WhiteKnight, BlackKnight),
+            .pawns   = getPieces(WhitePawn, BlackPawn),
+            .ep      = enPassantSquare == Square::INVALID ? 0 : toFathom(enPassantSquare),
+            .turn    = board.getSideToMove() == White,
+    };
+}
+
+/**
+ * @brief Check if a move is the one of a result of tb_probe_root.
+ */
+[[nodiscard]] bool isSameMove(const Move& move, const unsigned result)
+{
+    // Indexed by TB_PROMOTES_NONE, TB_PROMOTES_QUEEN, TB_PROMOTES_ROOK, TB_PROMOTES_BISHOP and TB_PROMOTES_KNIGHT
+    constexpr std::array<Piece, 5> promotions = {Pawn, Queen, Rook, Bishop, Knight};
+
+    const unsigned promotes = TB_GET_PROMOTES(result);
+    if (toFathom(move.getSource()) != TB_GET_FROM(result) || toFathom(move.getTarget()) != TB_GET_TO(result) ||
+        move.isPromotion() != (promotes != TB_PROMOTES_NONE))
+    {
+        return false;
+    }
+    return !move.isPromotion() || pieceFromPieceWithColor(move.getPromotedPiece()) == promotions[promotes];
+}
+} // namespace
+
+bool init(const std::string& path)
+{
+    // An empty path unloads the tables
+    return tb_init(path == "<empty>" ? "" : path.c_str()) && TB_LARGEST > 0;
+}
+
+int getMaxPieces()
+{
+    return static_cast<int>(TB_LARGEST);
+}
+
+std::optional<WDL> probeWDL(const Board& board)
+{
+    const FathomPosition position = toFathom(board);
+    const unsigned result         = tb_probe_wdl(position.white, position.black, position.kings, position.queens, position.rooks, position.bishops,
+                                                 position.knights, position.pawns, 0, 0, position.ep, position.turn);
+    if (result == TB_RESULT_FAILED)
+    {
+        return std::nullopt;
+    }
+    return static_cast<WDL>(result);
+}
+
+std::vector<Move> getRootMoves(const Board& board)
+{
+    if (board.getCastlingRights() != CastlingRights::None || board.getOccupancyForSide(WhiteAndBlack).getNumberOfBitsSet() > getMaxPieces())
+    {
+        return {};
+    }
+
+    // The result of the position, then the result of each move, terminated by TB_RESULT_FAILED
+    const FathomPosition position = toFathom(board);
+    std::array<unsigned, TB_MAX_MOVES> results;
+    const unsigned result = tb_probe_root(position.white, position.black, position.kings, position.queens, position.rooks, position.bishops,
+                                          position.knights, position.pawns, static_cast<unsigned>(board.getHalfMoveClock()), 0, position.ep,
+                                          position.turn, results.data());
+    if (result == TB_RESULT_FAILED || result == TB_RESULT_CHECKMATE || result == TB_RESULT_STALEMATE)
+    {
+        return {};
+    }
+
+    const MoveList moves = board.generateMoves();
+    std::vector<Move> rootMoves;
+    for (size_t index = 0; index < results.size() && results[index] != TB_RESULT_FAILED; index++)
+    {
+        if (TB_GET_WDL(results[index]) != TB_GET_WDL(result))
+        {
+            continue;
+        }
+
+        for (const Move& move: moves)
+        {
+            if (isSameMove(move, results[index]))
+            {
+                rootMoves.push_back(move);
+                break;
+            }
+        }
+    }
+    return rootMoves;
+}
+#else
+bool init(const std::string&)
+{
+    return false;
+}
+
+int getMaxPieces()
+{
+    return 0;
+}
+
+std::optional<WDL> probeWDL(const Board&)
+{
+    return std::nullopt;
+}
+
+std::vector<Move> getRootMoves(const Board&)
+{
+    return {};
+}
+#endif
+
+bool canProbe(const Board& board)
+{
+    return board.getHalfMoveClock() == 0 &&
+           board.getCastlingRights() == CastlingRights::None &&
+           board.getOccupancyForSide(WhiteAndBlack).getNumberOfBitsSet() <= getMaxPieces();
+}
+} // namespace chess_engine::syzygy
@@ -0,0 +1,271 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <print>
+
+#include "syzygy.h"
+
+namespace chess_engine
+{
+ThreadPool::ThreadPool()
+    : m_stop(false)
+{
+    setNumberOfThreads(1);
+}
+
+ThreadPool::~ThreadPool()
+{
+    stop();
+    waitForSearchFinished();
+}
+
+void ThreadPool::setNumberOfThreads(int numberOfThreads)
+{
+    numberOfThreads = std::clamp(numberOfThreads, 1, s_maxThreads);
+
+    m_threads.clear();
+    for (int threadId = 0; threadId < numberOfThreads; threadId++)
+    {
+        m_threads.push_back(std::make_unique<Search>(*this, threadId));
+    }
+
+    // The table is initialized by the same number of threads, to spread its pages over them
+    m_transpositionTable.setNumberOfThreads(numberOfThreads);
+}
+
+int ThreadPool::getNumberOfThreads() const
+{
+    return static_cast<int>(m_threads.size());
+}
+
+void ThreadPool::setSilent(const bool isSilent)
+{
+    m_isSilent = isSilent;
+}
+
+bool ThreadPool::isSilent() const
+{
+    return m_isSilent;
+}
+
+int ThreadPool::search(const Board& board, const SearchLimits& limits)
+{
+    prepareSearch(board, limits);
+    return runSearch(board);
+}
+
+void ThreadPool::startSearch(const Board& board, const SearchLimits& limits)
+{
+    waitForSearchFinished();
+
+    // Prepare the search here, so that a "stop" received right after "go" is not lost
+    prepareSearch(board, limits);
+    m_isSearching  = true;
+    m_searchThread = std::thread([this, board]()
+    {
+        runSearch(board);
+        if constexpr (SearchStats::s_enabled)
+        {
+            std::print("{}", getStats().toString());
+        }
+        printBestMove(board);
+        m_isSearching = false;
+    });
+}
+
+void ThreadPool::prepareSearch(const Board& board, const SearchLimits& limits)
+{
+    m_stop      = false;
+    m_limits    = limits;
+    m_rootMoves = syzygy::getRootMoves(board); // Probed here: the DTZ probe is not thread-safe
+    m_timeManager.start(limits, board.getSideToMove());
+    m_transpositionTable.newSearch();
+}
+
+int ThreadPool::runSearch(const Board& board)
+{
+    // Start the helper threads, each one searching its own copy of the board
+    std::vector<std::thread> helpers;
+    for (size_t threadId = 1; threadId < m_threads.size(); threadId++)
+    {
+        helpers.emplace_back([this, threadId, threadBoard = board]() mutable
+        {
+            m_threads[threadId]->search(threadBoard);
+        });
+    }
+
+    // The main thread searches on the calling thread
+    Board mainBoard = board;
+    const int score = m_threads[0]->search(mainBoard);
+
+    // The best move must not be reported before "stop" in infinite mode, or before "ponderhit" when pondering
+    {
+        std::unique_lock lock(m_mutex);
+        m_condition.wait(lock, [this]()
+        {
+            return m_stop || (!m_limits.infinite && !m_timeManager.isPondering());
+        });
+    }
+
+    // The main thread is done: stop the helpers
+    m_stop = true;
+    for (std::thread& helper: helpers)
+    {
+        helper.join();
+    }
+
+    if constexpr (SearchStats::s_enabled)
+    {
+        SearchStats stats;
+        for (const std::unique_ptr<Search>& thread: m_threads)
+        {
+            stats += thread->getStats();
+        }
+
+        std::lock_guard lock(m_mutex);
+        m_stats = std::move(stats);
+    }
+
+    return score;
+}
+
+void ThreadPool::waitForSearchFinished()
+{
+    if (m_searchThread.joinable())
+    {
+        m_searchThread.join();
+    }
+}
+
+void ThreadPool::stop()
+{
+    {
+        std::lock_guard lock(m_mutex);
+        m_stop = true;
+    }
+    m_condition.notify_all();
+}
+
+void ThreadPool::ponderhit()
+{
+    {
+        std::lock_guard lock(m_mutex);
+        m_timeManager.ponderhit();
+    }
+    m_condition.notify_all();
+}
+
+void ThreadPool::checkLimits()
+{
+    if (m_timeManager.isHardLimitReached() || (m_limits.nodes > 0 && getTotalNodes() >= m_limits.nodes))
+    {
+        stop();
+    }
+}
+
+Move ThreadPool::getBestMove() const
+{
+    return m_threads[0]->getBestMove();
+}
+
+Move ThreadPool::getPonderMove() const
+{
+    return m_threads[0]->getPonderMove();
+}
+
+const std::vector<Move>& ThreadPool::getPrincipalVariation() const
+{
+    return m_threads[0]->getPrincipalVariation();
+}
+
+int ThreadPool::getCompletedDepth() const
+{
+    return m_threads[0]->getCompletedDepth();
+}
+
+uint64_t ThreadPool::getTotalNodes() const
+{
+    uint64_t nodes = 0;
+    for (const auto& thread: m_threads)
+    {
+        nodes += thread->getNodes();
+    }
+    return nodes;
+}
+
+uint64_t ThreadPool::getTotalTBHits() const
+{
+    uint64_t tbHits = 0;
+    for (const auto& thread: m_threads)
+    {
+        tbHits += thread->getTBHits();
+    }
+    return tbHits;
+}
+
+const std::vector<Move>& ThreadPool::getRootMoves() const
+{
+    return m_rootMoves;
+}
+
+bool ThreadPool::isStopped() const
+{
+    return m_stop.load(std::memory_order_relaxed);
+}
+
+TranspositionTable& ThreadPool::getTranspositionTable()
+{
+    return m_transpositionTable;
+}
+
+const SearchLimits& ThreadPool::getLimits() const
+{
+    return m_limits;
+}
+
+bool ThreadPool::isSearching() const
+{
+    return m_isSearching;
+}
+
+SearchStats ThreadPool::getStats()
+{
+    std::lock_guard lock(m_mutex);
+    return m_stats;
+}
+
+const TimeManager& ThreadPool::getTimeManager() const
+{
+    return m_timeManager;
+}
+
+void ThreadPool::printBestMove(const Board& board) const
+{
+    Move bestMove = getBestMove();
+
+    // The search was stopped before the first iteration completed: play any legal move
+    if (bestMove.isNull())
+    {
+        if (const MoveList moves = board.generateMoves(); !moves.empty())
+        {
+            bestMove = moves[0];
+        }
+    }
+
+    if (bestMove.isNull())
+    {
+        std::println("bestmove 0000"); // No legal moves: checkmate or stalemate
+        return;
+    }
+
+    const Move ponderMove = getPonderMove();
+    if (!ponderMove.isNull())
+    {
+        std::println("bestmove {} ponder {}", bestMove.toString(), ponderMove.toString());
+    }
+    else
+    {
+        std::println("bestmove {}", bestMove.toString());
+    }
+}
+} // namespace chess_engine
\ No newline at end of file
@@ -0,0 +1,86 @@
+#include "time_manager.h"
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+namespace chess_engine
+{
+bool SearchLimits::isTimeManaged(const Side side) const
+{
+    return !infinite && (moveTime > 0 || time[std::to_underlying(side)] > 0);
+}
+
+void TimeManager::start(const SearchLimits& limits, const Side side)
+{
+    m_startTime     = now();
+    m_isPondering   = limits.ponder;
+    m_isTimeManaged = limits.isTimeManaged(side);
+    m_softLimit     = 0;
+    m_hardLimit     = 0;
+
+    if (!m_isTimeManaged)
+    {
+        return;
+    }
+
+    // Fixed time per move: use all of it
+    if (limits.moveTime > 0)
+    {
+        m_softLimit = std::max<int64_t>(1, limits.moveTime - s_moveOverhead);
+        m_hardLimit = m_softLimit;
+        return;
+    }
+
+    const int64_t time      = limits.time[std::to_underlying(side)];
+    const int64_t increment = limits.increment[std::to_underlying(side)];
+    const int movesToGo     = limits.movesToGo > 0 ? limits.movesToGo : s_defaultMovesToGo;
+    const int64_t available = std::max<int64_t>(1, time - s_moveOverhead);
+    const int64_t optimum   = available / movesToGo + increment * 3 / 4;
+
+    // Spread the remaining time over the moves to go, and never risk more than a fraction of the clock
+    m_hardLimit = std::clamp<int64_t>(optimum * s_hardLimitMultiplier, 1, std::max<int64_t>(1, available * 3 / 4));
+    m_softLimit = std::clamp<int64_t>(optimum, 1, m_hardLimit);
+}
+
+void TimeManager::ponderhit()
+{
+    m_startTime   = now();
+    m_isPondering = false;
+}
+
+int64_t TimeManager::getElapsedTime() const
+{
+    return now() - m_startTime;
+}
+
+bool TimeManager::isSoftLimitReached() const
+{
+    return m_isTimeManaged && !m_isPondering && getElapsedTime() >= m_softLimit;
+}
+
+bool TimeManager::isHardLimitReached() const
+{
+    return m_isTimeManaged && !m_isPondering && getElapsedTime() >= m_hardLimit;
+}
+
+bool TimeManager::isPondering() const
+{
+    return m_isPondering;
+}
+
+int64_t TimeManager::getSoftLimit() const
+{
+    return m_softLimit;
+}
+
+int64_t TimeManager::getHardLimit() const
+{
+    return m_hardLimit;
+}
+
+int64_t TimeManager::now()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+} // namespace chess_engine
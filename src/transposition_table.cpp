@@ -0,0 +1,445 @@
+#include "transposition_table.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <new>
+#include <random>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "zobrist.h"
+
+namespace chess_engine
+{
+namespace
+{
+constexpr std::array<char, 8> s_magic = {'C', 'E', 'T', 'T', 'H', 'A', 'S', 'H'}; //< Magic of the transposition table files
+
+/**
+ * @brief Header of a transposition table file.
+ */
+struct FileHeader
+{
+    std::array<char, 8> magic       = s_magic; //< Magic of the file
+    uint32_t version                = 0;       //< Version of the file format
+    uint32_t bucketSize             = 0;       //< Number of entries of a bucket
+    uint64_t keysSignature          = 0;       //< Signature of the Zobrist keys (see zobrist::getKeysSignature)
+    uint64_t numberOfBuckets        = 0;       //< Number of buckets of the table
+    uint8_t generation              = 0;       //< Search generation of the table
+    std::array<uint8_t, 31> padding = {};      //< Zeros up to 64 bytes, so that the buckets are aligned
+};
+
+static_assert(sizeof(FileHeader) == 64, "The header of the transposition table files must be 64 bytes");
+
+/**
+ * @brief Map a file in memory, copy-on-write: the pages written to are private to the process, the file is not modified.
+ *
+ * @param path The path of the file.
+ * @param size Set to the size of the file.
+ * @return The mapped file, or nullptr on error.
+ */
+void* mapFile(const std::string& path, size_t& size)
+{
+#if defined(_WIN32)
+    const HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return nullptr;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+    {
+        CloseHandle(file);
+        return nullptr;
+    }
+    size = static_cast<size_t>(fileSize.QuadPart);
+
+    // The view keeps the mapping and the file open
+    const HANDLE mappingHandle = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (mappingHandle == nullptr)
+    {
+        return nullptr;
+    }
+
+    void* mapping = MapViewOfFile(mappingHandle, FILE_MAP_COPY, 0, 0, 0);
+    CloseHandle(mappingHandle);
+    return mapping;
+#else
+    const int file = open(path.c_str(), O_RDONLY);
+    if (file == -1)
+    {
+        return nullptr;
+    }
+
+    struct stat fileStat;
+    if (fstat(file, &fileStat) == -1 || fileStat.st_size == 0)
+    {
+        close(file);
+        return nullptr;
+    }
+    size = static_cast<size_t>(fileStat.st_size);
+
+    // Private mapping: the pages not written to are shared by all the processes mapping the same file
+    void* mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+    close(file);
+    return mapping == MAP_FAILED ? nullptr : mapping;
+#endif
+}
+
+/**
+ * @brief Unmap a file mapped with mapFile.
+ *
+ * @param mapping The mapped file.
+ * @param size The size of the file.
+ */
+void unmapFile(void* mapping, [[maybe_unused]] const size_t size)
+{
+#if defined(_WIN32)
+    UnmapViewOfFile(mapping);
+#else
+    munmap(mapping, size);
+#endif
+}
+} // namespace
+
+void TranspositionTable::BucketsDeleter::operator()(Bucket* buckets) const
+{
+    if (mapping != nullptr)
+    {
+        unmapFile(mapping, size);
+    }
+    else
+    {
+        large_pages::deallocate(buckets, size, pageKind);
+    }
+}
+
+TranspositionTable::TranspositionTable()
+    : TranspositionTable(s_defaultSizeInMB)
+{
+}
+
+TranspositionTable::TranspositionTable(const size_t sizeInMB)
+    : m_buckets(nullptr, BucketsDeleter{nullptr, 0, large_pages::PageKind::Normal}),
+      m_numberOfBuckets(0),
+      m_mask(0),
+      m_generation(0),
+      m_numberOfThreads(1)
+{
+    resize(sizeInMB);
+}
+
+bool TranspositionTable::resize(size_t sizeInMB)
+{
+    sizeInMB = std::clamp<size_t>(sizeInMB, 1, s_maxSizeInMB);
+
+    // Round the number of buckets down to a power of two, so that the index can be computed with a mask
+    const size_t minNumberOfBuckets = 1024 * 1024 / sizeof(Bucket);
+    const size_t requestedBuckets   = std::bit_floor(sizeInMB * 1024 * 1024 / sizeof(Bucket));
+    size_t numberOfBuckets          = requestedBuckets;
+
+    // Free the old table first, so that both tables are never allocated at the same time
+    m_buckets.reset();
+
+    // Halve the size until the allocation succeeds
+    large_pages::PageKind pageKind;
+    Bucket* buckets = nullptr;
+    while ((buckets = static_cast<Bucket*>(large_pages::allocate(numberOfBuckets * sizeof(Bucket), pageKind))) == nullptr)
+    {
+        if (numberOfBuckets <= minNumberOfBuckets)
+        {
+            throw std::bad_alloc(); // Not even 1 MB is available
+        }
+        numberOfBuckets /= 2;
+    }
+
+    const size_t size = numberOfBuckets * sizeof(Bucket);
+    m_buckets         = std::unique_ptr<Bucket[], BucketsDeleter>(buckets, BucketsDeleter{nullptr, size, pageKind});
+    m_numberOfBuckets = numberOfBuckets;
+    m_mask            = m_numberOfBuckets - 1;
+    m_generation      = 0;
+
+    // The memory is first written to here, by the threads of the search (see forEachSlice)
+    forEachSlice([buckets](const size_t begin, const size_t end)
+    {
+        std::uninitialized_value_construct(buckets + begin, buckets + end);
+    });
+    return numberOfBuckets == requestedBuckets;
+}
+
+void TranspositionTable::setNumberOfThreads(const int numberOfThreads)
+{
+    if (numberOfThreads == m_numberOfThreads)
+    {
+        return;
+    }
+
+    m_numberOfThreads = numberOfThreads;
+    if (m_buckets.get_deleter().mapping == nullptr)
+    {
+        resize(getSizeInMB());
+    }
+}
+
+void TranspositionTable::clear()
+{
+    forEachSlice([this](const size_t begin, const size_t end)
+    {
+        for (size_t i = begin; i < end; i++)
+        {
+            for (PackedEntry& entry: m_buckets[i].entries)
+            {
+                entry.keyXorData.store(0, std::memory_order_relaxed);
+                entry.data.store(0, std::memory_order_relaxed);
+            }
+        }
+    });
+    m_generation = 0;
+}
+
+void TranspositionTable::forEachSlice(const std::function<void(size_t, size_t)>& function)
+{
+    // Slices of whole huge pages, so that each page is placed on the NUMA node of a single thread
+    constexpr size_t bucketsPerPage = large_pages::HUGE_PAGE_SIZE / sizeof(Bucket);
+    const size_t numberOfSlices     = std::clamp<size_t>(m_numberOfThreads, 1, std::max<size_t>(m_numberOfBuckets / bucketsPerPage, 1));
+    const size_t bucketsPerSlice    = (m_numberOfBuckets + numberOfSlices - 1) / numberOfSlices;
+    const size_t sliceSize          = (bucketsPerSlice + bucketsPerPage - 1) / bucketsPerPage * bucketsPerPage;
+
+    std::vector<std::jthread> threads;
+    for (size_t slice = 1; slice < numberOfSlices; slice++)
+    {
+        threads.emplace_back([&function, slice, sliceSize, this]()
+        {
+            function(std::min(slice * sliceSize, m_numberOfBuckets), std::min((slice + 1) * sliceSize, m_numberOfBuckets));
+        });
+    }
+    function(0, std::min(sliceSize, m_numberOfBuckets));
+}
+
+void TranspositionTable::newSearch()
+{
+    m_generation = (m_generation + 1) & s_generationMask;
+}
+
+bool TranspositionTable::probe(const uint64_t key, TTEntry& entry) const
+{
+    const Bucket& bucket = m_buckets[key & m_mask];
+
+    for (const PackedEntry& candidate: bucket.entries)
+    {
+        const uint64_t data = candidate.data.load(std::memory_order_relaxed);
+
+        // If another thread wrote the entry in the meantime, the key does not match anymore
+        if ((candidate.keyXorData.load(std::memory_order_relaxed) ^ data) == key && data != 0)
+        {
+            entry = unpackData(key, data);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void TranspositionTable::store(const uint64_t key, const int depth, const int score, const TTBound bound, const Move& move)
+{
+    Bucket& bucket       = m_buckets[key & m_mask];
+    PackedEntry* replace = &bucket.entries[0];
+    TTEntry replaced;
+    int replaceValue = std::numeric_limits<int>::max();
+
+    for (PackedEntry& candidate: bucket.entries)
+    {
+        const uint64_t data     = candidate.data.load(std::memory_order_relaxed);
+        const uint64_t entryKey = candidate.keyXorData.load(std::memory_order_relaxed) ^ data;
+        const TTEntry entry     = unpackData(entryKey, data);
+
+        // Same position: always overwrite it
+        if (entryKey == key)
+        {
+            replace  = &candidate;
+            replaced = entry;
+            break;
+        }
+
+        // Otherwise replace the shallowest entry, considering entries from older searches as less valuable
+        const int age   = (m_generation - entry.generation) & s_generationMask;
+        const int value = entry.bound == TTBound::None ? std::numeric_limits<int>::min() : entry.depth - 8 * age;
+        if (value < replaceValue)
+        {
+            replace      = &candidate;
+            replaced     = entry;
+            replaceValue = value;
+        }
+    }
+
+    TTEntry entry;
+    entry.key        = key;
+    entry.score      = score;
+    entry.move       = packMove(move);
+    entry.depth      = static_cast<uint8_t>(std::clamp(depth, 0, 255));
+    entry.bound      = bound;
+    entry.generation = m_generation;
+
+    // Keep the old best move if we don't know a better one for the same position
+    if (entry.move == 0 && replaced.key == key)
+    {
+        entry.move = replaced.move;
+    }
+
+    const uint64_t data = packData(entry);
+    replace->keyXorData.store(key ^ data, std::memory_order_relaxed);
+    replace->data.store(data, std::memory_order_relaxed);
+}
+
+bool TranspositionTable::save(const std::string& path) const
+{
+    FileHeader header;
+    header.version         = s_fileVersion;
+    header.bucketSize      = s_bucketSize;
+    header.keysSignature   = zobrist::getKeysSignature();
+    header.numberOfBuckets = m_numberOfBuckets;
+    header.generation      = m_generation;
+
+    // Unique temporary name, in case several processes save the same file at the same time
+    const std::string temporaryPath = std::format("{}.{:08x}.tmp", path, std::random_device()());
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(m_buckets.get()), static_cast<std::streamsize>(m_numberOfBuckets * sizeof(Bucket)));
+        file.close();
+
+        if (!file)
+        {
+            std::error_code error;
+            std::filesystem::remove(temporaryPath, error);
+            return false;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporaryPath, path, error);
+    if (error)
+    {
+        std::filesystem::remove(temporaryPath, error);
+        return false;
+    }
+    return true;
+}
+
+bool TranspositionTable::load(const std::string& path)
+{
+    size_t size   = 0;
+    void* mapping = mapFile(path, size);
+    if (mapping == nullptr)
+    {
+        return false;
+    }
+
+    FileHeader header;
+    if (size >= sizeof(header))
+    {
+        std::memcpy(&header, mapping, sizeof(header));
+    }
+
+    const bool isValid = size >= sizeof(header) &&
+                         header.magic == s_magic &&
+                         header.version == s_fileVersion &&
+                         header.bucketSize == s_bucketSize &&
+                         header.keysSignature == zobrist::getKeysSignature() &&
+                         std::has_single_bit(header.numberOfBuckets) &&
+                         header.numberOfBuckets <= (size - sizeof(header)) / sizeof(Bucket) &&
+                         size == sizeof(header) + header.numberOfBuckets * sizeof(Bucket);
+    if (!isValid)
+    {
+        unmapFile(mapping, size);
+        return false;
+    }
+
+    // The buckets are used in place, the mapping is aligned to a page and the header is 64 bytes
+    m_buckets         = std::unique_ptr<Bucket[], BucketsDeleter>(reinterpret_cast<Bucket*>(static_cast<char*>(mapping) + sizeof(header)), BucketsDeleter{mapping, size, large_pages::PageKind::Normal});
+    m_numberOfBuckets = header.numberOfBuckets;
+    m_mask            = m_numberOfBuckets - 1;
+    m_generation      = header.generation & s_generationMask;
+    return true;
+}
+
+size_t TranspositionTable::getSizeInMB() const
+{
+    return m_numberOfBuckets * sizeof(Bucket) / (1024 * 1024);
+}
+
+std::string TranspositionTable::describeMemory() const
+{
+    const std::string_view pages = m_buckets.get_deleter().mapping != nullptr ? "mapped from a file" : large_pages::toString(m_buckets.get_deleter().pageKind);
+    const std::string placement  = large_pages::describePlacement(m_buckets.get());
+    return std::format("{} MB, {}, {} thread(s){}", getSizeInMB(), pages, m_numberOfThreads, placement.empty() ? "" : " (" + placement + ")");
+}
+
+int TranspositionTable::hashfull() const
+{
+    // Sample the first buckets, it is not worth scanning the whole table
+    constexpr size_t sampleSize = 1000 / s_bucketSize;
+    const size_t buckets        = std::min(sampleSize, m_numberOfBuckets);
+    int used                    = 0;
+
+    for (size_t i = 0; i < buckets; i++)
+    {
+        for (const PackedEntry& packedEntry: m_buckets[i].entries)
+        {
+            const TTEntry entry = unpackData(0, packedEntry.data.load(std::memory_order_relaxed));
+            if (entry.bound != TTBound::None && entry.generation == m_generation)
+            {
+                used++;
+            }
+        }
+    }
+
+    return static_cast<int>(used * 1000 / (buckets * s_bucketSize));
+}
+
+uint16_t TranspositionTable::packMove(const Move& move)
+{
+    return move.getShortData();
+}
+
+uint64_t TranspositionTable::packData(const TTEntry& entry)
+{
+    return static_cast<uint64_t>(static_cast<uint32_t>(entry.score)) |
+           static_cast<uint64_t>(entry.move) << 32 |
+           static_cast<uint64_t>(entry.depth) << 48 |
+           static_cast<uint64_t>(std::to_underlying(entry.bound)) << 56 |
+           static_cast<uint64_t>(entry.generation & s_generationMask) << 58;
+}
+
+TTEntry TranspositionTable::unpackData(const uint64_t key, const uint64_t data)
+{
+    TTEntry entry;
+    entry.key        = key;
+    entry.score      = static_cast<int32_t>(static_cast<uint32_t>(data));
+    entry.move       = static_cast<uint16_t>(data >> 32);
+    entry.depth      = static_cast<uint8_t>(data >> 48);
+    entry.bound      = static_cast<TTBound>((data >> 56) & 3);
+    entry.generation = static_cast<uint8_t>(data >> 58);
+    return entry;
+}
+} // namespace chess_engine
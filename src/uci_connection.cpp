@@ -1,133 +1,395 @@
+#include <algorithm>
+#include <charconv>
 #include <iostream>
+#include <optional>
 #include <print>
+#include <sstream>
 #include <string>
+#include <utility>
 
+#include "benchmark.h"
 #include "evaluate.h"
-#include "search.h"
+#include "large_pages.h"
+#include "nnue.h"
+#include "pregenerated_moves.h"
+#include "syzygy.h"
 #include "uci_connection.h"
 
 namespace chess_engine
 {
+namespace
+{
+/**
+ * @brief Parse an option value that must be a whole integer.
+ *
+ * @return The number, or std::nullopt if the value is not a number or is out of the range of T.
+ */
+template<typename T>
+std::optional<T> parseNumber(const std::string_view value)
+{
+    T number                = 0;
+    const auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), number);
+    if (error != std::errc() || end != value.data() + value.size())
+    {
+        return std::nullopt;
+    }
+    return number;
+}
+} // namespace
+
 void UCIConnection::loop(Board& board)
 {
     std::string command;
 
+    printMemoryPlacement();
+
     while (true)
     {
-        std::getline(std::cin, command);
+        // The GUI closing the input stream is handled as "quit"
+        if (!std::getline(std::cin, command))
+        {
+            command = "quit";
+        }
 
         if (command == "uci")
         {
             std::println("id name ChessEngine");
             std::println("id author Leo");
+            std::println("option name Hash type spin default {} min 1 max {}",
+                         TranspositionTable::s_defaultSizeInMB,
+                         TranspositionTable::s_maxSizeInMB);
+            std::println("option name Threads type spin default 1 min 1 max {}", ThreadPool::s_maxThreads);
+            std::println("option name EvalFile type string default <empty>");
+            std::println("option name HashFile type string default <empty>");
+            std::println("option name SaveHash type button");
+            std::println("option name SyzygyPath type string default <empty>");
             std::println("uciok");
         }
-        else if (command.contains("position"))
+        else if (command == "stop")
         {
-            parsePosition(command, board);
+            s_threadPool.stop();
         }
-        else if (command == "ucinewgame")
+        else if (command == "ponderhit")
         {
-            parsePosition("position startpos", board);
+            s_threadPool.ponderhit();
         }
         else if (command == "isready")
         {
+            // Answered immediately, even while searching
             std::println("readyok");
         }
+        else if (command.starts_with("setoption"))
+        {
+            stopSearch();
+            parseSetOption(command);
+        }
+        else if (command.contains("position"))
+        {
+            stopSearch();
+            parsePosition(command, board);
+        }
+        else if (command == "ucinewgame")
+        {
+            stopSearch();
+
+            // Start each game from the saved table, if any
+            if (s_hashFile.empty() || !s_threadPool.getTranspositionTable().load(s_hashFile))
+            {
+                s_threadPool.getTranspositionTable().clear();
+            }
+            parsePosition("position startpos", board);
+        }
         else if (command.contains("go"))
         {
+            stopSearch();
             parseGo(command, board);
         }
+        else if (command == "stats")
+        {
+            // Counters of the last finished search
+            if constexpr (!SearchStats::s_enabled)
+            {
+                std::println("info string Search statistics are not collected, build with -DSEARCH_STATS=ON");
+            }
+            else if (s_threadPool.isSearching())
+            {
+                std::println("info string Search statistics are only available between searches");
+            }
+            else
+            {
+                std::print("{}", s_threadPool.getStats().toString());
+            }
+        }
+        else if (command.starts_with("bench"))
+        {
+            stopSearch();
+            benchmark::run(command);
+        }
         else if (command.contains("quit"))
         {
+            stopSearch();
             break;
         }
-        else
-            break;
+        else if (!command.empty())
+        {
+            // Unknown commands are ignored, as required by the protocol
+            std::println("info string Unknown command: {}", command);
+        }
     }
 }
 
+void UCIConnection::stopSearch()
+{
+    s_threadPool.stop();
+    s_threadPool.waitForSearchFinished();
+}
+
 void UCIConnection::parsePosition(const std::string_view command, Board& board)
 {
     // Command is of the form:
     // position [fen <fenstring> | startpos ] moves <move1> .... <movei>
 
-    constexpr std::string_view prefix = "position ";
-    size_t index                      = prefix.size();
-
-    if (command.contains("startpos"))
+    // GUIs send the whole game before each move: when the command only adds moves to the previous one
+    // (and the board was not changed since), only the new moves are applied
+    std::string_view moves;
+    bool isExtension = false;
+    if (!s_lastPositionCommand.empty() && board.getZobristHash() == s_lastPositionHash && command.starts_with(s_lastPositionCommand))
     {
-        index += 9; // Move index past "startpos "
-        board.parseFENString(Board::s_startingFENString);
-    }
-    else if (command.contains("fen"))
-    {
-        index += 4; // Move index past "fen "
-        board.parseFENString(command.substr(index));
+        const std::string_view newMoves = command.substr(s_lastPositionCommand.size());
+        const bool hadMoves             = s_lastPositionCommand.contains(" moves");
+        if (newMoves.empty())
+        {
+            return; // Same position
+        }
+        if (hadMoves && newMoves.starts_with(' '))
+        {
+            moves       = newMoves;
+            isExtension = true;
+        }
+        else if (!hadMoves && newMoves.starts_with(" moves "))
+        {
+            moves       = newMoves.substr(6); // Move past " moves"
+            isExtension = true;
+        }
     }
 
-    index = command.find("moves");
-    if (index != std::string_view::npos)
+    if (!isExtension)
     {
-        index += 6; // Move index past "moves "
-        // Get all moves
-        const std::string_view movesString = command.substr(index);
-        size_t start = 0, end = 0;
+        constexpr std::string_view prefix = "position ";
+        size_t index                      = prefix.size();
 
-        // Split movesString by space
-        while (end != std::string_view::npos)
+        if (command.contains("startpos"))
         {
-            std::string_view move;
-            end = movesString.find(' ', start);
-            if (end == std::string_view::npos)
-            {
-                move = movesString.substr(start);
-            }
-            else
-            {
-                move = movesString.substr(start, end - start);
-            }
+            board.parseFENString(Board::s_startingFENString);
+        }
+        else if (command.contains("fen"))
+        {
+            index += 4; // Move index past "fen "
+            board.parseFENString(command.substr(index));
+        }
 
-            parseMove(move, board);
-            board.print();
-            start = end + 1;
+        index = command.find("moves");
+        if (index != std::string_view::npos)
+        {
+            moves = command.substr(index + 5); // Move index past "moves"
         }
     }
+
+    // Split the moves by space
+    bool areMovesLegal = true;
+    size_t start       = moves.find_first_not_of(' ');
+    while (start != std::string_view::npos && areMovesLegal)
+    {
+        const size_t end = std::min(moves.find(' ', start), moves.size());
+        areMovesLegal    = parseMove(moves.substr(start, end - start), board);
+        start            = moves.find_first_not_of(' ', end);
+    }
+
+    // After an illegal move the board no longer matches the command: parse the next one from scratch
+    s_lastPositionCommand = areMovesLegal ? std::string(command) : std::string();
+    s_lastPositionHash    = board.getZobristHash();
 }
 
 bool UCIConnection::parseMove(const std::string_view moveAsString, Board& board)
 {
-    std::vector<Move> moves = board.generateMoves();
+    const Move move = board.parseUCIMove(moveAsString);
+    if (move.isNull())
+    {
+        std::println("info string Illegal move: {}", moveAsString);
+        return false;
+    }
+
+    board.makeMove(move);
+    return true;
+}
+
+void UCIConnection::parseSetOption(const std::string_view command)
+{
+    // Command is of the form:
+    // setoption name <id> [value <x>]
+
+    constexpr std::string_view namePrefix  = "name ";
+    constexpr std::string_view valuePrefix = " value ";
 
-    for (const auto& move: moves)
+    const size_t nameIndex = command.find(namePrefix);
+    if (nameIndex == std::string_view::npos)
     {
-        if (move.toString() == moveAsString)
+        return;
+    }
+
+    const size_t valueIndex = command.find(valuePrefix);
+    const std::string_view name =
+            command.substr(nameIndex + namePrefix.size(), valueIndex == std::string_view::npos ? std::string_view::npos : valueIndex - nameIndex - namePrefix.size());
+    const std::string_view value = valueIndex == std::string_view::npos ? std::string_view() : command.substr(valueIndex + valuePrefix.size());
+
+    if (name == "Hash" && !value.empty())
+    {
+        const std::optional<size_t> sizeInMB = parseNumber<size_t>(value);
+        if (!sizeInMB)
         {
-            return board.makeMove(move);
+            std::println("info string Invalid value for Hash: {}", value);
+            return;
         }
+
+        if (!s_threadPool.getTranspositionTable().resize(*sizeInMB))
+        {
+            std::println("info string Could not allocate a transposition table of {} MB, using {} MB", *sizeInMB, s_threadPool.getTranspositionTable().getSizeInMB());
+        }
+        printMemoryPlacement();
     }
-    return false;
+    else if (name == "Threads" && !value.empty())
+    {
+        const std::optional<int> numberOfThreads = parseNumber<int>(value);
+        if (!numberOfThreads)
+        {
+            std::println("info string Invalid value for Threads: {}", value);
+            return;
+        }
+
+        // Clamped to [1, s_maxThreads] by the pool
+        s_threadPool.setNumberOfThreads(*numberOfThreads);
+        printMemoryPlacement();
+    }
+    else if (name == "EvalFile")
+    {
+        if (value.empty() || value == "<empty>")
+        {
+            nnue::unload();
+            std::println("info string Using the hand-crafted evaluation");
+        }
+        else if (nnue::load(std::string(value)))
+        {
+            std::println("info string Loaded the NNUE network {}", value);
+        }
+        else
+        {
+            std::println("info string Could not load the NNUE network {}, using the hand-crafted evaluation", value);
+        }
+    }
+    else if (name == "HashFile")
+    {
+        s_hashFile = value == "<empty>" ? std::string() : std::string(value);
+        if (s_hashFile.empty())
+        {
+            return;
+        }
+
+        TranspositionTable& transpositionTable = s_threadPool.getTranspositionTable();
+        if (transpositionTable.load(s_hashFile))
+        {
+            std::println("info string Loaded the transposition table {} ({} MB)", s_hashFile, transpositionTable.getSizeInMB());
+        }
+        else
+        {
+            std::println("info string Could not load the transposition table {}, it will be written by SaveHash", s_hashFile);
+        }
+    }
+    else if (name == "SyzygyPath")
+    {
+        const std::string path = value.empty() ? std::string("<empty>") : std::string(value);
+        if (syzygy::init(path))
+        {
+            std::println("info string Found the Syzygy tablebases of up to {} pieces in {}", syzygy::getMaxPieces(), path);
+        }
+        else if (path == "<empty>")
+        {
+            std::println("info string Not using the Syzygy tablebases");
+        }
+        else
+        {
+            std::println("info string Could not find Syzygy tablebases in {}", path);
+        }
+    }
+    else if (name == "SaveHash")
+    {
+        if (s_hashFile.empty())
+        {
+            std::println("info string Set HashFile before SaveHash");
+        }
+        else if (s_threadPool.getTranspositionTable().save(s_hashFile))
+        {
+            std::println("info string Saved the transposition table {}", s_hashFile);
+        }
+        else
+        {
+            std::println("info string Could not save the transposition table {}", s_hashFile);
+        }
+    }
+}
+
+void UCIConnection::printMemoryPlacement()
+{
+    std::println("info string Transposition table: {}", s_threadPool.getTranspositionTable().describeMemory());
+
+    // The attack tables are generated at compile time, in the read-only data of the executable shared by all the processes
+    const size_t attackTablesSize = sizeof(pregenerated_moves::bishopAttacks) + sizeof(pregenerated_moves::rookAttacks);
+    const std::string placement   = large_pages::describePlacement(pregenerated_moves::rookAttacks.data());
+    std::println("info string Slider attack tables: {} kB{}", attackTablesSize / 1024, placement.empty() ? "" : ", in the executable (" + placement + ")");
 }
 
-void UCIConnection::parseGo(const std::string_view command, Board& board)
+void UCIConnection::parseGo(const std::string_view command, const Board& board)
 {
-    // TODO: Currently it's a basic implementation.
-    // See https://official-stockfish.github.io/docs/stockfish-wiki/UCI-&-Commands.html#go for all options
+    // Command is of the form:
+    // go [wtime <x>] [btime <x>] [winc <x>] [binc <x>] [movestogo <x>] [movetime <x>] [nodes <x>] [depth <x>] [infinite] [ponder]
+    // See https://official-stockfish.github.io/docs/stockfish-wiki/UCI-&-Commands.html#go
 
-    constexpr std::string_view prefix = "go ";
-    constexpr size_t index            = prefix.size();
-    int depth                         = 0;
+    constexpr int defaultDepth = 8; // Used when no limit is given
 
-    if (command.find("depth") != std::string_view::npos)
+    SearchLimits limits;
+    std::istringstream stream{std::string(command)};
+    std::string token;
+
+    stream >> token; // Skip "go"
+    while (stream >> token)
     {
-        depth = std::stoi(std::string(command.substr(index + 6)));
+        if (token == "wtime")
+            stream >> limits.time[std::to_underlying(Side::White)];
+        else if (token == "btime")
+            stream >> limits.time[std::to_underlying(Side::Black)];
+        else if (token == "winc")
+            stream >> limits.increment[std::to_underlying(Side::White)];
+        else if (token == "binc")
+            stream >> limits.increment[std::to_underlying(Side::Black)];
+        else if (token == "movestogo")
+            stream >> limits.movesToGo;
+        else if (token == "movetime")
+            stream >> limits.moveTime;
+        else if (token == "nodes")
+            stream >> limits.nodes;
+        else if (token == "depth")
+            stream >> limits.depth;
+        else if (token == "infinite")
+            limits.infinite = true;
+        else if (token == "ponder")
+            limits.ponder = true;
     }
-    else
+
+    if (!limits.infinite && !limits.ponder && limits.depth == 0 && limits.nodes == 0 && !limits.isTimeManaged(board.getSideToMove()))
     {
-        depth = 8; // Default depth
+        limits.depth = defaultDepth;
     }
 
-    Search::search(board, depth);
-    std::println("bestmove {}", Search::s_bestMove.toString());
+    // The search runs in the background, and prints the best move when it is done
+    s_threadPool.startSearch(board, limits);
 }
-} // namespace chess_engine
+} // namespace chess_engine
\ No newline at end of file
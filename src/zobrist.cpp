@@ -1,5 +1,7 @@
 #include "zobrist.h"
 
+#include <algorithm>
+#include <bit>
 #include <random>
 
 namespace chess_engine::zobrist
@@ -77,4 +79,24 @@ const std::array<uint64_t, 2> SIDE_KEYS
 const std::array<uint64_t, 16> CASTLING_KEYS                                       = generateCastlingKeys();
 const std::array<uint64_t, 8> EN_PASSANT_KEYS                                      = generateEnPassantKeys();
 
+uint64_t getKeysSignature()
+{
+    // Mix the keys in order, so that swapped keys change the signature too
+    uint64_t signature = 0;
+    const auto mix     = [&signature](const uint64_t key)
+    {
+        signature = std::rotl(signature, 5) ^ key;
+    };
+
+    for (const auto& pieceKeys: PIECE_KEYS)
+    {
+        std::ranges::for_each(pieceKeys, mix);
+    }
+    std::ranges::for_each(SIDE_KEYS, mix);
+    std::ranges::for_each(CASTLING_KEYS, mix);
+    std::ranges::for_each(EN_PASSANT_KEYS, mix);
+
+    return signature;
+}
+
 } // namespace chess_engine::zobrist
@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+
+#include <format>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "analysis.h"
+
+namespace chess_engine_test
+{
+using namespace chess_engine;
+
+TEST(Analysis, ParsesFENAndEPDLines)
+{
+    const auto fen = analysis::parseLine("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
+    ASSERT_TRUE(fen.has_value());
+    EXPECT_EQ(fen->fen, "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
+    EXPECT_EQ(fen->id, "");
+
+    const auto epd = analysis::parseLine("1k1r4/pp1b1R2/3q2pp/4p3/2B5/4Q3/PPP2B2/2K5 b - - bm Qd1+; id \"BK.01\";");
+    ASSERT_TRUE(epd.has_value());
+    EXPECT_EQ(epd->fen, "1k1r4/pp1b1R2/3q2pp/4p3/2B5/4Q3/PPP2B2/2K5 b - - 0 1") << "Expected the move counters of an EPD to be added";
+    EXPECT_EQ(epd->id, "BK.01");
+
+    EXPECT_FALSE(analysis::parseLine("").has_value());
+    EXPECT_FALSE(analysis::parseLine("   ").has_value());
+    EXPECT_FALSE(analysis::parseLine("# comment").has_value());
+}
+
+TEST(Analysis, SkipsInvalidPositions)
+{
+    EXPECT_FALSE(analysis::parseLine("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP w KQkq - 0 1").has_value()) << "Expected 7 ranks to be rejected";
+    EXPECT_FALSE(analysis::parseLine("rnbqkbnr/pppppppp/9/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1").has_value()) << "Expected a rank of 9 squares to be rejected";
+    EXPECT_FALSE(analysis::parseLine("rnbq1bnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQ - 0 1").has_value()) << "Expected a missing king to be rejected";
+    EXPECT_FALSE(analysis::parseLine("4k3/8/8/8/8/8/8/3KK3 w - - 0 1").has_value()) << "Expected two white kings to be rejected";
+    EXPECT_FALSE(analysis::parseLine("P3k3/8/8/8/8/8/8/4K3 w - - 0 1").has_value()) << "Expected a pawn on the last rank to be rejected";
+    EXPECT_FALSE(analysis::parseLine("4k3/8/8/8/8/8/8/4K3 x - - 0 1").has_value()) << "Expected an invalid side to move to be rejected";
+    EXPECT_FALSE(analysis::parseLine("4k3/8/8/8/8/8/8/4K3 w KX - 0 1").has_value()) << "Expected invalid castling rights to be rejected";
+    EXPECT_FALSE(analysis::parseLine("4k3/8/8/8/8/8/8/4K3 w - e9 0 1").has_value()) << "Expected an invalid en passant square to be rejected";
+    EXPECT_TRUE(analysis::parseLine("rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3").has_value());
+
+    // The invalid lines are skipped, the valid ones are still analyzed
+    std::istringstream input("4k3/8/8/8/8/8/8/8 w - - 0 1\n"
+                             "6k1/5ppp/8/8/8/8/8/3R2K1 w - - 0 1\n");
+    std::ostringstream output;
+    analysis::AnalysisOptions options;
+    options.depth      = 2;
+    options.hashSizeMB = 1;
+    EXPECT_EQ(analysis::analyze(input, output, options), 1);
+    EXPECT_TRUE(output.str().contains(R"("bestmove":"d1d8")")) << output.str();
+}
+
+TEST(Analysis, ParsesArguments)
+{
+    const char* const arguments[] = {"--depth", "6", "--threads", "4", "--format", "csv", "--input", "positions.epd"};
+    const auto options            = analysis::parseArguments(8, arguments);
+    ASSERT_TRUE(options.has_value());
+    EXPECT_EQ(options->depth, 6);
+    EXPECT_EQ(options->numberOfThreads, 4);
+    EXPECT_EQ(options->outputFormat, analysis::OutputFormat::CSV);
+    EXPECT_EQ(options->inputPath, "positions.epd");
+    EXPECT_EQ(options->outputPath, "");
+
+    const char* const invalidArguments[] = {"--depth", "zero"};
+    EXPECT_FALSE(analysis::parseArguments(2, invalidArguments).has_value());
+    const char* const missingValue[] = {"--threads"};
+    EXPECT_FALSE(analysis::parseArguments(1, missingValue).has_value());
+}
+
+TEST(Analysis, WritesTheResultsInInputOrder)
+{
+    std::istringstream input("# Mate in one, mated, stalemate and the initial position\n"
+                             "6k1/5ppp/8/8/8/8/8/3R2K1 w - - 0 1\n"
+                             "\n"
+                             "3R2k1/5ppp/8/8/8/8/8/6K1 b - -\n"
+                             "8/8/8/8/8/6k1/6p1/6K1 w - - 0 1\n"
+                             "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1\n");
+    std::ostringstream output;
+
+    analysis::AnalysisOptions options;
+    options.depth           = 3;
+    options.numberOfThreads = 3;
+    options.hashSizeMB      = 1;
+    EXPECT_EQ(analysis::analyze(input, output, options), 4);
+
+    std::vector<std::string> lines;
+    std::istringstream outputLines(output.str());
+    for (std::string line; std::getline(outputLines, line);)
+    {
+        lines.push_back(line);
+    }
+    ASSERT_EQ(lines.size(), 4);
+    for (size_t i = 0; i < lines.size(); i++)
+    {
+        EXPECT_TRUE(lines[i].starts_with(std::format(R"({{"index":{},)", i))) << lines[i];
+    }
+    EXPECT_TRUE(lines[0].contains(R"("bestmove":"d1d8")")) << lines[0];
+    EXPECT_TRUE(lines[1].contains(R"("bestmove":"0000","score":-100000,"pv":"")")) << lines[1];
+    EXPECT_TRUE(lines[2].contains(R"("bestmove":"0000","score":0,"pv":"")")) << lines[2];
+}
+} // namespace chess_engine_test
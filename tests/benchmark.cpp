@@ -0,0 +1,33 @@
+#include <gtest/gtest.h>
+
+#include "benchmark.h"
+#include "board.h"
+
+namespace chess_engine_test
+{
+using namespace chess_engine;
+
+TEST(Benchmark, PositionsAreValid)
+{
+    for (const std::string_view fenString: benchmark::POSITIONS)
+    {
+        Board board;
+        board.parseFENString(fenString);
+
+        EXPECT_EQ(board.getBitboardForPiece(WhiteKing).getNumberOfBitsSet(), 1) << fenString;
+        EXPECT_EQ(board.getBitboardForPiece(BlackKing).getNumberOfBitsSet(), 1) << fenString;
+
+        // The side that just moved cannot be in check
+        const PieceWithColor opponentKing = board.getSideToMove() == White ? BlackKing : WhiteKing;
+        EXPECT_FALSE(board.isSquareAttacked(board.getBitboardForPiece(opponentKing).getSquareOfLeastSignificantBitIndex(), board.getSideToMove())) << fenString;
+    }
+}
+
+TEST(Benchmark, NodeCountIsDeterministic)
+{
+    const benchmark::BenchmarkResult first  = benchmark::run(2, 1, 1);
+    const benchmark::BenchmarkResult second = benchmark::run(2, 1, 1);
+    EXPECT_GT(first.nodes, 0);
+    EXPECT_EQ(first.nodes, second.nodes) << "Expected the same number of nodes for the same benchmark";
+}
+} // namespace chess_engine_test
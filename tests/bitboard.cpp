@@ -0,0 +1,30 @@
+#include <gtest/gtest.h>
+
+#include "bitboard.h"
+
+namespace chess_engine_test
+{
+using namespace chess_engine;
+
+// The bit scans must stay usable at compile time, to generate the attack tables
+static_assert(Bitboard(0x8100000000000081ULL).getNumberOfBitsSet() == 4);
+static_assert(Bitboard(0x8100000000000000ULL).getSquareOfLeastSignificantBitIndex() == Square::a1);
+static_assert(Bitboard().getSquareOfLeastSignificantBitIndex() == Square::INVALID);
+
+TEST(Bitboard, BitScans)
+{
+    Bitboard bitboard;
+    EXPECT_EQ(bitboard.getNumberOfBitsSet(), 0);
+
+    bitboard.setBit(Square::e4);
+    bitboard.setBit(Square::a8);
+    bitboard.setBit(Square::h1);
+    EXPECT_EQ(bitboard.getNumberOfBitsSet(), 3);
+    EXPECT_EQ(bitboard.getSquareOfLeastSignificantBitIndex(), Square::a8);
+
+    EXPECT_EQ(bitboard.popLsb(), Square::a8);
+    EXPECT_EQ(bitboard.popLsb(), Square::e4);
+    EXPECT_EQ(bitboard.popLsb(), Square::h1);
+    EXPECT_EQ(bitboard, Bitboard()) << "Expected all the bits to be cleared";
+}
+} // namespace chess_engine_test
@@ -0,0 +1,290 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <string_view>
+
+#include "board.h"
+#include "evaluate.h"
+#include "nnue.h"
+#include "pregenerated_moves.h"
+
+namespace chess_engine_test
+{
+using namespace chess_engine;
+
+/**
+ * @brief Check that the mailbox holds the piece of each square of the bitboards.
+ */
+void checkMailbox(const Board& board)
+{
+    for (Square square = Square::a8; square <= Square::h1; square++)
+    {
+        PieceWithColor expected = InvalidPiece;
+        for (const PieceWithColor piece: PieceWithColor())
+        {
+            if (board.getBitboardForPiece(piece).getBit(square) == 1)
+            {
+                expected = piece;
+            }
+        }
+        ASSERT_EQ(board.getPieceOnSquare(square), expected) << "Expected the mailbox to match the bitboards on " << Board::s_squares[std::to_underlying(square)];
+    }
+}
+
+/**
+ * @brief Make and unmake all the moves up to the given depth, checking that the board is restored each time.
+ */
+void checkMakeUnmake(const int depth, Board& board)
+{
+    if (depth == 0)
+    {
+        return;
+    }
+
+    const uint64_t hash                 = board.getZobristHash();
+    const TaperedScore pieceSquareScore = board.getPieceSquareScore();
+    const uint64_t pawnKey              = board.getPawnKey();
+    std::array<Bitboard, 12> pieces;
+    for (const PieceWithColor piece: PieceWithColor())
+    {
+        pieces[std::to_underlying(piece)] = board.getBitboardForPiece(piece);
+    }
+
+    for (const Move& move: board.generateMoves())
+    {
+        board.makeMove(move);
+        checkMailbox(board);
+        checkMakeUnmake(depth - 1, board);
+        board.unmakeMove(move);
+        checkMailbox(board);
+
+        ASSERT_EQ(board.getZobristHash(), hash) << "Expected the hash to be restored after " << move.toString();
+        ASSERT_EQ(board.getPieceSquareScore(), pieceSquareScore) << "Expected the piece-square score to be restored after " << move.toString();
+        ASSERT_EQ(board.getPawnKey(), pawnKey) << "Expected the pawn key to be restored after " << move.toString();
+        for (const PieceWithColor piece: PieceWithColor())
+        {
+            ASSERT_EQ(board.getBitboardForPiece(piece), pieces[std::to_underlying(piece)]) << "Expected the pieces to be restored after " << move.toString();
+        }
+        ASSERT_EQ(board.getOccupancyForSide(WhiteAndBlack), board.getOccupancyForSide(White) | board.getOccupancyForSide(Black));
+    }
+}
+
+TEST(Board, MakeUnmakeRestoresState)
+{
+    Board board;
+    board.parseFENString("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+    checkMakeUnmake(3, board);
+}
+
+TEST(Board, KeepsTheSearchStateInFewCacheLines)
+{
+    EXPECT_EQ(sizeof(PieceWithColor), 1);
+    EXPECT_EQ(alignof(Board), 64);
+
+    // The bitboards, the hash, the scalar state and the mailbox take four cache lines, followed by the accumulators and the state history
+    EXPECT_EQ(sizeof(StateInfo), 32);
+    EXPECT_EQ(sizeof(Board), 4 * 64 + sizeof(nnue::Accumulator) + 1024 * sizeof(StateInfo));
+}
+
+TEST(Board, IncrementalHashMatchesFEN)
+{
+    Board board;
+    board.parseFENString(Board::s_startingFENString);
+
+    for (const std::string_view moveString: {"e2e4", "d7d5", "e4d5", "g8f6"})
+    {
+        for (const Move& move: board.generateMoves())
+        {
+            if (move.toString() == moveString)
+            {
+                board.makeMove(move);
+                break;
+            }
+        }
+    }
+
+    Board expected;
+    expected.parseFENString("rnbqkb1r/ppp1pppp/5n2/3P4/8/8/PPPP1PPP/RNBQKBNR w KQkq - 1 3");
+    EXPECT_EQ(board.getZobristHash(), expected.getZobristHash());
+    EXPECT_EQ(board.getOccupancyForSide(WhiteAndBlack), expected.getOccupancyForSide(WhiteAndBlack));
+    EXPECT_EQ(board.getPieceSquareScore(), expected.getPieceSquareScore());
+    EXPECT_EQ(board.getPawnKey(), expected.getPawnKey());
+    EXPECT_EQ(board.getGamePhase(), Evaluate::s_middleGamePhase); // Only a pawn was captured
+}
+
+TEST(Board, UnpackMove)
+{
+    constexpr std::array<std::string_view, 6> fenStrings = {
+            Board::s_startingFENString,
+            "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+            "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+            "rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3",
+            "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+            "rnb1kbnr/pppp1ppp/8/4p3/5PPq/8/PPPPP2P/RNBQKBNR w KQkq - 1 3",
+    };
+
+    for (const std::string_view fenString: fenStrings)
+    {
+        Board board;
+        board.parseFENString(fenString);
+
+        const MoveList generatedMoves = board.generateMoves();
+        for (const Move& move: generatedMoves)
+        {
+            EXPECT_EQ(board.unpackMove(move.getShortData()), move) << "Expected " << move.toString() << " to be rebuilt in " << fenString;
+        }
+
+        // Any other packed move must be rejected
+        for (int data = 1; data < 1 << 16; data++)
+        {
+            const Move move = board.unpackMove(static_cast<uint16_t>(data));
+            if (!move.isNull())
+            {
+                EXPECT_EQ(std::ranges::count(generatedMoves, move), 1) << "Unexpected move " << move.toString() << " in " << fenString;
+            }
+        }
+    }
+}
+
+TEST(Board, ParseUCIMove)
+{
+    // Castling, promotions of both sides, en passant
+    constexpr std::array<std::string_view, 4> fenStrings = {
+            "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+            "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+            "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 b kq - 0 1",
+            "rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3",
+    };
+
+    for (const std::string_view fenString: fenStrings)
+    {
+        Board board;
+        board.parseFENString(fenString);
+
+        for (const Move& move: board.generateMoves())
+        {
+            EXPECT_EQ(board.parseUCIMove(move.toString()), move) << "Expected " << move.toString() << " to be parsed in " << fenString;
+        }
+    }
+
+    Board board;
+    board.parseFENString(fenStrings[1]);
+    EXPECT_TRUE(board.parseUCIMove("e1g1").isNull()) << "Expected castling without the right to be rejected";
+    EXPECT_TRUE(board.parseUCIMove("a7a8").isNull()) << "Expected a promotion without the piece to be rejected";
+    EXPECT_TRUE(board.parseUCIMove("a7b8k").isNull()) << "Expected a promotion to a king to be rejected";
+    EXPECT_TRUE(board.parseUCIMove("e2e4").isNull()) << "Expected a move of an empty square to be rejected";
+    EXPECT_TRUE(board.parseUCIMove("i1a1").isNull());
+    EXPECT_TRUE(board.parseUCIMove("").isNull());
+    EXPECT_TRUE(board.parseUCIMove("a7b8qq").isNull());
+}
+
+TEST(Board, StaticExchangeEvaluation)
+{
+    struct Exchange
+    {
+        std::string_view fenString;
+        std::string_view move;
+        int expectedValue;
+    };
+
+    constexpr std::array<Exchange, 8> exchanges = {{
+            {"4k3/8/1n6/3p4/8/4N3/8/3Q2K1 w - - 0 1", "e3d5", 100},   // Pawn and knight for a knight
+            {"4k3/8/1n6/3p4/8/4N3/8/3Q2K1 w - - 0 1", "d1d5", -500},  // Queen for a pawn and a knight
+            {"3rk3/8/8/3p4/8/8/3R4/3R2K1 w - - 0 1", "d2d5", 100},    // The second rook joins the exchange through the first one
+            {"3rk3/8/8/3p4/8/8/8/3R2K1 w - - 0 1", "d1d5", -400},     // Rook for a pawn
+            {"3rk3/8/8/3p4/8/8/8/3R2K1 w - - 0 1", "d1d4", 0},        // Quiet move to a safe square
+            {"4k3/8/8/3pP3/8/8/8/4K3 w - d6 0 1", "e5d6", 100},       // En passant
+            {"r3k3/1P6/8/8/8/8/8/4K3 w - - 0 1", "b7b8q", -100},      // Promotion to a defended square
+            {"r3k3/1P6/8/8/8/8/8/4K3 w - - 0 1", "b7a8q", 1300},      // Capturing promotion
+    }};
+
+    for (const auto& [fenString, moveAsString, expectedValue]: exchanges)
+    {
+        Board board;
+        board.parseFENString(fenString);
+
+        const Move move = board.parseUCIMove(moveAsString);
+        ASSERT_FALSE(move.isNull()) << moveAsString << " in " << fenString;
+        EXPECT_EQ(board.getStaticExchangeEvaluation(move), expectedValue) << moveAsString << " in " << fenString;
+    }
+}
+
+TEST(Board, DetectsRepetitions)
+{
+    Board board;
+    board.parseFENString(Board::s_startingFENString);
+
+    // Knights out and back: the initial position is repeated after 4 plies
+    const auto play = [&board](const std::string_view move) { board.makeMove(board.parseUCIMove(move)); };
+    play("g1f3");
+    play("g8f6");
+    play("f3g1");
+    EXPECT_FALSE(board.isRepetition());
+    play("f6g8");
+    EXPECT_TRUE(board.isRepetition()) << "Expected the initial position to be repeated";
+    EXPECT_TRUE(board.isDraw());
+
+    // A pawn move is irreversible: the previous positions cannot be repeated
+    play("e2e4");
+    play("g8f6");
+    play("g1f3");
+    play("f6g8");
+    play("f3g1");
+    EXPECT_FALSE(board.isRepetition());
+
+    // A repetition across a null move is not a real one
+    board.parseFENString("4k3/8/8/8/8/8/8/R3K3 w - - 0 1");
+    play("a1a2");
+    board.makeNullMove();
+    play("a2a1");
+    board.makeNullMove();
+    EXPECT_FALSE(board.isRepetition());
+}
+
+TEST(Board, DetectsFiftyMoveDraws)
+{
+    Board board;
+    board.parseFENString("4k3/8/8/8/8/8/8/R3K3 w - - 99 80");
+    EXPECT_FALSE(board.isDraw());
+    board.makeMove(board.parseUCIMove("a1a2"));
+    EXPECT_TRUE(board.isDraw()) << "Expected a draw after 100 plies without captures or pawn moves";
+
+    // A checkmate on the 100th ply is still a checkmate
+    board.parseFENString("7k/8/6K1/8/8/8/8/R7 w - - 99 80");
+    board.makeMove(board.parseUCIMove("a1a8"));
+    EXPECT_FALSE(board.isDraw());
+}
+
+TEST(Board, GeneratesOnlyLegalMoves)
+{
+    // Pinned pieces, checks and an en passant capture that would expose the king along the rank
+    constexpr std::array<std::string_view, 4> fenStrings = {
+            "4k3/8/8/K2pP2r/8/8/8/8 w - d6 0 1",
+            "4k3/4r3/8/8/8/4N3/4K3/8 w - - 0 1",
+            "4k3/8/8/1b6/8/3P4/4K3/8 w - - 0 1",
+            "4k3/8/8/8/8/8/2n1r3/4K3 w - - 0 1",
+    };
+
+    for (const std::string_view fenString: fenStrings)
+    {
+        Board board;
+        board.parseFENString(fenString);
+
+        const Side side = board.getSideToMove();
+        for (const Move& move: board.generateMoves())
+        {
+            board.makeMove(move);
+            const Square kingSquare = board.getBitboardForPiece(side == White ? WhiteKing : BlackKing).getSquareOfLeastSignificantBitIndex();
+            EXPECT_FALSE(board.isSquareAttacked(kingSquare, board.getSideToMove())) << move.toString() << " leaves the king in check in " << fenString;
+            board.unmakeMove(move);
+        }
+    }
+
+    // The en passant capture is the only illegal pseudo-legal move of the first position
+    Board board;
+    board.parseFENString(fenStrings[0]);
+    EXPECT_EQ(board.generateMoves().size(), 6); // Five king moves and e5e6
+    EXPECT_TRUE(board.unpackMove(Move(Square::e5, Square::d6, WhitePawn, InvalidPiece, Pawn, true, false, true, false).getShortData()).isNull());
+}
+} // namespace chess_engine_test
@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <string_view>
+
+#include "board.h"
+#include "evaluate.h"
+#include "pawn_hash_table.h"
+
+namespace chess_engine_test
+{
+using namespace chess_engine;
+
+/**
+ * @brief Check that the evaluation is the same with and without the pawn hash table in all the positions up to the given depth.
+ */
+void checkPawnHashTable(const int depth, Board& board, PawnHashTable& pawnHashTable)
+{
+    ASSERT_EQ(Evaluate::evaluatePosition(board, pawnHashTable), Evaluate::evaluatePosition(board)) << "Expected the same evaluation from the pawn hash table";
+    if (depth == 0)
+    {
+        return;
+    }
+
+    for (const Move& move: board.generateMoves())
+    {
+        board.makeMove(move);
+        checkPawnHashTable(depth - 1, board, pawnHashTable);
+        board.unmakeMove(move);
+    }
+}
+
+TEST(Evaluate, PawnHashTableMatchesEvaluation)
+{
+    constexpr std::array<std::string_view, 3> fenStrings = {
+            "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+            "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+            "4k3/8/8/8/8/8/8/R3K3 w - - 0 1",
+    };
+
+    PawnHashTable pawnHashTable;
+    for (const std::string_view fenString: fenStrings)
+    {
+        Board board;
+        board.parseFENString(fenString);
+        checkPawnHashTable(3, board, pawnHashTable);
+    }
+}
+
+TEST(Evaluate, PawnStructure)
+{
+    Board board;
+    board.parseFENString("4k3/8/8/8/2P5/8/P3p3/4K3 w - - 0 1");
+    const PawnEntry pawnEntry = Evaluate::evaluatePawns(board);
+
+    EXPECT_EQ(pawnEntry.key, board.getPawnKey());
+    EXPECT_EQ(pawnEntry.passedPawns[std::to_underlying(White)], Bitboard(Square::a2) | Bitboard(Square::c4));
+    EXPECT_EQ(pawnEntry.passedPawns[std::to_underlying(Black)], Bitboard(Square::e2));
+    EXPECT_EQ(pawnEntry.pawnAttacks[std::to_underlying(Black)], Bitboard(Square::d1) | Bitboard(Square::f1));
+    EXPECT_EQ(pawnEntry.semiOpenFiles[std::to_underlying(White)], 0xFF & ~0b101);
+    EXPECT_EQ(pawnEntry.semiOpenFiles[std::to_underlying(Black)], 0xFF & ~0b10000);
+}
+
+TEST(Evaluate, AttackInfoMatchesSquareAttacks)
+{
+    constexpr std::array<std::string_view, 3> fenStrings = {
+            Board::s_startingFENString,
+            "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+            "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    };
+
+    for (const std::string_view fenString: fenStrings)
+    {
+        Board board;
+        board.parseFENString(fenString);
+        const AttackInfo attackInfo = Evaluate::computeAttackInfo(board, Evaluate::evaluatePawns(board));
+
+        for (Square square = Square::a8; square <= Square::h1; square++)
+        {
+            for (const Side side: {White, Black})
+            {
+                EXPECT_EQ(attackInfo.isSquareAttacked(square, side), board.isSquareAttacked(square, side))
+                        << Board::s_squares[std::to_underlying(square)] << " in " << fenString;
+            }
+        }
+    }
+}
+
+TEST(Evaluate, MobilityUsesSliderAttacks)
+{
+    Board board;
+    board.parseFENString("4k3/8/8/8/8/8/8/R3K3 w - - 0 1");
+    const AttackInfo attackInfo = Evaluate::computeAttackInfo(board, Evaluate::evaluatePawns(board));
+
+    // The rook attacks the a-file and b1 to d1, the king is not counted
+    EXPECT_EQ(attackInfo.mobility[std::to_underlying(White)], 10 * 2);
+    EXPECT_EQ(attackInfo.mobility[std::to_underlying(Black)], 0);
+}
+} // namespace chess_engine_test
@@ -0,0 +1,46 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include "large_pages.h"
+
+namespace chess_engine_test
+{
+using namespace chess_engine;
+
+TEST(LargePages, AllocatesAlignedMemory)
+{
+    for (const size_t size: {size_t{100}, large_pages::HUGE_PAGE_SIZE, 3 * large_pages::HUGE_PAGE_SIZE + 1})
+    {
+        large_pages::PageKind pageKind;
+        void* pointer = large_pages::allocate(size, pageKind);
+        ASSERT_NE(pointer, nullptr) << size;
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(pointer) % 64, 0) << size;
+        if (size < large_pages::HUGE_PAGE_SIZE)
+        {
+            EXPECT_EQ(pageKind, large_pages::PageKind::Normal) << "Expected the small allocations to use normal pages";
+        }
+        else if (pageKind != large_pages::PageKind::Normal)
+        {
+            EXPECT_EQ(reinterpret_cast<uintptr_t>(pointer) % large_pages::HUGE_PAGE_SIZE, 0) << size;
+        }
+
+        // The whole allocation is usable
+        std::memset(pointer, 0xAB, size);
+        large_pages::deallocate(pointer, size, pageKind);
+    }
+}
+
+TEST(LargePages, ValueInitializesArrays)
+{
+    constexpr size_t count = large_pages::HUGE_PAGE_SIZE / sizeof(uint64_t) + 3;
+
+    const large_pages::UniqueArray<uint64_t> array = large_pages::makeUniqueArray<uint64_t>(count);
+    EXPECT_TRUE(std::all_of(array.get(), array.get() + count, [](const uint64_t value)
+    {
+        return value == 0;
+    }));
+}
+} // namespace chess_engine_test
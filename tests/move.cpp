@@ -0,0 +1,43 @@
+#include <gtest/gtest.h>
+
+#include "move.h"
+
+namespace chess_engine_test
+{
+using namespace chess_engine;
+
+TEST(Move, PackedFields)
+{
+    const Move move(Square::b7, Square::a8, WhitePawn, WhiteQueen, Rook, true, false, false, false);
+    EXPECT_EQ(move.getSource(), Square::b7);
+    EXPECT_EQ(move.getTarget(), Square::a8);
+    EXPECT_EQ(move.getPiece(), WhitePawn);
+    EXPECT_EQ(move.getPromotedPiece(), WhiteQueen);
+    EXPECT_EQ(move.getCapturedPiece(), Rook);
+    EXPECT_TRUE(move.isCapture());
+    EXPECT_TRUE(move.isPromotion());
+    EXPECT_FALSE(move.isPawnDoublePush());
+    EXPECT_FALSE(move.isEnPassant());
+    EXPECT_FALSE(move.isCastling());
+    EXPECT_EQ(move.toString(), "b7a8q");
+
+    const Move castling(Square::e8, Square::c8, BlackKing, InvalidPiece, false, false, false, true);
+    EXPECT_EQ(castling.getPiece(), BlackKing);
+    EXPECT_EQ(castling.getPromotedPiece(), InvalidPiece);
+    EXPECT_FALSE(castling.isPromotion());
+    EXPECT_TRUE(castling.isCastling());
+}
+
+TEST(Move, NullMove)
+{
+    const Move move;
+    EXPECT_TRUE(move.isNull());
+    EXPECT_EQ(move.getShortData(), 0);
+    EXPECT_FALSE(move.isPromotion());
+
+    const Move a1a2(Square::a1, Square::a2, WhiteRook, InvalidPiece, false, false, false, false);
+    EXPECT_FALSE(a1a2.isNull());
+    EXPECT_NE(a1a2.getShortData(), 0);
+    EXPECT_NE(a1a2, move);
+}
+} // namespace chess_engine_test
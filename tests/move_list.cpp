@@ -0,0 +1,39 @@
+#include <gtest/gtest.h>
+
+#include "board.h"
+#include "move_list.h"
+#include "pregenerated_moves.h"
+
+namespace chess_engine_test
+{
+using namespace chess_engine;
+
+TEST(MoveList, AddAndIterate)
+{
+    MoveList moves;
+    EXPECT_TRUE(moves.empty());
+
+    moves.add(Square::e2, Square::e4, WhitePawn, InvalidPiece, false, true, false, false);
+    moves.add(Square::g1, Square::f3, WhiteKnight, InvalidPiece, false, false, false, false);
+    ASSERT_EQ(moves.size(), 2);
+    EXPECT_EQ(moves[0].getTarget(), Square::e4);
+    EXPECT_EQ(moves[1].getPiece(), WhiteKnight);
+
+    moves[1].score = 10;
+    int totalScore = 0;
+    for (const ScoredMove& move: moves)
+    {
+        totalScore += move.score;
+    }
+    EXPECT_EQ(totalScore, 10);
+}
+
+TEST(MoveList, StartingPosition)
+{
+    Board board;
+    board.parseFENString(Board::s_startingFENString);
+
+    const MoveList moves = board.generateMoves();
+    EXPECT_EQ(moves.size(), 20) << "Expected 20 moves in the starting position";
+}
+} // namespace chess_engine_test
@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <vector>
+
+#include "board.h"
+#include "move_picker.h"
+
+namespace chess_engine_test
+{
+using namespace chess_engine;
+
+static constexpr std::array s_fenStrings = {
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+        "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+        "rnbqkb1r/pp1p1ppp/2p5/4P3/2B5/8/PPP1NnPP/RNBQK2R w KQkq - 0 6",
+        "rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3",
+};
+
+/**
+ * @brief Collect all the moves returned by a move picker.
+ */
+std::vector<Move> pickAll(MovePicker& movePicker)
+{
+    std::vector<Move> moves;
+    for (Move move = movePicker.next(); !move.isNull(); move = movePicker.next())
+    {
+        moves.push_back(move);
+    }
+    return moves;
+}
+
+TEST(MovePicker, ReturnsEachMoveOnce)
+{
+    HistoryTable history = {};
+    history[std::to_underlying(WhiteKnight)][std::to_underlying(Square::f3)] = 100;
+
+    for (const char* fenString: s_fenStrings)
+    {
+        Board board;
+        board.parseFENString(fenString);
+
+        // In check, only the evasions are returned
+        const MoveList generatedMoves = board.isCheck() ? board.generateEvasions() : board.generateMoves();
+        ASSERT_FALSE(generatedMoves.empty());
+
+        // Use generated moves as TT and killer moves, plus a killer move from another position
+        const Move ttMove = generatedMoves[generatedMoves.size() / 2];
+        const KillerMoves killerMoves = {generatedMoves[generatedMoves.size() - 1], Move(Square::a1, Square::a2, WhiteRook, InvalidPiece, false, false, false, false)};
+
+        MovePicker movePicker(board, ttMove.getShortData(), killerMoves, history);
+        std::vector<Move> pickedMoves = pickAll(movePicker);
+
+        EXPECT_EQ(pickedMoves.front(), ttMove) << "Expected the TT move to be returned first in " << fenString;
+        ASSERT_EQ(pickedMoves.size(), generatedMoves.size()) << "Expected all the moves to be returned once in " << fenString;
+        for (const Move& move: generatedMoves)
+        {
+            EXPECT_EQ(std::ranges::count(pickedMoves, move), 1) << move.toString() << " in " << fenString;
+        }
+    }
+}
+
+TEST(MovePicker, QuiescenceOnlyReturnsCapturesAndPromotions)
+{
+    for (const char* fenString: s_fenStrings)
+    {
+        Board board;
+        board.parseFENString(fenString);
+
+        MovePicker movePicker(board);
+        const std::vector<Move> pickedMoves = pickAll(movePicker);
+
+        int lastScore = std::numeric_limits<int>::max();
+        for (const Move& move: pickedMoves)
+        {
+            EXPECT_TRUE(move.isCapture() || move.isPromotion()) << move.toString() << " in " << fenString;
+            EXPECT_GE(board.getStaticExchangeEvaluation(move), 0) << move.toString() << " in " << fenString;
+
+            // Captures are ordered by MVV-LVA
+            if (move.isCapture() && !move.isPromotion())
+            {
+                const int score = 10 * std::to_underlying(move.getCapturedPiece()) - std::to_underlying(move.getPiece()) % 6;
+                EXPECT_LE(score, lastScore) << move.toString() << " in " << fenString;
+                lastScore = score;
+            }
+        }
+
+        // The captures and promotions losing material are not returned
+        const MoveList generatedMoves = board.generateMoves();
+        EXPECT_EQ(pickedMoves.size(), std::ranges::count_if(generatedMoves, [&board](const Move& move)
+        {
+            return (move.isCapture() || move.isPromotion()) && board.getStaticExchangeEvaluation(move) >= 0;
+        }));
+    }
+}
+
+TEST(MovePicker, LosingCapturesAreReturnedLast)
+{
+    // Nxd5 wins a pawn, Qxd5 loses the queen to the knight recapture
+    Board board;
+    board.parseFENString("4k3/8/1n6/3p4/8/4N3/8/3Q2K1 w - - 0 1");
+
+    const HistoryTable history = {};
+    MovePicker movePicker(board, 0, {}, history);
+    const std::vector<Move> pickedMoves = pickAll(movePicker);
+
+    ASSERT_EQ(pickedMoves.size(), board.generateMoves().size());
+    EXPECT_EQ(pickedMoves.front().toString(), "e3d5");
+    EXPECT_EQ(pickedMoves.back().toString(), "d1d5");
+    EXPECT_TRUE(std::ranges::none_of(pickedMoves.begin() + 1, pickedMoves.end() - 1, [](const Move& move)
+    {
+        return move.isCapture();
+    }));
+}
+} // namespace chess_engine_test
@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string_view>
+#include <vector>
+
+#include "board.h"
+#include "nnue.h"
+
+namespace chess_engine_test
+{
+using namespace chess_engine;
+
+/**
+ * @brief Write a network with small random weights, in the format described in nnue.h.
+ */
+std::filesystem::path writeRandomNetwork()
+{
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "chess_engine_test_network.nnue";
+    std::ofstream file(path, std::ios::binary);
+
+    std::array<char, 64> header = {'C', 'E', 'N', 'N', 'U', 'E', '0', '1'};
+    const uint32_t inputs = nnue::N_INPUTS, hidden = nnue::N_HIDDEN;
+    std::memcpy(header.data() + 8, &inputs, sizeof(inputs));
+    std::memcpy(header.data() + 12, &hidden, sizeof(hidden));
+    file.write(header.data(), header.size());
+
+    // Fixed seed, so that a failure can be reproduced
+    std::mt19937 generator(0x5EED);
+    std::uniform_int_distribution<int> distribution(-8, 8);
+    std::vector<int16_t> weights(nnue::N_HIDDEN + static_cast<size_t>(nnue::N_INPUTS) * nnue::N_HIDDEN + 2 * nnue::N_HIDDEN);
+    for (int16_t& weight: weights)
+    {
+        weight = static_cast<int16_t>(distribution(generator));
+    }
+    file.write(reinterpret_cast<const char*>(weights.data()), static_cast<std::streamsize>(weights.size() * sizeof(int16_t)));
+
+    std::array<char, 64> outputBias = {};
+    const int32_t bias              = 1000;
+    std::memcpy(outputBias.data(), &bias, sizeof(bias));
+    file.write(outputBias.data(), outputBias.size());
+
+    return path;
+}
+
+/**
+ * @brief Check that the incremental accumulators match the ones computed from scratch, in all the positions up to the given depth.
+ */
+void checkAccumulators(const int depth, Board& board)
+{
+    Board refreshed = board;
+    refreshed.refreshAccumulators();
+    ASSERT_EQ(board.getAccumulator().values, refreshed.getAccumulator().values) << "Expected the same accumulators as computed from scratch";
+    if (depth == 0)
+    {
+        return;
+    }
+
+    for (const Move& move: board.generateMoves())
+    {
+        board.makeMove(move);
+        checkAccumulators(depth - 1, board);
+        board.unmakeMove(move);
+    }
+}
+
+TEST(NNUE, IncrementalAccumulatorsMatchRefresh)
+{
+    const std::filesystem::path path = writeRandomNetwork();
+    ASSERT_TRUE(nnue::load(path.string()));
+
+    // Castling, promotions, en passant and king captures
+    constexpr std::array<std::string_view, 3> fenStrings = {
+            "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+            "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+            "rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3",
+    };
+
+    for (const std::string_view fenString: fenStrings)
+    {
+        Board board;
+        board.parseFENString(fenString);
+        checkAccumulators(3, board);
+    }
+
+    // Mirroring the position (and the side to move) gives the same evaluation
+    Board board, mirrored;
+    board.parseFENString("4k3/8/8/3p4/8/2N5/8/4K3 w - - 0 1");
+    mirrored.parseFENString("4k3/8/2n5/8/3P4/8/8/4K3 b - - 0 1");
+    EXPECT_EQ(nnue::evaluate(board.getAccumulator(), White), nnue::evaluate(mirrored.getAccumulator(), Black));
+
+    nnue::unload();
+    std::filesystem::remove(path);
+}
+
+TEST(NNUE, RejectsInvalidFiles)
+{
+    EXPECT_FALSE(nnue::load("does_not_exist.nnue"));
+
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "chess_engine_test_invalid.nnue";
+    std::ofstream(path) << "not a network";
+    EXPECT_FALSE(nnue::load(path.string()));
+    EXPECT_FALSE(nnue::isLoaded());
+    std::filesystem::remove(path);
+}
+} // namespace chess_engine_test
@@ -1,5 +1,7 @@
 #include <gtest/gtest.h>
+#include <array>
 # include <print>
+#include <string_view>
 
 #include "board.h"
 #include "pregenerated_moves.h"
@@ -18,12 +20,17 @@ uint64_t perft(const int depth, Board& board, const bool first = true)
     }
 
     uint64_t nodes = 0;
-    auto moves = board.generateMoves();
+    const MoveList moves = board.generateMoves();
+
+    // Only legal moves are generated: the leaves can be counted without making the moves
+    if (depth == 1 && !first)
+    {
+        return moves.size();
+    }
+
     for (const Move& move: moves)
     {
-        const Board copy = board;
-        if (!board.makeMove(move))
-            continue;
+        board.makeMove(move);
 
         uint64_t cumulativeNodes = 0;
         if (first)
@@ -40,7 +47,47 @@ uint64_t perft(const int depth, Board& board, const bool first = true)
         }
 
         // Reset the board to the original state after each move
-        board = copy;
+        board.unmakeMove(move);
+    }
+
+    return nodes;
+}
+
+/**
+ * @brief Perft using the specialized generators: the evasions in check, otherwise the captures then the quiet moves.
+ */
+uint64_t perftWithVariants(const int depth, Board& board)
+{
+    if (depth == 0)
+    {
+        return 1;
+    }
+
+    uint64_t nodes        = 0;
+    const auto countMoves = [&](const MoveList& moves)
+    {
+        if (depth == 1)
+        {
+            nodes += moves.size();
+            return;
+        }
+
+        for (const Move& move: moves)
+        {
+            board.makeMove(move);
+            nodes += perftWithVariants(depth - 1, board);
+            board.unmakeMove(move);
+        }
+    };
+
+    if (board.isCheck())
+    {
+        countMoves(board.generateEvasions());
+    }
+    else
+    {
+        countMoves(board.generateCaptures());
+        countMoves(board.generateQuiets());
     }
 
     return nodes;
@@ -50,7 +97,6 @@ TEST(Perft, Position1)
 {
     Board board;
     board.parseFENString("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
-    pregenerated_moves::initAllPieces();
 
     uint64_t nodes;
     nodes = perft(0, board);
@@ -83,7 +129,6 @@ TEST(Perft, Position2)
 {
     Board board;
     board.parseFENString("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
-    pregenerated_moves::initAllPieces();
 
     uint64_t nodes;
     nodes = perft(1, board);
@@ -106,7 +151,6 @@ TEST(Perft, Position3)
 {
     Board board;
     board.parseFENString("8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1");
-    pregenerated_moves::initAllPieces();
 
     uint64_t nodes;
     nodes = perft(1, board);
@@ -133,7 +177,6 @@ TEST(Perft, Position4)
 {
     Board board;
     board.parseFENString("r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1");
-    pregenerated_moves::initAllPieces();
 
     uint64_t nodes;
     nodes = perft(1, board);
@@ -156,7 +199,6 @@ TEST(Perft, Position5)
 {
     Board board;
     board.parseFENString("rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8");
-    pregenerated_moves::initAllPieces();
 
     uint64_t nodes;
     nodes = perft(1, board);
@@ -175,7 +217,6 @@ TEST(Perft, Position6)
 {
     Board board;
     board.parseFENString("r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10");
-    pregenerated_moves::initAllPieces();
 
     uint64_t nodes;
     nodes = perft(0, board);
@@ -201,4 +242,31 @@ TEST(Perft, Position6)
     // nodes = perft(9, board);
     // EXPECT_EQ(nodes, 490154852788714) << "Expected 490154852788714 moves for the position at depth 9";
 }
+
+TEST(Perft, MoveGenerationVariants)
+{
+    struct PerftResult
+    {
+        std::string_view fenString;
+        int depth;
+        uint64_t nodes;
+    };
+
+    // Same positions as above, with many checks, captures and promotions
+    constexpr std::array<PerftResult, 6> results = {{
+            {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 4, 197281},
+            {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 4, 4085603},
+            {"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 5, 674624},
+            {"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 4, 422333},
+            {"rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 4, 2103487},
+            {"r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 4, 3894594},
+    }};
+
+    for (const auto& [fenString, depth, nodes]: results)
+    {
+        Board board;
+        board.parseFENString(fenString);
+        EXPECT_EQ(perftWithVariants(depth, board), nodes) << "Expected the same perft with the specialized generators for " << fenString;
+    }
+}
 } // namespace chess_engine_test
\ No newline at end of file
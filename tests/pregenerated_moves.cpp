@@ -0,0 +1,43 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <utility>
+
+#include "pregenerated_moves.h"
+#include "slider_utils.h"
+
+namespace chess_engine_test
+{
+using namespace chess_engine;
+
+// The tables are generated at compile time, no initialization is needed
+static_assert(pregenerated_moves::knightAttacks[std::to_underlying(Square::a8)] == (Bitboard(Square::b6) | Bitboard(Square::c7)));
+static_assert(pregenerated_moves::whitePawnsAttacks[std::to_underlying(Square::e2)] == (Bitboard(Square::d3) | Bitboard(Square::f3)));
+static_assert(pregenerated_moves::rookMagics[std::to_underlying(Square::a8)].shift == 64 - 12);
+
+TEST(PregeneratedMoves, SliderAttacksMatchOnTheFlyGeneration)
+{
+    // Fixed seed, so that a failure can be reproduced
+    std::mt19937_64 generator(0x5EED);
+    for (Square square = Square::a8; square <= Square::h1; square++)
+    {
+        for (int i = 0; i < 256; i++)
+        {
+            // Sparse occupancies are closer to the real positions and hit the rays at different distances
+            const Bitboard occupancy(generator() & generator() & generator());
+
+            EXPECT_EQ(pregenerated_moves::getBishopAttacks(square, occupancy), slider_utils::generateBishopAttacksOnTheFly(square, occupancy));
+            EXPECT_EQ(pregenerated_moves::getRookAttacks(square, occupancy), slider_utils::generateRookAttacksOnTheFly(square, occupancy));
+        }
+    }
+}
+
+TEST(PregeneratedMoves, SliderAttackTablesArePacked)
+{
+    // Each square only takes as many entries as its number of relevant occupancies
+    EXPECT_EQ(pregenerated_moves::BISHOP_ATTACK_TABLE_SIZE, 5248);
+    EXPECT_EQ(pregenerated_moves::ROOK_ATTACK_TABLE_SIZE, 102400);
+    EXPECT_EQ(pregenerated_moves::bishopMagics[0].offset, 0);
+    EXPECT_EQ(pregenerated_moves::rookMagics[63].offset, pregenerated_moves::ROOK_ATTACK_TABLE_SIZE - (1 << 12));
+}
+} // namespace chess_engine_test
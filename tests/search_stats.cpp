@@ -0,0 +1,36 @@
+#include <gtest/gtest.h>
+
+#include "search_stats.h"
+
+namespace chess_engine_test
+{
+using namespace chess_engine;
+
+TEST(SearchStats, CountersAreOnlyCollectedWhenEnabled)
+{
+    SearchStats stats;
+    stats.add(&SearchStats::ttHits);
+    stats.add(&SearchStats::allNodesMoves, 30);
+
+    EXPECT_EQ(stats.ttHits, SearchStats::s_enabled ? 1 : 0);
+    EXPECT_EQ(stats.allNodesMoves, SearchStats::s_enabled ? 30 : 0);
+}
+
+TEST(SearchStats, SumsTheThreads)
+{
+    SearchStats mainThread, helperThread;
+    mainThread.betaCutoffs   = 10;
+    mainThread.depthTimes    = {1, 3};
+    helperThread.betaCutoffs = 5;
+    helperThread.depthTimes  = {2};
+
+    SearchStats total;
+    total += mainThread;
+    total += helperThread;
+    EXPECT_EQ(total.betaCutoffs, 15);
+    EXPECT_EQ(total.depthTimes, mainThread.depthTimes) << "Expected the depth times of the main thread only";
+
+    // The time of each depth is shown, not the time since the start of the search
+    EXPECT_TRUE(total.toString().contains("depth times (ms) 1:1 2:2\n"));
+}
+} // namespace chess_engine_test
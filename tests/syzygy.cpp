@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "board.h"
+#include "syzygy.h"
+
+namespace chess_engine_test
+{
+using namespace chess_engine;
+
+TEST(Syzygy, WithoutTablesNothingIsProbed)
+{
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "chess_engine_test_no_syzygy";
+    std::filesystem::create_directories(path);
+    EXPECT_FALSE(syzygy::init(path.string()));
+    EXPECT_EQ(syzygy::getMaxPieces(), 0);
+
+    // Even a position with the two kings only is not probed
+    Board board;
+    board.parseFENString("4k3/8/8/8/8/8/8/3QK3 w - - 0 1");
+    EXPECT_FALSE(syzygy::canProbe(board));
+    EXPECT_TRUE(syzygy::getRootMoves(board).empty());
+
+    EXPECT_FALSE(syzygy::init("<empty>"));
+    std::filesystem::remove_all(path);
+}
+
+/**
+ * @brief Probe the tables of the SYZYGY_PATH environment variable, if set (no tables are shipped with the engine).
+ */
+TEST(Syzygy, ProbesTheTablesOfSyzygyPath)
+{
+    const char* path = std::getenv("SYZYGY_PATH");
+    if (path == nullptr || !syzygy::init(path))
+    {
+        GTEST_SKIP() << "Set SYZYGY_PATH to the directory of the 3-piece Syzygy tables";
+    }
+
+    // King and queen against king: a win for the side with the queen, whoever is to move
+    Board board;
+    board.parseFENString("4k3/8/8/8/8/8/8/3QK3 w - - 0 1");
+    ASSERT_TRUE(syzygy::canProbe(board));
+    EXPECT_EQ(syzygy::probeWDL(board), syzygy::WDL::Win);
+    board.parseFENString("4k3/8/8/8/8/8/8/3QK3 b - - 0 1");
+    EXPECT_EQ(syzygy::probeWDL(board), syzygy::WDL::Loss);
+
+    // The root moves keep the win: the queen is never left hanging
+    board.parseFENString("8/8/8/8/5k2/8/8/3QK3 w - - 0 1");
+    const std::vector<Move> rootMoves = syzygy::getRootMoves(board);
+    EXPECT_FALSE(rootMoves.empty());
+    EXPECT_LT(rootMoves.size(), board.generateMoves().size());
+    for (const Move& move: rootMoves)
+    {
+        board.makeMove(move);
+        EXPECT_EQ(syzygy::probeWDL(board), syzygy::WDL::Loss) << move.toString();
+        board.unmakeMove(move);
+    }
+
+    EXPECT_FALSE(syzygy::init("<empty>"));
+}
+} // namespace chess_engine_test
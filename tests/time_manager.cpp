@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+
+#include <utility>
+
+#include "time_manager.h"
+
+namespace chess_engine_test
+{
+using namespace chess_engine;
+
+TEST(TimeManager, NotTimeManaged)
+{
+    SearchLimits limits;
+    limits.depth = 10;
+    EXPECT_FALSE(limits.isTimeManaged(Side::White)) << "Expected a depth limited search not to be time managed";
+
+    limits.time[std::to_underlying(Side::Black)] = 60000;
+    EXPECT_FALSE(limits.isTimeManaged(Side::White)) << "Expected only the clock of the side to move to be used";
+    EXPECT_TRUE(limits.isTimeManaged(Side::Black));
+
+    limits.infinite = true;
+    EXPECT_FALSE(limits.isTimeManaged(Side::Black)) << "Expected an infinite search not to be time managed";
+
+    TimeManager timeManager;
+    timeManager.start(limits, Side::Black);
+    EXPECT_FALSE(timeManager.isHardLimitReached());
+    EXPECT_EQ(timeManager.getHardLimit(), 0);
+}
+
+TEST(TimeManager, MoveTime)
+{
+    SearchLimits limits;
+    limits.moveTime = 1000;
+
+    TimeManager timeManager;
+    timeManager.start(limits, Side::White);
+    EXPECT_EQ(timeManager.getSoftLimit(), timeManager.getHardLimit()) << "Expected the whole move time to be used";
+    EXPECT_LT(timeManager.getHardLimit(), 1000) << "Expected some time to be kept for the communication with the GUI";
+    EXPECT_GT(timeManager.getHardLimit(), 900);
+}
+
+TEST(TimeManager, SuddenDeath)
+{
+    SearchLimits limits;
+    limits.time      = {60000, 1000};
+    limits.increment = {1000, 0};
+
+    TimeManager timeManager;
+    timeManager.start(limits, Side::White);
+    EXPECT_GT(timeManager.getSoftLimit(), 0);
+    EXPECT_LT(timeManager.getSoftLimit(), timeManager.getHardLimit());
+    EXPECT_LT(timeManager.getHardLimit(), 60000 / 2) << "Expected a single move never to use most of the clock";
+
+    timeManager.start(limits, Side::Black);
+    EXPECT_LE(timeManager.getHardLimit(), 1000 * 3 / 4) << "Expected a low clock to be preserved";
+}
+
+TEST(TimeManager, Ponder)
+{
+    SearchLimits limits;
+    limits.moveTime = 1;
+    limits.ponder   = true;
+
+    TimeManager timeManager;
+    timeManager.start(limits, Side::White);
+    EXPECT_TRUE(timeManager.isPondering());
+    EXPECT_FALSE(timeManager.isHardLimitReached()) << "Expected the limits not to be enforced while pondering";
+
+    timeManager.ponderhit();
+    EXPECT_FALSE(timeManager.isPondering());
+}
+} // namespace chess_engine_test
@@ -0,0 +1,166 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+
+#include "search.h"
+#include "transposition_table.h"
+
+namespace chess_engine_test
+{
+using namespace chess_engine;
+
+TEST(TranspositionTable, StoreAndProbe)
+{
+    TranspositionTable table(1);
+    const Move move(Square::e2, Square::e4, WhitePawn, InvalidPiece, false, true, false, false);
+
+    TTEntry entry;
+    EXPECT_FALSE(table.probe(0x123456789ABCDEFULL, entry)) << "Expected an empty table to have no entries";
+
+    table.store(0x123456789ABCDEFULL, 5, 42, TTBound::Exact, move);
+    ASSERT_TRUE(table.probe(0x123456789ABCDEFULL, entry)) << "Expected the stored position to be found";
+    EXPECT_EQ(entry.depth, 5);
+    EXPECT_EQ(entry.score, 42);
+    EXPECT_EQ(entry.bound, TTBound::Exact);
+    EXPECT_EQ(entry.move, TranspositionTable::packMove(move));
+
+    table.clear();
+    EXPECT_FALSE(table.probe(0x123456789ABCDEFULL, entry)) << "Expected the table to be empty after clear";
+}
+
+TEST(TranspositionTable, KeepsBestMoveOnOverwrite)
+{
+    TranspositionTable table(1);
+    const Move move(Square::g1, Square::f3, WhiteKnight, InvalidPiece, false, false, false, false);
+
+    table.store(42, 3, 10, TTBound::LowerBound, move);
+    table.store(42, 4, -10, TTBound::UpperBound, Move());
+
+    TTEntry entry;
+    ASSERT_TRUE(table.probe(42, entry));
+    EXPECT_EQ(entry.depth, 4);
+    EXPECT_EQ(entry.bound, TTBound::UpperBound);
+    EXPECT_EQ(entry.move, TranspositionTable::packMove(move)) << "Expected the previous best move to be kept";
+}
+
+TEST(TranspositionTable, KeepsTheDistanceOfTablebaseScores)
+{
+    TranspositionTable table(1);
+
+    // A tablebase win reached 3 plies below a node at ply 5, then read from a node at ply 9
+    const int winScore  = Search::tbWinScore - 8;
+    const int lossScore = -Search::tbWinScore + 8;
+    table.store(1, 4, Search::scoreToTT(winScore, 5), TTBound::LowerBound, Move());
+    table.store(2, 4, Search::scoreToTT(lossScore, 5), TTBound::UpperBound, Move());
+
+    TTEntry entry;
+    ASSERT_TRUE(table.probe(1, entry));
+    EXPECT_EQ(Search::scoreFromTT(entry.score, 9), Search::tbWinScore - 12) << "Expected the win to stay 3 plies away";
+    ASSERT_TRUE(table.probe(2, entry));
+    EXPECT_EQ(Search::scoreFromTT(entry.score, 9), -Search::tbWinScore + 12) << "Expected the loss to stay 3 plies away";
+
+    // The mate scores are kept relative to the node as well, the other scores are unchanged
+    EXPECT_EQ(Search::scoreFromTT(Search::scoreToTT(Search::positiveInfinity - 8, 5), 9), Search::positiveInfinity - 12);
+    EXPECT_EQ(Search::scoreFromTT(Search::scoreToTT(Search::tbThreshold - 1, 5), 9), Search::tbThreshold - 1);
+}
+
+TEST(TranspositionTable, ReplacesShallowestEntry)
+{
+    TranspositionTable table(1);
+
+    // Keys differing only in the high bits map to the same bucket
+    constexpr uint64_t bucketStride = 1ULL << 40;
+    for (uint64_t i = 0; i < 4; i++)
+    {
+        table.store(7 + i * bucketStride, static_cast<int>(10 - i), 0, TTBound::Exact, Move());
+    }
+    table.store(7 + 4 * bucketStride, 20, 0, TTBound::Exact, Move());
+
+    TTEntry entry;
+    EXPECT_FALSE(table.probe(7 + 3 * bucketStride, entry)) << "Expected the shallowest entry to be replaced";
+    EXPECT_TRUE(table.probe(7, entry)) << "Expected the deepest entry to be kept";
+    EXPECT_TRUE(table.probe(7 + 4 * bucketStride, entry)) << "Expected the new entry to be stored";
+}
+TEST(TranspositionTable, IsClearedBySeveralThreads)
+{
+    // Several huge pages, so that each thread clears its own slice
+    TranspositionTable table(16);
+    table.setNumberOfThreads(3);
+
+    constexpr uint64_t numberOfKeys = 1000;
+    for (uint64_t key = 1; key <= numberOfKeys; key++)
+    {
+        table.store(key * 0x9E3779B97F4A7C15ULL, 1, 0, TTBound::Exact, Move());
+    }
+
+    TTEntry entry;
+    ASSERT_TRUE(table.probe(0x9E3779B97F4A7C15ULL, entry));
+    table.clear();
+    for (uint64_t key = 1; key <= numberOfKeys; key++)
+    {
+        EXPECT_FALSE(table.probe(key * 0x9E3779B97F4A7C15ULL, entry)) << "Expected the table to be empty after clear";
+    }
+    EXPECT_EQ(table.getSizeInMB(), 16) << "Expected the size to be kept when the number of threads changes";
+}
+
+TEST(TranspositionTable, SaveAndLoad)
+{
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "chess_engine_test_table.hash";
+    const Move move(Square::g1, Square::f3, WhiteKnight, InvalidPiece, false, false, false, false);
+
+    TranspositionTable table(2);
+    table.store(42, 7, -25, TTBound::LowerBound, move);
+    ASSERT_TRUE(table.save(path.string()));
+
+    // The loaded table takes the size of the saved one
+    TranspositionTable loaded(1);
+    ASSERT_TRUE(loaded.load(path.string()));
+    EXPECT_EQ(loaded.getSizeInMB(), 2);
+
+    TTEntry entry;
+    ASSERT_TRUE(loaded.probe(42, entry)) << "Expected the saved entry to be loaded";
+    EXPECT_EQ(entry.depth, 7);
+    EXPECT_EQ(entry.score, -25);
+    EXPECT_EQ(entry.bound, TTBound::LowerBound);
+    EXPECT_EQ(entry.move, TranspositionTable::packMove(move));
+
+    // The loaded table can be written to without modifying the file
+    loaded.clear();
+    loaded.store(43, 1, 0, TTBound::Exact, Move());
+    TranspositionTable reloaded(1);
+    ASSERT_TRUE(reloaded.load(path.string()));
+    EXPECT_TRUE(reloaded.probe(42, entry));
+    EXPECT_FALSE(reloaded.probe(43, entry));
+
+    std::filesystem::remove(path);
+}
+
+TEST(TranspositionTable, RejectsInvalidFiles)
+{
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "chess_engine_test_invalid.hash";
+
+    TranspositionTable table(1);
+    table.store(42, 7, -25, TTBound::LowerBound, Move());
+    EXPECT_FALSE(table.load(path.string())) << "Expected a missing file to be rejected";
+
+    // Truncated file
+    ASSERT_TRUE(TranspositionTable(1).save(path.string()));
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 64);
+    EXPECT_FALSE(table.load(path.string()));
+
+    // Other format version
+    ASSERT_TRUE(TranspositionTable(1).save(path.string()));
+    {
+        std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(8);
+        file.put(2);
+    }
+    EXPECT_FALSE(table.load(path.string()));
+
+    TTEntry entry;
+    EXPECT_TRUE(table.probe(42, entry)) << "Expected the current table to be kept";
+
+    std::filesystem::remove(path);
+}
+} // namespace chess_engine_test
@@ -0,0 +1,664 @@
+/**
+ * @file match.cpp
+ * @brief Self-play match between two configurations of the engine, to check that a change turns into strength.
+ *
+ * The games are played in-process, without UCI pipes: each worker (--concurrency, all the cores by default) plays
+ * one game at a time, with a silent ThreadPool of its own for each side. Each opening is played twice, the colors
+ * swapped, from a file of FEN or EPD lines (--openings) or from a few built-in openings.
+ *
+ * The searches are limited by a number of nodes (--nodes, the default), a time per move (--movetime), a time control
+ * (--tc BASE+INC, in seconds, a side running out of time loses) or a depth (--depth). These limits, the size of the
+ * transposition table (--hash) and the number of search threads (--threads) are common to both sides, and can be set
+ * for a single side with --a and --b (e.g. --a "name=more-nodes,nodes=20000").
+ *
+ * A game ends by checkmate, stalemate, threefold repetition, the fifty-move rule or insufficient material, and is
+ * adjudicated a draw after --maxplies plies. The match reports the score of A against B, the Elo difference with
+ * its 95% confidence interval and the likelihood of superiority, and the nodes per second and the average depth of
+ * each side. With --sprt ELO0 ELO1, the match stops as soon as the sequential probability ratio test accepts a
+ * hypothesis (H1: A is stronger by ELO1, H0: by ELO0), with the error rates --alpha and --beta.
+ *
+ * Both sides share the global state of the process (the slider attack tables, the NNUE network, the tablebases):
+ * they differ by their search options. To compare two builds, play each of them against the same configuration.
+ *
+ * Usage: chess_engine_match [--games N] [--concurrency N] [--openings FILE] [--maxplies N]
+ *                           [--nodes N | --movetime MS | --tc BASE+INC | --depth D] [--hash MB] [--threads N]
+ *                           [--a OPTIONS] [--b OPTIONS] [--sprt ELO0 ELO1 [--alpha A] [--beta B]]
+ * where OPTIONS is a comma-separated list of name=, nodes=, movetime=, tc=, depth=, hash= and threads=.
+ *
+ * @see https://www.chessprogramming.org/Match_Statistics
+ * @see https://www.chessprogramming.org/Sequential_Probability_Ratio_Test
+ */
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <format>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <print>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "analysis.h"
+#include "board.h"
+#include "thread_pool.h"
+
+namespace
+{
+using namespace chess_engine;
+
+/**
+ * @brief Openings played when no file is given, as moves from the starting position.
+ */
+constexpr std::array<std::string_view, 8> s_defaultOpenings = {
+        "e2e4 e7e5 g1f3 b8c6",
+        "e2e4 c7c5 g1f3 d7d6",
+        "e2e4 e7e6 d2d4 d7d5",
+        "e2e4 c7c6 d2d4 d7d5",
+        "d2d4 d7d5 c2c4 e7e6",
+        "d2d4 g8f6 c2c4 g7g6",
+        "c2c4 e7e5 b1c3 g8f6",
+        "g1f3 d7d5 g2g3 g8f6",
+};
+
+/**
+ * @brief An opening: a position, followed by moves.
+ */
+struct Opening
+{
+    std::string fen;   //< FEN string of the position
+    std::string moves; //< Moves played from the position, in UCI format and separated by spaces
+};
+
+/**
+ * @brief Search options of a side.
+ */
+struct EngineConfig
+{
+    std::string name;         //< Name of the side in the reports
+    SearchLimits limits;      //< Limits of each search (the time and increment are set from the time control)
+    int64_t baseTime    = 0;  //< Time of the time control in milliseconds (0 if the searches are not limited by a clock)
+    int64_t increment   = 0;  //< Increment per move of the time control in milliseconds
+    size_t hashSizeMB   = 16; //< Size of the transposition table in MB
+    int numberOfThreads = 1;  //< Number of search threads
+};
+
+/**
+ * @brief Statistics of the searches of a side.
+ */
+struct SideStats
+{
+    uint64_t nodes    = 0; //< Nodes searched
+    double seconds    = 0; //< Time of the searches
+    uint64_t depthSum = 0; //< Sum of the depths completed by the searches
+    uint64_t searches = 0; //< Number of searches (moves played)
+
+    SideStats& operator+=(const SideStats& other)
+    {
+        nodes += other.nodes;
+        seconds += other.seconds;
+        depthSum += other.depthSum;
+        searches += other.searches;
+        return *this;
+    }
+};
+
+/**
+ * @brief A side of the games of a worker, with its own searcher.
+ */
+struct Player
+{
+    const EngineConfig& config; //< Options of the side
+    ThreadPool threadPool;      //< Searcher of the side, kept across the games of the worker
+    SideStats stats;            //< Statistics of the current game
+};
+
+/**
+ * @brief Result of a game.
+ */
+struct GameResult
+{
+    double whiteScore;  //< 1 if White won, 0.5 for a draw, 0 if Black won
+    std::string reason; //< How the game ended
+};
+
+/**
+ * @brief Wins, draws and losses of A against B (as decimals, see getLogLikelihoodRatio), with the Elo and SPRT estimates.
+ */
+struct MatchScore
+{
+    double wins   = 0; //< Wins of A
+    double draws  = 0; //< Draws
+    double losses = 0; //< Losses of A
+
+    /**
+     * @brief Get the number of games.
+     */
+    [[nodiscard]] double getGames() const
+    {
+        return wins + draws + losses;
+    }
+
+    /**
+     * @brief Get the score of A per game, between 0 and 1.
+     */
+    [[nodiscard]] double getScore() const
+    {
+        return getGames() == 0 ? 0.5 : (wins + 0.5 * draws) / getGames();
+    }
+
+    /**
+     * @brief Get the variance of the result of a game, around the score.
+     */
+    [[nodiscard]] double getVariance() const
+    {
+        const double score = getScore();
+        return getGames() == 0 ? 0.0
+                               : (wins * (1 - score) * (1 - score) + draws * (0.5 - score) * (0.5 - score) + losses * score * score) / getGames();
+    }
+
+    /**
+     * @brief Get the log-likelihood ratio of H1 (A stronger by elo1) against H0 (A stronger by elo0).
+     *
+     * The games are approximated by a normal distribution of the same mean and variance (see the Chessprogramming wiki).
+     */
+    [[nodiscard]] double getLogLikelihoodRatio(const double elo0, const double elo1) const
+    {
+        if (getGames() == 0)
+        {
+            return 0;
+        }
+
+        // The variance is estimated with half a game more of each result, so that a few games with the same result
+        // (no variance) are not taken as a certainty
+        const MatchScore regularized = {wins + 0.5, draws + 0.5, losses + 0.5};
+        const double variance        = regularized.getVariance();
+
+        const double score0 = eloToScore(elo0);
+        const double score1 = eloToScore(elo1);
+        return (score1 - score0) * (2 * getScore() - score0 - score1) / (2 * variance / getGames());
+    }
+
+    /**
+     * @brief Convert an Elo difference to the expected score.
+     */
+    [[nodiscard]] static double eloToScore(const double elo)
+    {
+        return 1 / (1 + std::pow(10.0, -elo / 400));
+    }
+
+    /**
+     * @brief Convert a score to an Elo difference (clamped, since a score of 0 or 1 is an infinite difference).
+     */
+    [[nodiscard]] static double scoreToElo(const double score)
+    {
+        const double clampedScore = std::clamp(score, 1e-3, 1 - 1e-3);
+        return -400 * std::log10(1 / clampedScore - 1);
+    }
+};
+
+/**
+ * @brief Parse an integer argument.
+ *
+ * @param argument The argument.
+ * @param value Set to the parsed value.
+ * @return True if the argument is an integer, false otherwise.
+ */
+template<typename T>
+bool parseInteger(const std::string_view argument, T& value)
+{
+    const auto [end, error] = std::from_chars(argument.data(), argument.data() + argument.size(), value);
+    return error == std::errc() && end == argument.data() + argument.size();
+}
+
+/**
+ * @brief Parse a decimal argument.
+ *
+ * @param argument The argument.
+ * @param value Set to the parsed value.
+ * @return True if the argument is a number, false otherwise.
+ */
+bool parseDecimal(const std::string_view argument, double& value)
+{
+    const auto [end, error] = std::from_chars(argument.data(), argument.data() + argument.size(), value);
+    return error == std::errc() && end == argument.data() + argument.size();
+}
+
+/**
+ * @brief Parse a time control "BASE+INC" in seconds (e.g. "10+0.1"), the increment can be omitted.
+ *
+ * @param argument The argument.
+ * @param config Set to the time control.
+ * @return True if the argument is a time control, false otherwise.
+ */
+bool parseTimeControl(const std::string_view argument, EngineConfig& config)
+{
+    const size_t plus = argument.find('+');
+    double base = 0, increment = 0;
+    if (!parseDecimal(argument.substr(0, plus), base) || base <= 0 ||
+        (plus != std::string_view::npos && (!parseDecimal(argument.substr(plus + 1), increment) || increment < 0)))
+    {
+        return false;
+    }
+
+    config.baseTime  = static_cast<int64_t>(base * 1000);
+    config.increment = static_cast<int64_t>(increment * 1000);
+    return true;
+}
+
+/**
+ * @brief Parse an option of a side: a search limit, the hash size, the number of threads or the name.
+ *
+ * Setting a limit replaces the previous ones, so that a side can use another kind of limit than the common one.
+ *
+ * @param name The name of the option (nodes, movetime, tc, depth, hash, threads or name).
+ * @param value The value of the option.
+ * @param config The options of the side to update.
+ * @return True if the option is valid, false otherwise.
+ */
+bool parseEngineOption(const std::string_view name, const std::string_view value, EngineConfig& config)
+{
+    const auto setLimit = [&config]<typename T>(T SearchLimits::* const limit, const std::string_view argument)
+    {
+        T parsed{};
+        if (!parseInteger(argument, parsed) || parsed <= 0)
+        {
+            return false;
+        }
+        config.limits        = SearchLimits();
+        config.baseTime      = 0;
+        config.increment     = 0;
+        config.limits.*limit = parsed;
+        return true;
+    };
+
+    if (name == "nodes")
+        return setLimit(&SearchLimits::nodes, value);
+    if (name == "movetime")
+        return setLimit(&SearchLimits::moveTime, value);
+    if (name == "depth")
+        return setLimit(&SearchLimits::depth, value);
+    if (name == "tc")
+    {
+        config.limits = SearchLimits();
+        return parseTimeControl(value, config);
+    }
+    if (name == "hash")
+        return parseInteger(value, config.hashSizeMB) && config.hashSizeMB > 0;
+    if (name == "threads")
+        return parseInteger(value, config.numberOfThreads) && config.numberOfThreads > 0;
+    if (name == "name")
+    {
+        config.name = value;
+        return !value.empty();
+    }
+    return false;
+}
+
+/**
+ * @brief Parse the options of a side, "name=value" separated by commas (see parseEngineOption).
+ */
+bool parseEngineOptions(const std::string_view options, EngineConfig& config)
+{
+    size_t start = 0;
+    while (start < options.size())
+    {
+        const size_t end              = std::min(options.find(',', start), options.size());
+        const std::string_view option = options.substr(start, end - start);
+        const size_t equal            = option.find('=');
+        if (equal == std::string_view::npos || !parseEngineOption(option.substr(0, equal), option.substr(equal + 1), config))
+        {
+            return false;
+        }
+        start = end + 1;
+    }
+    return true;
+}
+
+/**
+ * @brief Read the openings of a file of FEN or EPD lines (see analysis::parseLine).
+ */
+std::vector<Opening> readOpenings(const std::string& path)
+{
+    std::vector<Opening> openings;
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line))
+    {
+        if (const std::optional<analysis::AnalysisPosition> position = analysis::parseLine(line))
+        {
+            openings.push_back({position->fen, ""});
+        }
+    }
+    return openings;
+}
+
+/**
+ * @brief Set up the position of an opening.
+ *
+ * @return True if all the moves of the opening are legal, false otherwise.
+ */
+bool setUpOpening(const Opening& opening, Board& board)
+{
+    board.parseFENString(opening.fen);
+
+    size_t start = opening.moves.find_first_not_of(' ');
+    while (start != std::string::npos)
+    {
+        const size_t end = std::min(opening.moves.find(' ', start), opening.moves.size());
+        const Move move  = board.parseUCIMove(std::string_view(opening.moves).substr(start, end - start));
+        if (move.isNull())
+        {
+            return false;
+        }
+        board.makeMove(move);
+        start = opening.moves.find_first_not_of(' ', end);
+    }
+    return true;
+}
+
+/**
+ * @brief Check if neither side can checkmate: kings only, or a single knight or bishop left.
+ */
+bool isInsufficientMaterial(const Board& board)
+{
+    const int pieces           = board.getOccupancyForSide(WhiteAndBlack).getNumberOfBitsSet();
+    const Bitboard minorPieces = board.getBitboardForPiece(WhiteKnight) | board.getBitboardForPiece(BlackKnight) |
+                                 board.getBitboardForPiece(WhiteBishop) | board.getBitboardForPiece(BlackBishop);
+    return pieces == 2 || (pieces == 3 && minorPieces.getNumberOfBitsSet() == 1);
+}
+
+/**
+ * @brief Play a game between two players.
+ *
+ * @param opening The opening to start from.
+ * @param players The players, indexed by Side.
+ * @param maxPlies The number of plies after which the game is adjudicated a draw.
+ * @return The result of the game.
+ */
+GameResult playGame(const Opening& opening, const std::array<Player*, 2>& players, const int maxPlies)
+{
+    Board board;
+    if (!setUpOpening(opening, board))
+    {
+        return {0.5, "illegal opening"};
+    }
+
+    std::array<int64_t, 2> clocks = {players[0]->config.baseTime, players[1]->config.baseTime};
+    std::vector<uint64_t> hashes  = {board.getZobristHash()};
+    for (Player* player: players)
+    {
+        player->threadPool.getTranspositionTable().clear(); // As after "ucinewgame"
+        player->stats = SideStats();
+    }
+
+    for (int ply = 0;; ply++)
+    {
+        if (board.generateMoves().empty())
+        {
+            if (!board.isCheck())
+            {
+                return {0.5, "stalemate"};
+            }
+            return {board.getSideToMove() == White ? 0.0 : 1.0, "checkmate"};
+        }
+        if (board.getHalfMoveClock() >= 100)
+        {
+            return {0.5, "fifty-move rule"};
+        }
+        if (std::ranges::count(hashes, board.getZobristHash()) >= 3)
+        {
+            return {0.5, "threefold repetition"};
+        }
+        if (isInsufficientMaterial(board))
+        {
+            return {0.5, "insufficient material"};
+        }
+        if (ply >= maxPlies)
+        {
+            return {0.5, "adjudication"};
+        }
+
+        const Side side     = board.getSideToMove();
+        const auto index    = static_cast<size_t>(std::to_underlying(side));
+        Player& player      = *players[index];
+        SearchLimits limits = player.config.limits;
+        if (player.config.baseTime > 0)
+        {
+            limits.time[index]      = clocks[index];
+            limits.increment[index] = player.config.increment;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        player.threadPool.search(board, limits);
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+
+        player.stats.nodes += player.threadPool.getTotalNodes();
+        player.stats.seconds += std::chrono::duration<double>(elapsed).count();
+        player.stats.depthSum += static_cast<uint64_t>(player.threadPool.getCompletedDepth());
+        player.stats.searches++;
+
+        if (player.config.baseTime > 0)
+        {
+            clocks[index] -= std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count();
+            if (clocks[index] < 0)
+            {
+                return {side == White ? 0.0 : 1.0, "loss on time"};
+            }
+            clocks[index] += player.config.increment;
+        }
+
+        // The search was stopped before its first iteration: play any legal move
+        Move move = player.threadPool.getBestMove();
+        if (move.isNull())
+        {
+            move = board.generateMoves()[0];
+        }
+        board.makeMove(move);
+        hashes.push_back(board.getZobristHash());
+    }
+}
+
+/**
+ * @brief Format the statistics of a side.
+ */
+std::string formatSideStats(const EngineConfig& config, const SideStats& stats)
+{
+    const double searches = static_cast<double>(std::max<uint64_t>(stats.searches, 1));
+    return std::format("{:<12} nps {:>10.0f} depth {:>5.2f} nodes/move {:>9.0f} time/move {:>7.3f} s",
+                       config.name,
+                       stats.seconds > 0 ? static_cast<double>(stats.nodes) / stats.seconds : 0.0,
+                       static_cast<double>(stats.depthSum) / searches,
+                       static_cast<double>(stats.nodes) / searches,
+                       stats.seconds / searches);
+}
+} // namespace
+
+int main(const int argc, const char* argv[])
+{
+    constexpr std::string_view usage = "Usage: {} [--games N] [--concurrency N] [--openings FILE] [--maxplies N] "
+                                       "[--nodes N | --movetime MS | --tc BASE+INC | --depth D] [--hash MB] [--threads N] "
+                                       "[--a OPTIONS] [--b OPTIONS] [--sprt ELO0 ELO1 [--alpha A] [--beta B]]";
+
+    int numberOfGames = 100;
+    int concurrency   = 0;
+    int maxPlies      = 400;
+    std::string openingsPath;
+    bool isSPRT  = false;
+    double elo0  = 0;
+    double elo1  = 5;
+    double alpha = 0.05;
+    double beta  = 0.05;
+
+    // The common options, then the options of each side (applied on top of them once all are parsed)
+    EngineConfig common;
+    common.limits.nodes = 10000;
+    std::string optionsA, optionsB;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string_view argument = argv[i];
+        const bool hasValue             = i + 1 < argc;
+        bool isValid                    = false;
+
+        if (argument == "--games" && hasValue)
+            isValid = parseInteger(argv[++i], numberOfGames) && numberOfGames > 0;
+        else if (argument == "--concurrency" && hasValue)
+            isValid = parseInteger(argv[++i], concurrency) && concurrency > 0;
+        else if (argument == "--maxplies" && hasValue)
+            isValid = parseInteger(argv[++i], maxPlies) && maxPlies > 0;
+        else if (argument == "--openings" && hasValue)
+        {
+            openingsPath = argv[++i];
+            isValid      = !openingsPath.empty();
+        }
+        else if ((argument == "--nodes" || argument == "--movetime" || argument == "--tc" || argument == "--depth" ||
+                  argument == "--hash" || argument == "--threads") && hasValue)
+            isValid = parseEngineOption(argument.substr(2), argv[++i], common);
+        else if ((argument == "--a" || argument == "--b") && hasValue)
+        {
+            (argument == "--a" ? optionsA : optionsB) = argv[++i];
+            isValid                                   = true;
+        }
+        else if (argument == "--sprt" && i + 2 < argc)
+        {
+            isSPRT  = true;
+            isValid = parseDecimal(argv[i + 1], elo0) && parseDecimal(argv[i + 2], elo1) && elo0 < elo1;
+            i += 2;
+        }
+        else if (argument == "--alpha" && hasValue)
+            isValid = parseDecimal(argv[++i], alpha) && alpha > 0 && alpha < 1;
+        else if (argument == "--beta" && hasValue)
+            isValid = parseDecimal(argv[++i], beta) && beta > 0 && beta < 1;
+
+        if (!isValid)
+        {
+            std::println(stderr, usage, argv[0]);
+            return 2;
+        }
+    }
+
+    std::array<EngineConfig, 2> configs = {common, common};
+    configs[0].name                     = "A";
+    configs[1].name                     = "B";
+    if (!parseEngineOptions(optionsA, configs[0]) || !parseEngineOptions(optionsB, configs[1]))
+    {
+        std::println(stderr, usage, argv[0]);
+        return 2;
+    }
+
+    std::vector<Opening> openings;
+    if (openingsPath.empty())
+    {
+        for (const std::string_view moves: s_defaultOpenings)
+        {
+            openings.push_back({std::string(Board::s_startingFENString), std::string(moves)});
+        }
+    }
+    else if (openings = readOpenings(openingsPath); openings.empty())
+    {
+        std::println(stderr, "No openings in {}", openingsPath);
+        return 1;
+    }
+
+    // By default, as many games at a time as the cores can run without sharing them between the search threads
+    if (concurrency == 0)
+    {
+        const int threadsPerGame = std::max(configs[0].numberOfThreads, configs[1].numberOfThreads);
+        concurrency              = std::max(1, static_cast<int>(std::thread::hardware_concurrency()) / threadsPerGame);
+    }
+    concurrency = std::min(concurrency, numberOfGames);
+
+    std::println("{} vs {}: {} games, {} at a time, {} openings", configs[0].name, configs[1].name, numberOfGames, concurrency, openings.size());
+
+    const double lowerBound = std::log(beta / (1 - alpha));
+    const double upperBound = std::log((1 - beta) / alpha);
+
+    std::mutex mutex; // Protects the score, the statistics and the output
+    MatchScore score;
+    std::array<SideStats, 2> stats;
+    std::atomic<int> nextGame   = 0;
+    std::atomic<bool> isDecided = false; // Set when the SPRT accepts a hypothesis
+
+    const auto worker = [&]()
+    {
+        // The sides of the games of this worker, with their own transposition tables
+        std::array<Player, 2> players = {Player{configs[0], {}, {}}, Player{configs[1], {}, {}}};
+        for (Player& player: players)
+        {
+            player.threadPool.setSilent(true);
+            player.threadPool.setNumberOfThreads(player.config.numberOfThreads);
+            player.threadPool.getTranspositionTable().resize(player.config.hashSizeMB);
+        }
+
+        for (int game = nextGame++; game < numberOfGames && !isDecided; game = nextGame++)
+        {
+            // Each opening is played twice, A playing White in the even games
+            const Opening& opening  = openings[static_cast<size_t>(game / 2) % openings.size()];
+            const bool isAWhite     = game % 2 == 0;
+            const GameResult result = playGame(opening, isAWhite ? std::array{&players[0], &players[1]} : std::array{&players[1], &players[0]}, maxPlies);
+            const double scoreA     = isAWhite ? result.whiteScore : 1 - result.whiteScore;
+
+            std::lock_guard lock(mutex);
+            (scoreA == 1 ? score.wins : scoreA == 0 ? score.losses : score.draws)++;
+            stats[0] += players[0].stats;
+            stats[1] += players[1].stats;
+
+            std::string line = std::format("Game {} ({} vs {}): {} {}, score of {} vs {}: {} - {} - {} [{:.3f}] {}",
+                                           game + 1,
+                                           isAWhite ? configs[0].name : configs[1].name,
+                                           isAWhite ? configs[1].name : configs[0].name,
+                                           result.whiteScore == 1 ? "1-0" : result.whiteScore == 0 ? "0-1" : "1/2-1/2",
+                                           result.reason,
+                                           configs[0].name, configs[1].name,
+                                           score.wins, score.losses, score.draws, score.getScore(), score.getGames());
+            if (isSPRT)
+            {
+                const double llr = score.getLogLikelihoodRatio(elo0, elo1);
+                line += std::format(", LLR {:.2f} ({:.2f}, {:.2f})", llr, lowerBound, upperBound);
+                if (llr <= lowerBound || llr >= upperBound)
+                {
+                    isDecided = true;
+                }
+            }
+            std::println("{}", line);
+        }
+    };
+
+    {
+        std::vector<std::jthread> workers;
+        for (int i = 0; i < concurrency; i++)
+        {
+            workers.emplace_back(worker);
+        }
+    } // Join the workers
+
+    // Elo difference, with a 95% confidence interval from the standard deviation of the score
+    const double scoreA        = score.getScore();
+    const double standardError = std::sqrt(score.getVariance() / std::max(score.getGames(), 1.0));
+    const double elo           = MatchScore::scoreToElo(scoreA);
+    const double eloMargin     = (MatchScore::scoreToElo(scoreA + 1.96 * standardError) - MatchScore::scoreToElo(scoreA - 1.96 * standardError)) / 2;
+    const double decisiveGames = score.wins + score.losses;
+    const double los           = decisiveGames == 0 ? 0.5 : 0.5 * (1 + std::erf((score.wins - score.losses) / std::sqrt(2 * decisiveGames)));
+
+    std::println("");
+    std::println("Score of {} vs {}: {} - {} - {} [{:.3f}] {}", configs[0].name, configs[1].name, score.wins, score.losses, score.draws, scoreA, score.getGames());
+    std::println("Elo difference: {:.1f} +/- {:.1f}, LOS: {:.1f} %", elo, eloMargin, 100 * los);
+    if (isSPRT)
+    {
+        const double llr = score.getLogLikelihoodRatio(elo0, elo1);
+        std::println("SPRT ({:.1f}, {:.1f}): LLR {:.2f} ({:.2f}, {:.2f}), {}",
+                     elo0, elo1, llr, lowerBound, upperBound,
+                     llr >= upperBound ? "H1 accepted" : llr <= lowerBound ? "H0 accepted" : "inconclusive");
+    }
+    std::println("{}", formatSideStats(configs[0], stats[0]));
+    std::println("{}", formatSideStats(configs[1], stats[1]));
+    return 0;
+}
@@ -0,0 +1,181 @@
+/**
+ * @file microbench.cpp
+ * @brief Microbenchmarks of the hot primitives of the engine, with Google Benchmark.
+ *
+ * Each benchmark runs a primitive over all the positions of the search benchmark (see benchmark.h),
+ * so that the effect of a change of data layout or of an intrinsic can be measured on its own,
+ * separately from the whole search. The numbers are reported per position (items per second).
+ *
+ * Usage: chess_engine_microbench [--benchmark_filter=<regex>] (see --help for the other options).
+ *
+ * @see https://github.com/google/benchmark
+ */
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include "benchmark.h"
+#include "board.h"
+#include "evaluate.h"
+#include "pawn_hash_table.h"
+#include "pregenerated_moves.h"
+
+namespace
+{
+// Google Benchmark uses the ::benchmark namespace, so the one of the engine is not imported
+using chess_engine::Board;
+using chess_engine::Square;
+
+/**
+ * @brief Get the positions of the search benchmark, parsed once.
+ *
+ * @return The boards of the corpus.
+ */
+const std::vector<Board>& getCorpus()
+{
+    static const std::vector<Board> corpus = []()
+    {
+        std::vector<Board> boards(chess_engine::benchmark::POSITIONS.size());
+        for (size_t i = 0; i < boards.size(); i++)
+        {
+            boards[i].parseFENString(chess_engine::benchmark::POSITIONS[i]);
+        }
+        return boards;
+    }();
+    return corpus;
+}
+
+/**
+ * @brief Set the number of items processed by a benchmark to the number of positions handled.
+ */
+void setPositionsProcessed(::benchmark::State& state)
+{
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * getCorpus().size()));
+}
+
+void BM_GenerateMoves(::benchmark::State& state)
+{
+    for (auto _: state)
+    {
+        for (const Board& board: getCorpus())
+        {
+            ::benchmark::DoNotOptimize(board.generateMoves());
+        }
+    }
+    setPositionsProcessed(state);
+}
+BENCHMARK(BM_GenerateMoves);
+
+void BM_MakeUnmakeMove(::benchmark::State& state)
+{
+    std::vector<Board> boards = getCorpus();
+    for (auto _: state)
+    {
+        for (Board& board: boards)
+        {
+            // Making all the moves of the position
+            for (const auto& move: board.generateMoves())
+            {
+                board.makeMove(move);
+                board.unmakeMove(move);
+            }
+            ::benchmark::ClobberMemory();
+        }
+    }
+    setPositionsProcessed(state);
+}
+BENCHMARK(BM_MakeUnmakeMove);
+
+void BM_IsSquareAttacked(::benchmark::State& state)
+{
+    for (auto _: state)
+    {
+        for (const Board& board: getCorpus())
+        {
+            // All the squares, by both sides
+            for (int square = 0; square < chess_engine::board_dimensions::N_SQUARES; square++)
+            {
+                ::benchmark::DoNotOptimize(board.isSquareAttacked(static_cast<Square>(square), chess_engine::White));
+                ::benchmark::DoNotOptimize(board.isSquareAttacked(static_cast<Square>(square), chess_engine::Black));
+            }
+        }
+    }
+    setPositionsProcessed(state);
+}
+BENCHMARK(BM_IsSquareAttacked);
+
+void BM_EvaluatePosition(::benchmark::State& state)
+{
+    for (auto _: state)
+    {
+        for (const Board& board: getCorpus())
+        {
+            ::benchmark::DoNotOptimize(chess_engine::Evaluate::evaluatePosition(board));
+        }
+    }
+    setPositionsProcessed(state);
+}
+BENCHMARK(BM_EvaluatePosition);
+
+void BM_EvaluatePositionWithPawnHash(::benchmark::State& state)
+{
+    // As in the search: the pawn structures are found in the pawn hash table after the first iteration
+    chess_engine::PawnHashTable pawnHashTable;
+    for (auto _: state)
+    {
+        for (const Board& board: getCorpus())
+        {
+            ::benchmark::DoNotOptimize(chess_engine::Evaluate::evaluatePosition(board, pawnHashTable));
+        }
+    }
+    setPositionsProcessed(state);
+}
+BENCHMARK(BM_EvaluatePositionWithPawnHash);
+
+void BM_ParseFENString(::benchmark::State& state)
+{
+    Board board;
+    for (auto _: state)
+    {
+        for (const std::string_view fenString: chess_engine::benchmark::POSITIONS)
+        {
+            board.parseFENString(fenString);
+            ::benchmark::ClobberMemory();
+        }
+    }
+    setPositionsProcessed(state);
+}
+BENCHMARK(BM_ParseFENString);
+
+/**
+ * @brief Look up the attacks of a slider on all the squares, with the occupancy of each position of the corpus.
+ *
+ * @tparam getAttacks The lookup function of pregenerated_moves.
+ */
+template<chess_engine::Bitboard (*getAttacks)(Square, chess_engine::Bitboard)>
+void BM_SliderAttacks(::benchmark::State& state)
+{
+    std::vector<chess_engine::Bitboard> occupancies;
+    for (const Board& board: getCorpus())
+    {
+        occupancies.push_back(board.getOccupancyForSide(chess_engine::White) | board.getOccupancyForSide(chess_engine::Black));
+    }
+
+    for (auto _: state)
+    {
+        for (const chess_engine::Bitboard occupancy: occupancies)
+        {
+            for (int square = 0; square < chess_engine::board_dimensions::N_SQUARES; square++)
+            {
+                ::benchmark::DoNotOptimize(getAttacks(static_cast<Square>(square), occupancy));
+            }
+        }
+    }
+    setPositionsProcessed(state);
+}
+BENCHMARK(BM_SliderAttacks<chess_engine::pregenerated_moves::getBishopAttacks>)->Name("BM_BishopAttacks");
+BENCHMARK(BM_SliderAttacks<chess_engine::pregenerated_moves::getRookAttacks>)->Name("BM_RookAttacks");
+BENCHMARK(BM_SliderAttacks<chess_engine::pregenerated_moves::getQueenAttacks>)->Name("BM_QueenAttacks");
+} // namespace
+
+BENCHMARK_MAIN();
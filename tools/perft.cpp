@@ -0,0 +1,298 @@
+/**
+ * @file perft.cpp
+ * @brief Standalone perft benchmark, to check the move generator and catch regressions in its speed.
+ *
+ * Counts the leaf nodes of the move tree of each position of a standard suite (startpos, kiwipete and
+ * the positions 3 to 6 of the Chessprogramming wiki), checks them against the known results, and reports
+ * the nodes per second. A single position can be given instead with --fen and --depth.
+ *
+ * - The moves of depth 1 are counted without being made (bulk counting): the generator only generates legal moves.
+ * - The root moves are split across the threads (--threads, all the cores by default).
+ * - The counts of the subtrees can be cached in a perft hash table keyed by the Zobrist hash (--hash, in MB, off by default).
+ *
+ * Usage: chess_engine_perft [--threads N] [--hash MB] [--fen FEN --depth D]
+ *
+ * @see https://www.chessprogramming.org/Perft_Results
+ */
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <format>
+#include <print>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "board.h"
+
+namespace
+{
+using namespace chess_engine;
+
+/**
+ * @brief A position of the suite, with its known perft result.
+ */
+struct PerftPosition
+{
+    std::string_view name; //< Name of the position
+    std::string_view fen;  //< FEN string of the position
+    int depth;             //< Depth of the perft
+    uint64_t nodes;        //< Expected number of leaf nodes
+};
+
+constexpr std::array<PerftPosition, 6> s_suite = {{
+        {"startpos", "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 6, 119060324},
+        {"kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 5, 193690690},
+        {"position 3", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 7, 178633661},
+        {"position 4", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 5, 15833292},
+        {"position 5", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 5, 89941194},
+        {"position 6", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 5, 164075551},
+}};
+
+/**
+ * @brief Hash table caching the number of leaf nodes of the subtrees, shared by all the threads.
+ *
+ * The key of each entry is stored XOR-ed with its data, so that an entry torn by a concurrent write
+ * is detected as a miss and no lock is needed (see https://www.chessprogramming.org/Shared_Hash_Table#Lockless).
+ */
+class PerftHashTable
+{
+public:
+    /**
+     * @brief Construct a perft hash table.
+     *
+     * @param sizeMB The size of the table in MB (rounded down to a power of two entries), 0 to disable it.
+     */
+    explicit PerftHashTable(const size_t sizeMB)
+    {
+        size_t numberOfEntries = 0;
+        if (sizeMB > 0)
+        {
+            numberOfEntries = 1;
+            while (numberOfEntries * 2 * sizeof(Entry) <= sizeMB * 1024 * 1024)
+            {
+                numberOfEntries *= 2;
+            }
+        }
+        m_entries = std::vector<Entry>(numberOfEntries);
+    }
+
+    /**
+     * @brief Look up the number of leaf nodes of a subtree.
+     *
+     * @param key The Zobrist hash of the position.
+     * @param depth The depth of the subtree.
+     * @param nodes Set to the number of leaf nodes if found.
+     * @return True if the subtree was found, false otherwise.
+     */
+    bool probe(const uint64_t key, const int depth, uint64_t& nodes) const
+    {
+        if (m_entries.empty())
+        {
+            return false;
+        }
+
+        const Entry& entry  = m_entries[key & (m_entries.size() - 1)];
+        const uint64_t data = entry.data.load(std::memory_order_relaxed);
+        if ((entry.keyXorData.load(std::memory_order_relaxed) ^ data) != key || static_cast<int>(data & 0xFF) != depth)
+        {
+            return false;
+        }
+
+        nodes = data >> 8;
+        return true;
+    }
+
+    /**
+     * @brief Store the number of leaf nodes of a subtree, always replacing the previous entry.
+     *
+     * @param key The Zobrist hash of the position.
+     * @param depth The depth of the subtree.
+     * @param nodes The number of leaf nodes.
+     */
+    void store(const uint64_t key, const int depth, const uint64_t nodes)
+    {
+        if (m_entries.empty())
+        {
+            return;
+        }
+
+        Entry& entry        = m_entries[key & (m_entries.size() - 1)];
+        const uint64_t data = nodes << 8 | static_cast<uint64_t>(depth);
+        entry.keyXorData.store(key ^ data, std::memory_order_relaxed);
+        entry.data.store(data, std::memory_order_relaxed);
+    }
+
+private:
+    struct Entry
+    {
+        std::atomic<uint64_t> keyXorData = 0; //< Zobrist hash XOR-ed with the data
+        std::atomic<uint64_t> data       = 0; //< Number of leaf nodes (56 bits) and depth (8 bits)
+    };
+
+    std::vector<Entry> m_entries; //< The entries of the table (empty if disabled)
+};
+
+/**
+ * @brief Count the leaf nodes of the move tree.
+ *
+ * @param depth The depth of the tree (at least 1).
+ * @param board The position, restored before returning.
+ * @param hashTable The perft hash table.
+ * @return The number of leaf nodes.
+ */
+uint64_t perft(const int depth, Board& board, PerftHashTable& hashTable)
+{
+    const MoveList moves = board.generateMoves();
+    if (depth == 1)
+    {
+        return moves.size();
+    }
+
+    uint64_t nodes = 0;
+    if (hashTable.probe(board.getZobristHash(), depth, nodes))
+    {
+        return nodes;
+    }
+
+    for (const Move& move: moves)
+    {
+        board.makeMove(move);
+        nodes += perft(depth - 1, board, hashTable);
+        board.unmakeMove(move);
+    }
+
+    hashTable.store(board.getZobristHash(), depth, nodes);
+    return nodes;
+}
+
+/**
+ * @brief Count the leaf nodes of the move tree, splitting the root moves across threads.
+ *
+ * @param depth The depth of the tree (at least 1).
+ * @param board The position.
+ * @param numberOfThreads The number of threads.
+ * @param hashTable The perft hash table, shared by the threads.
+ * @return The number of leaf nodes.
+ */
+uint64_t parallelPerft(const int depth, const Board& board, const int numberOfThreads, PerftHashTable& hashTable)
+{
+    const MoveList rootMoves = board.generateMoves();
+    if (depth == 1)
+    {
+        return rootMoves.size();
+    }
+
+    // Each thread takes the next root move not searched yet, so that the threads finish at about the same time
+    std::atomic<size_t> nextMove = 0;
+    std::atomic<uint64_t> nodes  = 0;
+    std::vector<std::jthread> threads;
+    for (int threadId = 0; threadId < numberOfThreads; threadId++)
+    {
+        threads.emplace_back([&, threadBoard = board]() mutable
+        {
+            for (size_t i = nextMove++; i < rootMoves.size(); i = nextMove++)
+            {
+                threadBoard.makeMove(rootMoves[i]);
+                nodes += perft(depth - 1, threadBoard, hashTable);
+                threadBoard.unmakeMove(rootMoves[i]);
+            }
+        });
+    }
+    threads.clear(); // Join the threads
+
+    return nodes;
+}
+
+/**
+ * @brief Parse a positive integer command line argument.
+ *
+ * @param argument The argument.
+ * @param value Set to the parsed value.
+ * @return True if the argument is a positive integer, false otherwise.
+ */
+bool parsePositiveInteger(const std::string_view argument, int& value)
+{
+    const auto [end, error] = std::from_chars(argument.data(), argument.data() + argument.size(), value);
+    return error == std::errc() && end == argument.data() + argument.size() && value >= 0;
+}
+} // namespace
+
+int main(const int argc, const char* argv[])
+{
+    int numberOfThreads = static_cast<int>(std::max(1U, std::thread::hardware_concurrency()));
+    int hashSizeMB      = 0;
+    int depth           = 0;
+    std::string fen;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string_view argument = argv[i];
+        const bool hasValue             = i + 1 < argc;
+        if (argument == "--threads" && hasValue && parsePositiveInteger(argv[++i], numberOfThreads) && numberOfThreads > 0)
+        {
+            continue;
+        }
+        if (argument == "--hash" && hasValue && parsePositiveInteger(argv[++i], hashSizeMB))
+        {
+            continue;
+        }
+        if (argument == "--depth" && hasValue && parsePositiveInteger(argv[++i], depth) && depth > 0)
+        {
+            continue;
+        }
+        if (argument == "--fen" && hasValue)
+        {
+            fen = argv[++i];
+            continue;
+        }
+
+        std::println(stderr, "Usage: {} [--threads N] [--hash MB] [--fen FEN --depth D]", argv[0]);
+        return 2;
+    }
+
+    std::vector<PerftPosition> positions(s_suite.begin(), s_suite.end());
+    if (!fen.empty() || depth > 0)
+    {
+        if (fen.empty() || depth == 0)
+        {
+            std::println(stderr, "--fen and --depth must be given together");
+            return 2;
+        }
+        positions = {{"custom", fen, depth, 0}};
+    }
+
+    std::println("Threads: {}, hash: {} MB", numberOfThreads, hashSizeMB);
+
+    bool allCorrect     = true;
+    uint64_t totalNodes = 0;
+    double totalSeconds = 0;
+    for (const PerftPosition& position: positions)
+    {
+        Board board;
+        board.parseFENString(position.fen);
+
+        // A fresh table for each position, so that the results do not depend on the order of the suite
+        PerftHashTable hashTable(static_cast<size_t>(hashSizeMB));
+
+        const auto start     = std::chrono::steady_clock::now();
+        const uint64_t nodes = parallelPerft(position.depth, board, numberOfThreads, hashTable);
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        const bool isCorrect = position.nodes == 0 || nodes == position.nodes;
+        allCorrect           = allCorrect && isCorrect;
+        totalNodes += nodes;
+        totalSeconds += seconds;
+
+        std::println("{:<12} depth {} nodes {:>11} time {:>8.3f} s nps {:>11.0f}{}",
+                     position.name, position.depth, nodes, seconds, static_cast<double>(nodes) / seconds,
+                     isCorrect ? "" : std::format(" WRONG (expected {})", position.nodes));
+    }
+
+    std::println("{:<12} nodes {:>19} time {:>8.3f} s nps {:>11.0f}", "total", totalNodes, totalSeconds, static_cast<double>(totalNodes) / totalSeconds);
+    return allCorrect ? 0 : 1;
+}